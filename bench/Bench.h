@@ -0,0 +1,22 @@
+#ifndef Bench_h
+#define Bench_h
+
+#include "HostTest.h"
+
+// one function per benchmark, listed in bench.cpp
+void benchRequests();
+void benchMime();
+void benchRoutes();
+void benchEvents();
+void benchCache();
+void benchAuth();
+void benchLoad();
+void benchGzip();
+void benchAssets();
+void benchUpload();
+void benchLog();
+
+// bench_log_off.cpp, built with the log compiled out
+uint64_t timeLogOff(int count, const char *uri);
+
+#endif
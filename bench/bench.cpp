@@ -0,0 +1,49 @@
+#include "Bench.h"
+
+// Benchmark driver. Each benchmark is a function registered below, run
+// by name ("bench gzip mime") or all of them without arguments; results
+// are printed one per line as "name: value unit".
+typedef void (*Benchmark)(void);
+
+struct BenchmarkEntry
+{
+    const char *name;
+    Benchmark run;
+    const char *description;
+};
+
+static const BenchmarkEntry benchmarks[] = {
+  {"requests", benchRequests, "sequential GETs of a 512 byte file"},
+  {"mime", benchMime, "content type lookups per second, table against the old chain"},
+  {"routes", benchRoutes, "route lookups at 10, 100 and 1000 routes, and RAM per route"},
+  {"gzip", benchGzip, "bytes and time to last byte of a page, plain and gzip"},
+  {"events", benchEvents, "CPU per broadcast to 1, 4 and 8 subscribers"},
+  {"upload", benchUpload, "KB/s of 64 KB uploads, direct writes against the temp file"},
+  {"log", benchLog, "cost of a log call, enabled, below the runtime level and compiled out"},
+  {"cache", benchCache, "requests per second with the file cache off and on"},
+  {"auth", benchAuth, "cost of Basic, login and cookie checks, alone and per request"},
+  {"load", benchLoad, "8 clients downloading at once, throughput and p99"},
+  {"assets", benchAssets, "latency of a page from the asset bundle and from SPIFFS"},
+};
+
+int main(int argc, char **argv)
+{
+  int ran = 0;
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i)
+  {
+    bool selected = argc < 2;
+    for (int a = 1; a < argc; ++a)
+      selected |= strcmp(argv[a], benchmarks[i].name) == 0;
+    if (!selected)
+      continue;
+    printf("# %s: %s\n", benchmarks[i].name, benchmarks[i].description);
+    benchmarks[i].run();
+    ++ran;
+  }
+  if (argc >= 2 && !ran)
+  {
+    fprintf(stderr, "no such benchmark\n");
+    return 1;
+  }
+  return 0;
+}
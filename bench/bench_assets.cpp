@@ -0,0 +1,53 @@
+#include "Bench.h"
+
+#include <algorithm>
+
+using namespace hosttest;
+
+// The same 4 KB page from the asset bundle and from SPIFFS, with the file
+// cache off. The latency is a whole GET over loopback, the CPU is the
+// server's per request.
+static const size_t pageSize = 4096;
+static uint8_t page[pageSize];
+
+static void run(const char *name, bool bundle)
+{
+  Sandbox box;
+  box.writeFile("/page.htm", std::string((const char *)page, pageSize));
+  static const AssetEntry assets[] = {
+    {"/page.htm", "text/html", "\"1000-1\"", page, pageSize, 0, NULL, NULL, 0},
+  };
+  ServerHelper helper(NULL);
+  if (bundle)
+    helper.setAssets(assets);
+  boot(helper);
+
+  const int count = 400;
+  std::vector<uint64_t> latencies;
+  uint64_t cpu = threadCpuMicros();
+  for (int i = 0; i < count; ++i)
+  {
+    uint64_t t = nowMicros();
+    Response r = get(helper, "/page.htm");
+    if (r.status == 200 && r.body.size() == pageSize)
+      latencies.push_back(nowMicros() - t);
+  }
+  cpu = threadCpuMicros() - cpu;
+  std::sort(latencies.begin(), latencies.end());
+
+  printf("assets.%s.ok: %d of %d\n", name, (int)latencies.size(), count);
+  if (latencies.empty())
+    return;
+  printf("assets.%s.p50: %.1f us\n", name, (double)latencies[latencies.size() / 2]);
+  printf("assets.%s.p99: %.1f us\n", name, (double)latencies[latencies.size() * 99 / 100]);
+  // includes the idle loop() passes while the client thread works
+  printf("assets.%s.cpu: %.1f us/req\n", name, (double)cpu / count);
+}
+
+void benchAssets()
+{
+  for (size_t i = 0; i < pageSize; ++i)
+    page[i] = 'a' + i % 26;
+  run("spiffs", false);
+  run("bundle", true);
+}
@@ -0,0 +1,59 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// What authentication costs: the checks on their own, and sequential
+// GETs with auth off, with Basic credentials and with a session cookie.
+static void timeCheck(const char *name, std::function<bool()> check)
+{
+  const int count = 20000;
+  int ok = 0;
+  uint64_t start = nowMicros();
+  for (int i = 0; i < count; ++i)
+    ok += check();
+  uint64_t elapsed = nowMicros() - start;
+  printf("auth.%s: %.2f us (%d ok)\n", name, (double)elapsed / count, ok);
+}
+
+static void timeRequests(const char *name, ServerHelper &helper, const std::string &headers)
+{
+  const int count = 300;
+  int ok = 0;
+  uint64_t cpu = threadCpuMicros();
+  uint64_t start = nowMicros();
+  for (int i = 0; i < count; ++i)
+    ok += get(helper, "/fsinfo", headers).status == 200;
+  uint64_t elapsed = nowMicros() - start;
+  cpu = threadCpuMicros() - cpu;
+  printf("auth.request.%s.ok: %d of %d\n", name, ok, count);
+  printf("auth.request.%s.rate: %.1f req/s\n", name, count * 1e6 / elapsed);
+  printf("auth.request.%s.cpu: %.1f us/req\n", name, (double)cpu / count);
+}
+
+void benchAuth()
+{
+  SessionAuth auth;
+  auth.begin();
+  auth.setCredentials("admin", "admin");
+  char token[SESSION_TOKEN_SIZE + 1];
+  auth.issue(token);
+  std::string cookie = std::string("theme=dark; " SESSION_COOKIE "=") + token;
+
+  timeCheck("basic", [&]() { return auth.checkBasic("Basic YWRtaW46YWRtaW4="); });
+  timeCheck("login", [&]() { return auth.checkLogin("admin", "admin"); });
+  timeCheck("cookie", [&]() { return auth.validateCookie(cookie.c_str()); });
+  timeCheck("issue", [&]() { auth.issue(token); return true; });
+
+  Sandbox box;
+  ServerHelper helper(NULL);
+  helper.useSessionAuth(3600);
+  boot(helper);
+  timeRequests("off", helper, "");
+  helper.active_auth_mode();
+  timeRequests("basic", helper, "Authorization: Basic YWRtaW46YWRtaW4=\r\n");
+  std::string body = "username=admin&password=admin";
+  Response r = request(helper, "POST /login HTTP/1.1\r\nHost: device\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+  std::string set = r.header("set-cookie");
+  timeRequests("cookie", helper, "Cookie: " + set.substr(0, set.find(';')) + "\r\n");
+}
@@ -0,0 +1,38 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// Sequential GETs spread over a few small files, with the file cache off
+// and on. The server's CPU time per request shows what the cache saves
+// on the filesystem, the rate includes the loopback round trip.
+static void run(const char *name, size_t capacity)
+{
+  Sandbox box;
+  const int files = 8;
+  for (int i = 0; i < files; ++i)
+    box.writeFile(("/f" + std::to_string(i) + ".htm").c_str(), std::string(1024, 'a' + i));
+  ServerHelper helper(NULL);
+  if (capacity)
+    helper.enableFileCache(capacity);
+  boot(helper);
+
+  const int count = 400;
+  int ok = 0;
+  uint64_t cpu = threadCpuMicros();
+  uint64_t start = nowMicros();
+  for (int i = 0; i < count; ++i)
+    ok += get(helper, "/f" + std::to_string(i % files) + ".htm").status == 200;
+  uint64_t elapsed = nowMicros() - start;
+  cpu = threadCpuMicros() - cpu;
+
+  printf("cache.%s.ok: %d of %d\n", name, ok, count);
+  printf("cache.%s.rate: %.1f req/s\n", name, count * 1e6 / elapsed);
+  // includes the idle loop() passes while the client thread works
+  printf("cache.%s.cpu: %.1f us/req\n", name, (double)cpu / count);
+}
+
+void benchCache()
+{
+  run("off", 0);
+  run("on", 16384);
+}
@@ -0,0 +1,80 @@
+#include "Bench.h"
+
+#include <atomic>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace hosttest;
+
+// CPU time of broadcast() plus the handle() that sends it, for 1, 4 and
+// 8 subscribers. The subscribers are read by a second thread so the
+// queues never fill up and every message is sent.
+void benchEvents()
+{
+  Sandbox box;
+  ServerHelper helper(NULL);
+  boot(helper);
+
+  static const int counts[] = {1, 4, 8};
+  std::vector<int> fds;
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+  {
+    while ((int)fds.size() < counts[c])
+    {
+      int fd = connectTo(httpPort());
+      sendAll(fd, "GET /events HTTP/1.1\r\nHost: device\r\n\r\n");
+      int before = helper.events.clients();
+      pump(helper, [&]() { return helper.events.clients() > before; }, 2000);
+      fds.push_back(fd);
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> received(0);
+    std::thread reader([&]() {
+      char buf[4096];
+      while (!done)
+      {
+        std::vector<struct pollfd> polls;
+        for (size_t i = 0; i < fds.size(); ++i)
+          polls.push_back({fds[i], POLLIN, 0});
+        if (poll(&polls[0], polls.size(), 10) <= 0)
+          continue;
+        for (size_t i = 0; i < polls.size(); ++i)
+        {
+          ssize_t n = recv(polls[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+          if (n > 0)
+            received += n;
+        }
+      }
+    });
+
+    const int messages = 20000;
+    const String data = "{\"temp\":21.5,\"humidity\":40}";
+    const size_t messageSize = strlen("event: sensor\ndata: \n\n") + data.length();
+    uint32_t dropped = helper.events.dropped();
+    uint64_t cpu = 0;
+    size_t expected = received;
+    for (int i = 0; i < messages; ++i)
+    {
+      uint64_t start = threadCpuMicros();
+      helper.broadcast("sensor", data);
+      helper.events.handle();
+      cpu += threadCpuMicros() - start;
+      // a sketch broadcasts far less often than this, let the queues
+      // empty so every message is sent and none is dropped
+      expected += messageSize * fds.size();
+      while (received < expected)
+        helper.events.handle();
+    }
+    done = true;
+    reader.join();
+
+    printf("events.%d.cpu: %.2f us/broadcast\n", counts[c], (double)cpu / messages);
+    printf("events.%d.dropped: %u\n", counts[c], (unsigned)(helper.events.dropped() - dropped));
+  }
+  for (size_t i = 0; i < fds.size(); ++i)
+    close(fds[i]);
+}
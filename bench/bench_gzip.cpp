@@ -0,0 +1,69 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// A 24 KB page served plain and from its .gz copy: the bytes on the wire
+// and the time to the last byte of the response.
+static std::string page()
+{
+  std::string html = "<!DOCTYPE html><html><head><title>Device</title></head><body>\n";
+  for (int i = 0; html.size() < 24 * 1024; ++i)
+    html += "<div class=\"row\"><span class=\"label\">Sensor " + std::to_string(i) + "</span><span class=\"value\" id=\"s" +
+            std::to_string(i) + "\">--</span></div>\n";
+  return html + "</body></html>\n";
+}
+
+static std::string gzip(const std::string &data, const std::string &dir)
+{
+  std::string path = dir + "/page.htm";
+  FILE *f = fopen(path.c_str(), "wb");
+  fwrite(data.data(), 1, data.size(), f);
+  fclose(f);
+  std::string compressed;
+  FILE *p = popen(("gzip -9 -n -c " + path).c_str(), "r");
+  if (!p)
+    return compressed;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), p)) > 0)
+    compressed.append(buf, n);
+  pclose(p);
+  return compressed;
+}
+
+static void run(ServerHelper &helper, const char *name, const std::string &headers)
+{
+  const int count = 200;
+  size_t bytes = 0;
+  int ok = 0;
+  uint64_t start = nowMicros();
+  for (int i = 0; i < count; ++i)
+  {
+    Response r = get(helper, "/page.htm", headers);
+    ok += r.status == 200;
+    bytes = r.raw.size();
+  }
+  uint64_t elapsed = nowMicros() - start;
+  printf("gzip.%s.ok: %d of %d\n", name, ok, count);
+  printf("gzip.%s.bytes: %u bytes\n", name, (unsigned)bytes);
+  printf("gzip.%s.ttlb: %.1f us\n", name, (double)elapsed / count);
+}
+
+void benchGzip()
+{
+  Sandbox box;
+  std::string html = page();
+  std::string compressed = gzip(html, box.path(""));
+  if (compressed.empty())
+  {
+    printf("gzip: skipped, no gzip tool\n");
+    return;
+  }
+  box.writeFile("/page.htm", html);
+  box.writeFile("/page.htm.gz", compressed);
+  ServerHelper helper(NULL);
+  boot(helper);
+
+  run(helper, "plain", "");
+  run(helper, "gzip", "Accept-Encoding: gzip, deflate\r\n");
+}
@@ -0,0 +1,33 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// Eight clients downloading a 32 KB file at once, with every body sent
+// inside handleClient() and with the background transfer slots. Reports
+// the throughput and the latency percentiles of a whole response.
+static void run(const char *name, size_t slots)
+{
+  Sandbox box;
+  const size_t size = 32768;
+  box.writeFile("/load.bin", std::string(size, 'l'));
+  ServerHelper helper(NULL);
+  if (slots)
+    helper.useBackgroundTransfers(slots);
+  boot(helper);
+
+  LoadResult result = load(helper, 8, 25, "/load.bin", size);
+  printf("load.%s.failed: %d\n", name, result.failed);
+  printf("load.%s.rate: %.1f req/s\n", name, result.latencies.size() * 1e6 / result.elapsed);
+  printf("load.%s.throughput: %.2f MB/s\n", name, (double)result.bytes / result.elapsed);
+  printf("load.%s.p50: %.2f ms\n", name, result.percentile(50) / 1000.0);
+  printf("load.%s.p99: %.2f ms\n", name, result.percentile(99) / 1000.0);
+  if (slots)
+    printf("load.%s.reused: %u connections\n", name, (unsigned)helper.transfers.reused());
+}
+
+void benchLoad()
+{
+  run("inline", 0);
+  run("slots4", 4);
+  run("slots8", 8);
+}
@@ -0,0 +1,47 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// The cost of one hot-path log call: formatted into the ring and drained
+// to an output that takes everything, dropped by the runtime level, and
+// compiled out with SERVERHELPER_LOG_LEVEL (bench_log_off.cpp).
+class NullOutput : public Print
+{
+  public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+    int availableForWrite() override { return 4096; }
+};
+
+static uint64_t timeLog(int count, const char *uri)
+{
+  uint64_t start = nowMicros();
+  for (int i = 0; i < count; ++i)
+  {
+    LOG_INFO("http", "handleFileRead: sent %u bytes of %s", (unsigned)i, uri);
+    while (ServerLog.drain())
+      ;
+  }
+  return nowMicros() - start;
+}
+
+void benchLog()
+{
+  NullOutput out;
+  ServerLog.setOutput(&out);
+  const int count = 200000;
+  // a pointer the compiler cannot see through, as a real path would be
+  const char *volatile uri = "/setting.html";
+
+  uint8_t level = ServerLog.level();
+  uint64_t on = timeLog(count, uri);
+  ServerLog.setLevel(LOG_LEVEL_WARN);
+  uint64_t filtered = timeLog(count, uri);
+  ServerLog.setLevel(level);
+  uint64_t off = timeLogOff(count, uri);
+  ServerLog.setOutput(NULL);
+
+  printf("log.on: %.1f ns/call\n", on * 1000.0 / count);
+  printf("log.filtered: %.1f ns/call\n", filtered * 1000.0 / count);
+  printf("log.off: %.1f ns/call\n", off * 1000.0 / count);
+}
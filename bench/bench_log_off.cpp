@@ -0,0 +1,13 @@
+// The same call sites as bench_log.cpp with the log compiled out, as a
+// sketch built with -DSERVERHELPER_LOG_LEVEL=0 has them.
+#define SERVERHELPER_LOG_LEVEL LOG_LEVEL_NONE
+
+#include "Bench.h"
+
+uint64_t timeLogOff(int count, const char *uri)
+{
+  uint64_t start = hosttest::nowMicros();
+  for (int i = 0; i < count; ++i)
+    LOG_INFO("http", "handleFileRead: sent %u bytes of %s", (unsigned)i, uri);
+  return hosttest::nowMicros() - start;
+}
@@ -0,0 +1,24 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// Sequential GETs of a small file over loopback: the cost of one pass
+// through handleClient(), the handler lookup and the file read.
+void benchRequests()
+{
+  Sandbox box;
+  box.writeFile("/small.txt", std::string(512, 'x'));
+  ServerHelper helper(NULL);
+  boot(helper);
+
+  const int count = 300;
+  uint64_t start = nowMicros();
+  int ok = 0;
+  for (int i = 0; i < count; ++i)
+    ok += get(helper, "/small.txt").status == 200;
+  uint64_t elapsed = nowMicros() - start;
+
+  printf("requests.ok: %d of %d\n", ok, count);
+  printf("requests.rate: %.1f req/s\n", count * 1e6 / elapsed);
+  printf("requests.latency: %.1f us\n", (double)elapsed / count);
+}
@@ -0,0 +1,99 @@
+#include "Bench.h"
+
+using namespace hosttest;
+
+// Route lookup with 10, 100 and 1000 routes: the RouteDispatcher trie
+// against the handler list ESP8266WebServer walks with one canHandle()
+// per route. Every route is looked up in turn, plus a path that misses
+// and falls through to onNotFound. Then the RAM a route costs.
+static String uriOf(int i)
+{
+  return "/api/group" + String(i / 10) + "/item" + String(i);
+}
+
+static void run(int count)
+{
+  RouteDispatcher dispatcher;
+  std::vector<MyRequestHandler *> list;
+  std::vector<String> uris;
+  for (int i = 0; i < count; ++i)
+  {
+    uris.push_back(uriOf(i));
+    dispatcher.add(new MyRequestHandler([]() { return true; }, []() {}, []() {}, uris.back(), HTTP_GET));
+    list.push_back(new MyRequestHandler([]() { return true; }, []() {}, []() {}, uris.back(), HTTP_GET));
+  }
+  uris.push_back("/api/missing");
+
+  const int rounds = 200000 / count + 10;
+  size_t found = 0;
+  uint64_t start = nowMicros();
+  for (int r = 0; r < rounds; ++r)
+  {
+    for (size_t u = 0; u < uris.size(); ++u)
+    {
+      for (size_t i = 0; i < list.size(); ++i)
+      {
+        if (list[i]->canHandle(HTTP_GET, uris[u]))
+        {
+          ++found;
+          break;
+        }
+      }
+    }
+  }
+  uint64_t elapsed = nowMicros() - start;
+  double lookups = (double)rounds * uris.size();
+  printf("routes.%d.list: %.0f lookups/s\n", count, lookups * 1e6 / elapsed);
+
+  start = nowMicros();
+  for (int r = 0; r < rounds; ++r)
+  {
+    for (size_t u = 0; u < uris.size(); ++u)
+      found += dispatcher.find(HTTP_GET, uris[u]) != NULL;
+  }
+  elapsed = nowMicros() - start;
+  printf("routes.%d.trie: %.0f lookups/s\n", count, lookups * 1e6 / elapsed);
+
+  if (found != 2 * (size_t)rounds * count)
+    printf("routes.%d.error: %u lookups found a route\n", count, (unsigned)found);
+  for (size_t i = 0; i < list.size(); ++i)
+    delete list[i];
+}
+
+static void handler()
+{
+}
+
+// Heap taken by 100 routes added with on() and by the same routes in a
+// StaticRoute table. Sizes are of this 64-bit host, about twice the
+// ESP8266's for the pointer-heavy handlers.
+static void ram()
+{
+  const int count = 100;
+  static char uris[count][16];
+  static StaticRoute table[count];
+  for (int i = 0; i < count; ++i)
+  {
+    snprintf(uris[i], sizeof(uris[i]), "/r%03d", i);
+    table[i] = {uris[i], HTTP_GET, handler, NULL};
+  }
+
+  ServerHelper dynamic(NULL);
+  size_t heap = host::heapUsed();
+  for (int i = 0; i < count; ++i)
+    dynamic.on(uris[i], HTTP_GET, handler);
+  printf("routes.ram.on: %.1f bytes/route\n", (double)(host::heapUsed() - heap) / count);
+
+  ServerHelper fixed(NULL);
+  heap = host::heapUsed();
+  fixed.on(table);
+  printf("routes.ram.static: %.1f bytes/route\n", (double)(host::heapUsed() - heap) / count);
+}
+
+void benchRoutes()
+{
+  run(10);
+  run(100);
+  run(1000);
+  ram();
+}
@@ -1,4 +1,6 @@
 #include <ServerHelper.h>
+// data/ packed by tools/pack_assets.py, no SPIFFS upload needed
+#include "assets.h"
 
 #define DBG_OUTPUT  (*serverHelper.dbg_out)
 #define content serverHelper.content
@@ -6,16 +8,26 @@
 ServerHelper serverHelper(&Serial);
 //ServerHelper serverHelper;
 
+void handleRoot(void) {
+  serverHelper.handleFileRead("/index.html");
+}
+
+void handleSetting(void) {
+  serverHelper.handleFileRead("/setting.html");
+}
+
+static const char uriRoot[] PROGMEM = "/";
+static const char uriSetting[] PROGMEM = "/setting";
+
+// Routes of Station Mode, kept in flash and sorted by uri
+static const StaticRoute stRoutes[] PROGMEM = {
+  {uriRoot, HTTP_GET, handleRoot, NULL},
+  {uriSetting, HTTP_GET, handleSetting, NULL}
+};
+
 // Implementation of Station Mode
 void stHandler(void) {
-  
-  serverHelper.on("/", HTTP_GET, []() {
-    serverHelper.handleFileRead("/index.html");
-  });
-  
-  serverHelper.on("/setting", HTTP_GET, []() {
-      serverHelper.handleFileRead("/setting.html");
-  });
+  serverHelper.on(stRoutes);
 }
 
 
@@ -31,6 +43,7 @@ void setup() {
   Serial.println();
 
   serverHelper.setHandlers(stHandler, apHandler);
+  serverHelper.setAssets(assets);
   serverHelper.setup([]() {
       // Before The OTA Update, this function will be called
   });
@@ -0,0 +1,138 @@
+// Generated by tools/pack_assets.py from data, do not edit.
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <AssetBundle.h>
+
+// /index.html, 127 bytes gzip
+static const char assets0Path[] PROGMEM = "/index.html";
+static const char assets0Type[] PROGMEM = "text/html";
+static const char assets0ETag[] PROGMEM = "\"7f-f1e49be8\"";
+static const uint8_t assets0Data[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb3, 0x51, 0x74, 0xf1, 0x77, 0x0e,
+  0x89, 0x0c, 0x70, 0x55, 0xc8, 0x28, 0xc9, 0xcd, 0xb1, 0xe3, 0xb2, 0x81, 0x50, 0x40, 0x3a, 0x35,
+  0x31, 0xc5, 0x8e, 0x4b, 0x01, 0x08, 0x6c, 0x4a, 0x32, 0x4b, 0x72, 0x52, 0xed, 0x9c, 0x12, 0x8b,
+  0x33, 0x93, 0x15, 0x5c, 0x2b, 0x12, 0x73, 0x0b, 0x72, 0x52, 0x6d, 0xf4, 0x21, 0x82, 0x5c, 0x36,
+  0xfa, 0x10, 0x85, 0x5c, 0x36, 0x49, 0xf9, 0x29, 0x95, 0x50, 0x0d, 0x19, 0x86, 0xe8, 0xaa, 0x81,
+  0x22, 0x10, 0xa9, 0x44, 0x85, 0x8c, 0xa2, 0xd4, 0x34, 0x5b, 0xa5, 0xe2, 0xd4, 0x92, 0x92, 0xcc,
+  0xbc, 0x74, 0x3d, 0x90, 0x75, 0x4a, 0x76, 0xc1, 0x10, 0x9e, 0x8d, 0x7e, 0x22, 0xc8, 0x44, 0x88,
+  0x49, 0x20, 0xa3, 0x41, 0x6e, 0x01, 0x00, 0xb7, 0x13, 0x9b, 0x1e, 0xa2, 0x00, 0x00, 0x00,
+};
+
+// /setting.css, 520 bytes gzip
+static const char assets1Path[] PROGMEM = "/setting.css";
+static const char assets1Type[] PROGMEM = "text/css";
+static const char assets1ETag[] PROGMEM = "\"208-59e14a26\"";
+static const uint8_t assets1Data[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x54, 0xdb, 0x6e, 0x9c, 0x30,
+  0x10, 0x7d, 0x0e, 0x5f, 0x61, 0x29, 0x8a, 0x94, 0x4a, 0xeb, 0x0a, 0x68, 0x17, 0x6d, 0xbd, 0x4f,
+  0x79, 0x58, 0xa9, 0xbf, 0xd0, 0x47, 0x83, 0x0d, 0x58, 0x6b, 0x6c, 0x64, 0x9b, 0xdd, 0x4d, 0xa2,
+  0xfc, 0x7b, 0xc7, 0x06, 0xc3, 0xde, 0xd2, 0x14, 0x61, 0x09, 0x86, 0x99, 0x39, 0xe7, 0xcc, 0x85,
+  0x52, 0xb3, 0xd7, 0xf7, 0xe4, 0xa1, 0xa4, 0xd5, 0xbe, 0x31, 0x7a, 0x50, 0x0c, 0x57, 0x5a, 0x6a,
+  0x43, 0xd0, 0xe3, 0x6e, 0xb7, 0xdb, 0x26, 0x0f, 0xb5, 0x56, 0x0e, 0xd7, 0xb4, 0x13, 0xf2, 0x95,
+  0xa0, 0xdf, 0x5c, 0x1e, 0xb8, 0x13, 0x15, 0x5d, 0xa1, 0x17, 0x23, 0xa8, 0x5c, 0x21, 0x4b, 0x95,
+  0xc5, 0x96, 0x1b, 0x51, 0x6f, 0x93, 0x8f, 0x24, 0x69, 0xf3, 0xf7, 0x04, 0xc1, 0x15, 0xa2, 0xac,
+  0x78, 0xe3, 0x04, 0x65, 0x3f, 0xfa, 0xd3, 0x36, 0x18, 0x99, 0xb0, 0xbd, 0xa4, 0x90, 0xa6, 0x94,
+  0xba, 0xda, 0x8f, 0xb6, 0x8e, 0x9a, 0x46, 0x28, 0x82, 0xd2, 0xfe, 0x84, 0xb2, 0x34, 0x7a, 0x46,
+  0x0a, 0xd9, 0x86, 0xd2, 0x0d, 0x1b, 0x33, 0x67, 0x68, 0x4c, 0xdd, 0x72, 0xd1, 0xb4, 0x0e, 0xf2,
+  0xa6, 0xb3, 0xfb, 0x51, 0x30, 0xd7, 0x06, 0xcb, 0xd3, 0xf6, 0x06, 0x7e, 0x13, 0xbd, 0x16, 0x89,
+  0x67, 0x99, 0xcf, 0xd0, 0x8e, 0xad, 0x70, 0x7c, 0xb4, 0x48, 0xa1, 0x38, 0x9e, 0x81, 0xd6, 0x31,
+  0x6d, 0xa9, 0x0d, 0xe3, 0x06, 0x1b, 0xca, 0xc4, 0x60, 0x09, 0x02, 0x61, 0xe1, 0xa4, 0x28, 0x8d,
+  0xdf, 0x4f, 0xd8, 0xb6, 0x94, 0xe9, 0x23, 0x08, 0x42, 0x39, 0x7c, 0x5a, 0x7b, 0x59, 0x70, 0x4c,
+  0x53, 0xd2, 0xe7, 0x74, 0x85, 0xa6, 0xfb, 0x7b, 0xfe, 0xcd, 0x47, 0x7c, 0xc0, 0x49, 0x6a, 0x6d,
+  0xba, 0x49, 0x5a, 0x88, 0x17, 0x6f, 0x42, 0x35, 0x24, 0x62, 0x81, 0xe9, 0x42, 0x63, 0x5e, 0xcc,
+  0xaa, 0x63, 0xe9, 0x42, 0x21, 0x10, 0x1d, 0x9c, 0xbe, 0xc7, 0xc3, 0xb3, 0xf8, 0x9a, 0x09, 0x42,
+  0x3d, 0x65, 0x0c, 0x80, 0x01, 0xd0, 0x39, 0xdd, 0x11, 0xf4, 0x73, 0xc6, 0xb9, 0x55, 0x7d, 0x5d,
+  0x4f, 0x7c, 0x59, 0x41, 0xe8, 0x56, 0x10, 0x35, 0xb5, 0xec, 0x73, 0x55, 0x13, 0x26, 0x90, 0x0c,
+  0x60, 0x10, 0x27, 0x54, 0x3f, 0xb8, 0x10, 0xb5, 0xa8, 0xf3, 0x02, 0xd6, 0x23, 0x68, 0x2c, 0x42,
+  0x6c, 0xfd, 0x9d, 0x3e, 0xdf, 0x0e, 0xd9, 0x8c, 0xe2, 0x33, 0x85, 0x0a, 0x8d, 0x2c, 0x08, 0x52,
+  0x5a, 0xf1, 0xe5, 0x7d, 0x96, 0x6e, 0xb5, 0x14, 0x2c, 0x14, 0xeb, 0x31, 0xa3, 0x65, 0xf5, 0xab,
+  0xf2, 0x3e, 0x71, 0x24, 0x53, 0x5e, 0xe4, 0xeb, 0x7c, 0x21, 0x4b, 0x6a, 0x5d, 0x0d, 0x76, 0x85,
+  0xc6, 0x97, 0x03, 0xf5, 0xa1, 0xb3, 0xea, 0xa9, 0x07, 0x11, 0x47, 0x0f, 0xce, 0x4f, 0xd6, 0x19,
+  0xf0, 0x52, 0xc2, 0x5e, 0x5b, 0xe1, 0x84, 0xf6, 0xab, 0xe0, 0x49, 0x42, 0xfa, 0x72, 0x00, 0x3a,
+  0x6a, 0x4a, 0x76, 0x45, 0xf8, 0x62, 0x94, 0x17, 0x8e, 0x83, 0xb1, 0x9e, 0x64, 0xaf, 0x85, 0x72,
+  0xdc, 0x9c, 0x49, 0xbb, 0x6a, 0xde, 0x5c, 0x92, 0xe2, 0x7e, 0x5d, 0xaf, 0x37, 0x62, 0x6c, 0x06,
+  0x96, 0xbc, 0x86, 0x7d, 0x88, 0xcd, 0xb8, 0x9c, 0x76, 0xbf, 0x08, 0x45, 0x58, 0x86, 0x7b, 0x13,
+  0x36, 0xcb, 0x21, 0xad, 0x3e, 0x70, 0x13, 0x44, 0xe1, 0x23, 0x2f, 0xf7, 0xc2, 0x61, 0x67, 0xe0,
+  0x1f, 0xe2, 0x07, 0x86, 0xa0, 0xf0, 0x28, 0xa9, 0xe3, 0x7f, 0x9e, 0x31, 0x24, 0x9c, 0x46, 0x13,
+  0x5c, 0x3b, 0xfb, 0x3f, 0x6e, 0xfe, 0xfa, 0xc2, 0xed, 0x92, 0x74, 0xf1, 0x6f, 0xd2, 0x7f, 0x01,
+  0x0a, 0x08, 0x1e, 0xff, 0x1c, 0x05, 0x00, 0x00,
+};
+
+// /setting.html, 435 bytes gzip
+static const char assets2Path[] PROGMEM = "/setting.html";
+static const char assets2Type[] PROGMEM = "text/html";
+static const char assets2ETag[] PROGMEM = "\"1b3-1abe6db6\"";
+static const uint8_t assets2Data[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x53, 0x4d, 0x8b, 0xdb, 0x30,
+  0x10, 0x3d, 0x6f, 0xa1, 0xff, 0x41, 0xd5, 0xa9, 0x85, 0xae, 0xbd, 0x36, 0x6c, 0xd9, 0x16, 0xdb,
+  0x50, 0x9a, 0x52, 0x16, 0xca, 0x6e, 0x20, 0x7b, 0xe9, 0x51, 0xb1, 0x26, 0xf1, 0x6c, 0x65, 0xc9,
+  0x58, 0x93, 0xa4, 0xf9, 0xf7, 0x1d, 0x49, 0x76, 0x12, 0xd8, 0x4b, 0x30, 0xb6, 0xe6, 0xe3, 0xbd,
+  0x67, 0xcd, 0x68, 0x54, 0x7d, 0x58, 0x3c, 0xff, 0x78, 0xf9, 0xb3, 0xfc, 0x29, 0x3a, 0xea, 0x4d,
+  0xf3, 0xfe, 0x5d, 0x35, 0xad, 0xc1, 0x02, 0xa5, 0xd9, 0xba, 0xa9, 0x7a, 0x20, 0x25, 0xac, 0xea,
+  0xa1, 0x96, 0x7b, 0x84, 0xc3, 0xe0, 0x46, 0x92, 0xa2, 0x75, 0x96, 0xc0, 0x52, 0x2d, 0x0f, 0xa8,
+  0xa9, 0xab, 0x35, 0xec, 0xb1, 0x85, 0xdb, 0xe8, 0x7c, 0x16, 0x68, 0x91, 0x50, 0x99, 0x5b, 0xdf,
+  0x2a, 0x03, 0x75, 0x91, 0xdd, 0xc9, 0x28, 0x64, 0xd0, 0xfe, 0x15, 0x23, 0x98, 0x5a, 0x7a, 0x3a,
+  0x1a, 0xf0, 0x1d, 0x00, 0x2b, 0xd1, 0x71, 0x60, 0x65, 0x82, 0x7f, 0x94, 0xb7, 0xde, 0x4b, 0xd1,
+  0x8d, 0xb0, 0x61, 0x04, 0x10, 0xa1, 0xdd, 0x66, 0x21, 0x14, 0xc9, 0xbe, 0x1d, 0x71, 0xa0, 0x4b,
+  0xf4, 0xab, 0xda, 0xab, 0x14, 0x95, 0xc2, 0x8f, 0xed, 0x99, 0xf3, 0xca, 0x94, 0x2a, 0x4f, 0xa9,
+  0xc8, 0x25, 0x24, 0x03, 0xcd, 0x2a, 0xa5, 0xab, 0x3c, 0xb9, 0x5c, 0x62, 0x3e, 0xd5, 0xc8, 0xe6,
+  0xda, 0xe9, 0xa3, 0x70, 0xd6, 0x38, 0xa5, 0x6b, 0xf9, 0x6c, 0x7f, 0xf3, 0xfa, 0xf1, 0x53, 0xfa,
+  0xf3, 0xc6, 0x8d, 0xbd, 0x50, 0x2d, 0xa1, 0xb3, 0xb5, 0xe4, 0xba, 0x37, 0xb8, 0x95, 0x82, 0x9b,
+  0xd2, 0x39, 0x86, 0x0e, 0xce, 0x53, 0x84, 0xdd, 0x54, 0x5d, 0xd1, 0x7c, 0x6f, 0x5b, 0xf0, 0x5e,
+  0x2c, 0x1d, 0x5a, 0x62, 0xf5, 0x22, 0x26, 0x52, 0xb2, 0x6c, 0x9e, 0xb8, 0x85, 0xdf, 0x38, 0x5a,
+  0x26, 0x38, 0xda, 0x61, 0x77, 0x59, 0x8f, 0x9c, 0x7a, 0x1c, 0xbe, 0xb3, 0x62, 0xd9, 0xac, 0x56,
+  0x8f, 0x8b, 0x37, 0x24, 0x83, 0x9e, 0x3b, 0xef, 0x3d, 0x6a, 0x3f, 0xb3, 0x82, 0x33, 0xb1, 0xb4,
+  0x22, 0x15, 0x10, 0x02, 0xf5, 0x0c, 0xe2, 0x76, 0xcc, 0xd1, 0x93, 0xf2, 0x52, 0x79, 0x7f, 0x70,
+  0xa3, 0x7e, 0xa3, 0x9e, 0x04, 0x07, 0x15, 0x0e, 0x23, 0x6d, 0x6f, 0x98, 0xa0, 0xe7, 0x6d, 0x3d,
+  0x2e, 0xaf, 0xa8, 0x04, 0x87, 0x33, 0xe1, 0x97, 0x22, 0x38, 0xa8, 0xe3, 0x15, 0xac, 0x6d, 0x42,
+  0x4a, 0xb1, 0x57, 0x66, 0xc7, 0x7e, 0xf1, 0xb5, 0xcc, 0x8a, 0x2f, 0x0f, 0x59, 0x91, 0x15, 0x17,
+  0x6d, 0xd9, 0xad, 0x2d, 0xd0, 0x15, 0x6a, 0x3e, 0x02, 0x4f, 0x62, 0xe5, 0xfd, 0x7d, 0x36, 0xbf,
+  0x77, 0x67, 0xb9, 0xc5, 0xd3, 0xea, 0x0a, 0x2d, 0x6d, 0xfd, 0x49, 0xe8, 0x21, 0x8b, 0xcf, 0x24,
+  0xb1, 0xde, 0x11, 0x39, 0x1b, 0x76, 0xd5, 0x23, 0x1f, 0xfc, 0xe4, 0x86, 0xe1, 0xc9, 0xc3, 0xf4,
+  0xc4, 0x59, 0x0b, 0x13, 0x96, 0x66, 0x2d, 0x8f, 0x97, 0xec, 0x3f, 0x4e, 0x47, 0x42, 0x92, 0x7c,
+  0x03, 0x00, 0x00,
+};
+
+// /setting.js, 430 bytes gzip
+static const char assets3Path[] PROGMEM = "/setting.js";
+static const char assets3Type[] PROGMEM = "application/javascript";
+static const char assets3ETag[] PROGMEM = "\"1ae-c600d950\"";
+static const uint8_t assets3Data[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x52, 0x4d, 0x4f, 0xe3, 0x30,
+  0x10, 0xbd, 0xf3, 0x2b, 0x46, 0x5c, 0xec, 0xa8, 0x51, 0x5a, 0xed, 0xb5, 0x94, 0xc3, 0x4a, 0x68,
+  0x01, 0x15, 0x90, 0x96, 0x1e, 0x56, 0x5a, 0x71, 0x30, 0xc9, 0x34, 0xf5, 0xd6, 0x8c, 0x83, 0x3f,
+  0x0a, 0x08, 0xf5, 0xbf, 0x33, 0x4e, 0x9b, 0x36, 0x29, 0x5a, 0x9f, 0x6c, 0xcf, 0x9b, 0x37, 0xef,
+  0x3d, 0x7b, 0xa3, 0x1c, 0xd4, 0x18, 0x6e, 0x1f, 0x1f, 0xee, 0x61, 0x06, 0xcb, 0x48, 0x65, 0xd0,
+  0x96, 0x40, 0x46, 0x67, 0x72, 0x28, 0x95, 0x31, 0xcf, 0xaa, 0x5c, 0x67, 0xf0, 0x79, 0x06, 0xbc,
+  0x36, 0x0c, 0x7e, 0x5f, 0x39, 0x06, 0x12, 0xbe, 0xc1, 0x9f, 0xbb, 0xf9, 0x75, 0x08, 0xcd, 0x6f,
+  0x7c, 0x8d, 0xe8, 0x83, 0xcc, 0xa6, 0x2d, 0x86, 0xeb, 0x85, 0x6d, 0x90, 0xa4, 0xf8, 0x75, 0xb5,
+  0x10, 0x39, 0xb4, 0x44, 0xc1, 0x45, 0xec, 0xd5, 0x1d, 0xfa, 0xc6, 0x92, 0xc7, 0xc5, 0x47, 0x83,
+  0x4c, 0x26, 0xfe, 0x79, 0x4b, 0xa2, 0xd7, 0x4e, 0xc6, 0xaa, 0x6a, 0x20, 0xa7, 0x53, 0xd0, 0xa9,
+  0xf0, 0x41, 0x85, 0xe8, 0x19, 0x92, 0xf0, 0xbb, 0xc3, 0xf4, 0x00, 0xd0, 0x4b, 0x90, 0x1d, 0x60,
+  0x06, 0x3f, 0x26, 0x93, 0x7e, 0x77, 0x5a, 0x9d, 0x2f, 0x49, 0xd1, 0xb0, 0xba, 0xbe, 0xa4, 0xec,
+  0x48, 0xb3, 0x05, 0x34, 0x1e, 0xff, 0xd7, 0xba, 0x1b, 0xd0, 0x87, 0xb7, 0xbb, 0xed, 0xd1, 0x86,
+  0x47, 0xaa, 0x52, 0x2a, 0x7c, 0x75, 0x76, 0x70, 0xf2, 0x40, 0x73, 0xf6, 0x76, 0xf0, 0xb3, 0x8f,
+  0x5e, 0x0a, 0xc2, 0xf0, 0x66, 0xdd, 0xda, 0x73, 0x62, 0x47, 0xd7, 0xe8, 0x5c, 0x0e, 0x95, 0x0a,
+  0xaa, 0x6f, 0x20, 0xb9, 0xe3, 0x42, 0xb2, 0x96, 0xe4, 0x9f, 0x7a, 0x4b, 0xe9, 0xd8, 0x26, 0xf5,
+  0xa7, 0x78, 0x84, 0x98, 0x0e, 0xaa, 0x4b, 0xeb, 0x40, 0x6a, 0x2e, 0x4c, 0xa6, 0xa0, 0xe1, 0xa2,
+  0x25, 0x2f, 0xba, 0xd9, 0x85, 0x41, 0xaa, 0xc3, 0x8a, 0x2b, 0xa3, 0xd1, 0x29, 0x6d, 0x5a, 0x1d,
+  0xed, 0x88, 0x79, 0x2f, 0x76, 0x07, 0x1e, 0x67, 0x22, 0xce, 0xce, 0x05, 0x8c, 0x86, 0x5c, 0x7f,
+  0xf5, 0x53, 0xe1, 0xbd, 0xae, 0xf8, 0x5e, 0x9c, 0xc3, 0xf8, 0xf2, 0x44, 0xc7, 0x76, 0x70, 0xaa,
+  0x6c, 0x19, 0x5f, 0x90, 0x42, 0xc1, 0x71, 0x5c, 0x19, 0x4c, 0xdb, 0x9f, 0x1f, 0x37, 0x95, 0x14,
+  0x89, 0xc1, 0x8b, 0xac, 0xd0, 0x44, 0xe8, 0xae, 0x17, 0x77, 0x73, 0x56, 0xbe, 0x57, 0x31, 0xe4,
+  0x1b, 0x8f, 0x21, 0xac, 0x10, 0x2a, 0xdc, 0xe8, 0x12, 0xc1, 0x97, 0x8a, 0x65, 0x6a, 0x6a, 0xef,
+  0xd2, 0x6b, 0xd5, 0xce, 0x46, 0xaa, 0x72, 0x50, 0x7e, 0x0d, 0xaa, 0x56, 0x5c, 0xb1, 0xc4, 0x38,
+  0x1d, 0x40, 0x7b, 0x9e, 0x4e, 0x38, 0x20, 0x4b, 0x09, 0xb7, 0x66, 0x12, 0x0f, 0x69, 0xaa, 0xb3,
+  0x6f, 0x51, 0x78, 0x0c, 0x0b, 0xfd, 0x82, 0x36, 0x06, 0xb9, 0x7b, 0xd1, 0x3c, 0xfd, 0xb3, 0xc9,
+  0xf7, 0xef, 0x90, 0xde, 0xff, 0x0b, 0x02, 0xbe, 0x5b, 0x45, 0x64, 0x03, 0x00, 0x00,
+};
+
+static const AssetEntry assets[] PROGMEM = {
+  {assets0Path, assets0Type, assets0ETag, assets0Data, 127, ASSET_GZIP},
+  {assets1Path, assets1Type, assets1ETag, assets1Data, 520, ASSET_GZIP},
+  {assets2Path, assets2Type, assets2ETag, assets2Data, 435, ASSET_GZIP},
+  {assets3Path, assets3Type, assets3ETag, assets3Data, 430, ASSET_GZIP},
+};
+
+#endif
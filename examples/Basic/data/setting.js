@@ -17,10 +17,13 @@ function OnLoad() {
     getJSON('networks', function (err, data) {
         if (err == null) {
             var options = '';
-            for (i = 0; i < data.length; i++) {
-                options += '<option value="' + data[i].ssid + '" />';
+            for (i = 0; i < data.networks.length; i++) {
+                options += '<option value="' + data.networks[i].ssid + '" />';
             }
             document.getElementById('ssids').innerHTML = options;
+            // the device scans in the background, ask again once it is done
+            if (data.scanning)
+                setTimeout(OnLoad, 2000);
         }
     });
 }
\ No newline at end of file
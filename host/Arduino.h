@@ -0,0 +1,76 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Linux stand-in for the ESP8266 Arduino core 2.4, see HostSim.h for the
+// knobs tests and benchmarks turn.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+// the IDE passes these on the command line, so does CMakeLists.txt
+#ifndef ARDUINO
+#define ARDUINO 10805
+#endif
+#ifndef ESP8266
+#define ESP8266 1
+#endif
+#ifndef ARDUINO_ARCH_ESP8266
+#define ARDUINO_ARCH_ESP8266 1
+#endif
+#ifndef HOST_BUILD
+#define HOST_BUILD 1
+#endif
+
+#include "pgmspace.h"
+
+#define ICACHE_FLASH_ATTR
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+// the hardware random number generator
+uint32_t hostRandom32();
+#define RANDOM_REG32 (hostRandom32())
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <functional>
+
+using std::min;
+using std::max;
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+#endif
+
+#endif
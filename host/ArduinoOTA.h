@@ -0,0 +1,60 @@
+#ifndef __ARDUINO_OTA_H
+#define __ARDUINO_OTA_H
+
+#include "Arduino.h"
+
+#include <functional>
+
+typedef enum
+{
+    OTA_AUTH_ERROR,
+    OTA_BEGIN_ERROR,
+    OTA_CONNECT_ERROR,
+    OTA_RECEIVE_ERROR,
+    OTA_END_ERROR
+} ota_error_t;
+
+// keeps the settings and callbacks, no update ever arrives
+class ArduinoOTAClass
+{
+  public:
+    typedef std::function<void(void)> THandlerFunction;
+    typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+    typedef std::function<void(unsigned int, unsigned int)> THandlerFunction_Progress;
+
+    ArduinoOTAClass() : _port(8266), _begun(false) {}
+
+    void setPort(uint16_t port) { _port = port; }
+    void setHostname(const char *hostname) { _hostname = hostname; }
+    String getHostname() { return _hostname; }
+    void setPassword(const char *password) { _password = password; }
+    void setPasswordHash(const char *password) { _password = password; }
+    void setRebootOnSuccess(bool reboot) { (void)reboot; }
+
+    void onStart(THandlerFunction fn) { _start_callback = fn; }
+    void onEnd(THandlerFunction fn) { _end_callback = fn; }
+    void onError(THandlerFunction_Error fn) { _error_callback = fn; }
+    void onProgress(THandlerFunction_Progress fn) { _progress_callback = fn; }
+
+    void begin(bool useMDNS = true)
+    {
+        (void)useMDNS;
+        _begun = true;
+    }
+    void handle() {}
+    int getCommandType() { return 0; }
+
+  protected:
+    uint16_t _port;
+    bool _begun;
+    String _hostname;
+    String _password;
+    THandlerFunction _start_callback;
+    THandlerFunction _end_callback;
+    THandlerFunction_Error _error_callback;
+    THandlerFunction_Progress _progress_callback;
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
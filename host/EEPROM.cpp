@@ -0,0 +1,113 @@
+#include "EEPROM.h"
+#include "HostSim.h"
+
+EEPROMClass EEPROM;
+
+static String eepromFile;
+static uint32_t commits = 0;
+
+static String imagePath()
+{
+  if (eepromFile.length())
+    return eepromFile;
+  const char *env = getenv("HOST_EEPROM_FILE");
+  return env && *env ? String(env) : String("eeprom.bin");
+}
+
+EEPROMClass::EEPROMClass() : _data(NULL), _size(0), _dirty(false)
+{
+}
+
+void EEPROMClass::begin(size_t size)
+{
+  if (size == 0)
+    return;
+  if (size > 4096)
+    size = 4096;
+  size = (size + 3) & ~3;
+
+  delete[] _data;
+  _data = new uint8_t[size];
+  _size = size;
+  _dirty = false;
+
+  // an erased sector reads as 0xFF
+  memset(_data, 0xFF, size);
+  FILE *f = fopen(imagePath().c_str(), "rb");
+  if (f)
+  {
+    size_t n = fread(_data, 1, size, f);
+    (void)n;
+    fclose(f);
+  }
+}
+
+void EEPROMClass::end()
+{
+  if (!_size)
+    return;
+  commit();
+  delete[] _data;
+  _data = NULL;
+  _size = 0;
+  _dirty = false;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+  if (address < 0 || (size_t)address >= _size)
+    return 0;
+  return _data[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  if (address < 0 || (size_t)address >= _size)
+    return;
+  if (_data[address] != value)
+  {
+    _data[address] = value;
+    _dirty = true;
+  }
+}
+
+bool EEPROMClass::commit()
+{
+  if (!_size)
+    return false;
+  if (!_dirty)
+    return true;
+
+  FILE *f = fopen(imagePath().c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(_data, 1, _size, f) == _size;
+  ok = fclose(f) == 0 && ok;
+  if (ok)
+  {
+    _dirty = false;
+    ++commits;
+  }
+  return ok;
+}
+
+uint8_t *EEPROMClass::getDataPtr()
+{
+  _dirty = true;
+  return _data;
+}
+
+namespace host
+{
+
+void setEepromFile(const char *path)
+{
+  eepromFile = path ? path : "";
+}
+
+uint32_t eepromCommits()
+{
+  return commits;
+}
+
+} // namespace host
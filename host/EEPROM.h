@@ -0,0 +1,54 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+
+// EEPROM emulation backed by a file instead of a flash sector. commit()
+// writes the file only when something changed, like the core does.
+class EEPROMClass
+{
+  public:
+    EEPROMClass();
+
+    void begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t val);
+    bool commit();
+    void end();
+
+    uint8_t *getDataPtr();
+    const uint8_t *getConstDataPtr() const { return _data; }
+
+    template <typename T>
+    T &get(int address, T &t)
+    {
+        if (address < 0 || address + sizeof(T) > _size)
+            return t;
+        memcpy((uint8_t *)&t, _data + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &t)
+    {
+        if (address < 0 || address + sizeof(T) > _size)
+            return t;
+        if (memcmp(_data + address, (const uint8_t *)&t, sizeof(T)) != 0)
+        {
+            _dirty = true;
+            memcpy(_data + address, (const uint8_t *)&t, sizeof(T));
+        }
+        return t;
+    }
+
+    size_t length() { return _size; }
+
+  protected:
+    uint8_t *_data;
+    size_t _size;
+    bool _dirty;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,1008 @@
+#include "ESP8266WebServer.h"
+
+static const char AUTHORIZATION_HEADER[] = "Authorization";
+static const char WWW_Authenticate[] = "WWW-Authenticate";
+static const char Content_Length[] = "Content-Length";
+
+// on(uri, ...) handlers, the uri must match exactly
+class FunctionRequestHandler : public RequestHandler
+{
+  public:
+    FunctionRequestHandler(ESP8266WebServer::THandlerFunction fn, ESP8266WebServer::THandlerFunction ufn, const String &uri, HTTPMethod method)
+        : _fn(fn), _ufn(ufn), _uri(uri), _method(method)
+    {
+    }
+
+    bool canHandle(HTTPMethod requestMethod, String requestUri) override
+    {
+      if (_method != HTTP_ANY && _method != requestMethod)
+        return false;
+      return requestUri == _uri;
+    }
+
+    bool canUpload(String requestUri) override
+    {
+      return _ufn && canHandle(HTTP_POST, requestUri);
+    }
+
+    bool handle(ESP8266WebServer &server, HTTPMethod requestMethod, String requestUri) override
+    {
+      (void)server;
+      if (!canHandle(requestMethod, requestUri))
+        return false;
+      _fn();
+      return true;
+    }
+
+    void upload(ESP8266WebServer &server, String requestUri, HTTPUpload &upload) override
+    {
+      (void)server;
+      (void)upload;
+      if (canUpload(requestUri))
+        _ufn();
+    }
+
+  protected:
+    ESP8266WebServer::THandlerFunction _fn;
+    ESP8266WebServer::THandlerFunction _ufn;
+    String _uri;
+    HTTPMethod _method;
+};
+
+static String base64Encode(const String &text)
+{
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  String out;
+  const uint8_t *in = (const uint8_t *)text.c_str();
+  size_t len = text.length();
+  for (size_t i = 0; i < len; i += 3)
+  {
+    uint32_t n = in[i] << 16;
+    if (i + 1 < len)
+      n |= in[i + 1] << 8;
+    if (i + 2 < len)
+      n |= in[i + 2];
+    out += table[(n >> 18) & 63];
+    out += table[(n >> 12) & 63];
+    out += i + 1 < len ? table[(n >> 6) & 63] : '=';
+    out += i + 2 < len ? table[n & 63] : '=';
+  }
+  return out;
+}
+
+ESP8266WebServer::ESP8266WebServer(IPAddress addr, int port)
+    : _server(addr, port), _currentMethod(HTTP_ANY), _currentVersion(0), _currentStatus(HC_NONE), _statusChange(0), _currentHandler(nullptr),
+      _firstHandler(nullptr), _lastHandler(nullptr), _currentArgCount(0), _currentArgs(nullptr), _headerKeysCount(0), _currentHeaders(nullptr),
+      _contentLength(0), _chunked(false)
+{
+}
+
+ESP8266WebServer::ESP8266WebServer(int port)
+    : _server(port), _currentMethod(HTTP_ANY), _currentVersion(0), _currentStatus(HC_NONE), _statusChange(0), _currentHandler(nullptr),
+      _firstHandler(nullptr), _lastHandler(nullptr), _currentArgCount(0), _currentArgs(nullptr), _headerKeysCount(0), _currentHeaders(nullptr),
+      _contentLength(0), _chunked(false)
+{
+}
+
+ESP8266WebServer::~ESP8266WebServer()
+{
+  _server.close();
+  delete[] _currentHeaders;
+  delete[] _currentArgs;
+  RequestHandler *handler = _firstHandler;
+  while (handler)
+  {
+    RequestHandler *next = handler->next();
+    // handlers added with addHandler() belong to the caller
+    if (dynamic_cast<FunctionRequestHandler *>(handler))
+      delete handler;
+    handler = next;
+  }
+}
+
+void ESP8266WebServer::begin()
+{
+  close();
+  _server.begin();
+  if (!_headerKeysCount)
+    collectHeaders(0, 0);
+}
+
+void ESP8266WebServer::close()
+{
+  _server.close();
+  _currentStatus = HC_NONE;
+  _currentClient = WiFiClient();
+}
+
+void ESP8266WebServer::stop()
+{
+  close();
+}
+
+bool ESP8266WebServer::authenticate(const char *username, const char *password)
+{
+  String authReq = header(AUTHORIZATION_HEADER);
+  if (!authReq.startsWith("Basic"))
+    return false;
+  authReq = authReq.substring(6);
+  authReq.trim();
+  return authReq == base64Encode(String(username) + ":" + password);
+}
+
+void ESP8266WebServer::requestAuthentication(HTTPAuthMethod mode, const char *realm, const String &authFailMsg)
+{
+  (void)mode;
+  String value = "Basic realm=\"";
+  value += realm ? realm : "Login Required";
+  value += "\"";
+  sendHeader(WWW_Authenticate, value);
+  send(401, "text/html", authFailMsg);
+}
+
+void ESP8266WebServer::on(const String &uri, ESP8266WebServer::THandlerFunction handler)
+{
+  on(uri, HTTP_ANY, handler);
+}
+
+void ESP8266WebServer::on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn)
+{
+  on(uri, method, fn, _fileUploadHandler);
+}
+
+void ESP8266WebServer::on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn, ESP8266WebServer::THandlerFunction ufn)
+{
+  _addRequestHandler(new FunctionRequestHandler(fn, ufn, uri, method));
+}
+
+void ESP8266WebServer::addHandler(RequestHandler *handler)
+{
+  _addRequestHandler(handler);
+}
+
+void ESP8266WebServer::_addRequestHandler(RequestHandler *handler)
+{
+  if (!_lastHandler)
+  {
+    _firstHandler = handler;
+    _lastHandler = handler;
+  }
+  else
+  {
+    _lastHandler->next(handler);
+    _lastHandler = handler;
+  }
+}
+
+void ESP8266WebServer::onNotFound(THandlerFunction fn)
+{
+  _notFoundHandler = fn;
+}
+
+void ESP8266WebServer::onFileUpload(THandlerFunction fn)
+{
+  _fileUploadHandler = fn;
+}
+
+void ESP8266WebServer::handleClient()
+{
+  if (_currentStatus == HC_NONE)
+  {
+    WiFiClient client = _server.available();
+    if (!client)
+      return;
+    _currentClient = client;
+    _currentStatus = HC_WAIT_READ;
+    _statusChange = millis();
+  }
+
+  bool keepCurrentClient = false;
+  bool callYield = false;
+
+  if (_currentClient.connected())
+  {
+    switch (_currentStatus)
+    {
+    case HC_NONE:
+      // No-op to avoid C++ compiler warning
+      break;
+    case HC_WAIT_READ:
+      // Wait for data from client to become available
+      if (_currentClient.available())
+      {
+        if (_parseRequest(_currentClient))
+        {
+          _currentClient.setTimeout(HTTP_MAX_SEND_WAIT);
+          _contentLength = CONTENT_LENGTH_NOT_SET;
+          _handleRequest();
+
+          if (_currentClient.connected())
+          {
+            _currentStatus = HC_WAIT_CLOSE;
+            _statusChange = millis();
+            keepCurrentClient = true;
+          }
+        }
+      }
+      else
+      {
+        // !_currentClient.available()
+        if (millis() - _statusChange <= HTTP_MAX_DATA_WAIT)
+          keepCurrentClient = true;
+        callYield = true;
+      }
+      break;
+    case HC_WAIT_CLOSE:
+      // Wait for client to close the connection
+      if (millis() - _statusChange <= HTTP_MAX_CLOSE_WAIT)
+      {
+        keepCurrentClient = true;
+        callYield = true;
+      }
+    }
+  }
+
+  if (!keepCurrentClient)
+  {
+    _currentClient = WiFiClient();
+    _currentStatus = HC_NONE;
+    _currentUpload.reset();
+  }
+
+  if (callYield)
+    yield();
+}
+
+void ESP8266WebServer::sendHeader(const String &name, const String &value, bool first)
+{
+  String headerLine = name;
+  headerLine += ": ";
+  headerLine += value;
+  headerLine += "\r\n";
+
+  if (first)
+    _responseHeaders = headerLine + _responseHeaders;
+  else
+    _responseHeaders += headerLine;
+}
+
+void ESP8266WebServer::setContentLength(const size_t contentLength)
+{
+  _contentLength = contentLength;
+}
+
+void ESP8266WebServer::_prepareHeader(String &response, int code, const char *content_type, size_t contentLength)
+{
+  response = "HTTP/1." + String(_currentVersion) + " ";
+  response += String(code);
+  response += " ";
+  response += _responseCodeToString(code);
+  response += "\r\n";
+
+  if (!content_type)
+    content_type = "text/html";
+
+  sendHeader("Content-Type", content_type, true);
+  if (_contentLength == CONTENT_LENGTH_NOT_SET)
+  {
+    sendHeader(Content_Length, String((unsigned long)contentLength));
+  }
+  else if (_contentLength != CONTENT_LENGTH_UNKNOWN)
+  {
+    sendHeader(Content_Length, String((unsigned long)_contentLength));
+  }
+  else if (_contentLength == CONTENT_LENGTH_UNKNOWN && _currentVersion)
+  {
+    // HTTP/1.1 or above client, let's do chunked
+    _chunked = true;
+    sendHeader("Accept-Ranges", "none");
+    sendHeader("Transfer-Encoding", "chunked");
+  }
+  sendHeader("Connection", "close");
+
+  response += _responseHeaders;
+  response += "\r\n";
+  _responseHeaders = "";
+}
+
+void ESP8266WebServer::send(int code, const char *content_type, const String &content)
+{
+  String header;
+  _prepareHeader(header, code, content_type, content.length());
+  _currentClientWrite(header.c_str(), header.length());
+  if (content.length())
+    sendContent(content);
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P content_type, PGM_P content)
+{
+  size_t contentLength = 0;
+  if (content != NULL)
+    contentLength = strlen_P(content);
+
+  String header;
+  char type[64];
+  memccpy_P((void *)type, (PGM_VOID_P)content_type, 0, sizeof(type));
+  type[sizeof(type) - 1] = 0;
+  _prepareHeader(header, code, (const char *)type, contentLength);
+  _currentClientWrite(header.c_str(), header.length());
+  sendContent_P(content);
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength)
+{
+  String header;
+  char type[64];
+  memccpy_P((void *)type, (PGM_VOID_P)content_type, 0, sizeof(type));
+  type[sizeof(type) - 1] = 0;
+  _prepareHeader(header, code, (const char *)type, contentLength);
+  sendContent(header);
+  sendContent_P(content, contentLength);
+}
+
+void ESP8266WebServer::send(int code, char *content_type, const String &content)
+{
+  send(code, (const char *)content_type, content);
+}
+
+void ESP8266WebServer::send(int code, const String &content_type, const String &content)
+{
+  send(code, (const char *)content_type.c_str(), content);
+}
+
+void ESP8266WebServer::sendContent(const String &content)
+{
+  const char *footer = "\r\n";
+  size_t len = content.length();
+  if (_chunked)
+  {
+    char chunkSize[11];
+    snprintf(chunkSize, sizeof(chunkSize), "%zx%s", len, footer);
+    _currentClientWrite(chunkSize, strlen(chunkSize));
+  }
+  _currentClientWrite(content.c_str(), len);
+  if (_chunked)
+  {
+    _currentClient.write(footer, 2);
+    if (len == 0)
+      _chunked = false;
+  }
+}
+
+void ESP8266WebServer::sendContent_P(PGM_P content)
+{
+  sendContent_P(content, strlen_P(content));
+}
+
+void ESP8266WebServer::sendContent_P(PGM_P content, size_t size)
+{
+  const char *footer = "\r\n";
+  if (_chunked)
+  {
+    char chunkSize[11];
+    snprintf(chunkSize, sizeof(chunkSize), "%zx%s", size, footer);
+    _currentClientWrite(chunkSize, strlen(chunkSize));
+  }
+  _currentClientWrite_P(content, size);
+  if (_chunked)
+  {
+    _currentClient.write(footer, 2);
+    if (size == 0)
+      _chunked = false;
+  }
+}
+
+void ESP8266WebServer::_streamFileCore(const size_t fileSize, const String &fileName, const String &contentType)
+{
+  setContentLength(fileSize);
+  if (fileName.endsWith(".gz") && contentType != "application/x-gzip" && contentType != "application/octet-stream")
+    sendHeader("Content-Encoding", "gzip");
+  send(200, contentType, "");
+}
+
+String ESP8266WebServer::arg(String name)
+{
+  for (int i = 0; i < _currentArgCount; ++i)
+  {
+    if (_currentArgs[i].key == name)
+      return _currentArgs[i].value;
+  }
+  return String();
+}
+
+String ESP8266WebServer::arg(int i)
+{
+  if (i >= 0 && i < _currentArgCount)
+    return _currentArgs[i].value;
+  return String();
+}
+
+String ESP8266WebServer::argName(int i)
+{
+  if (i >= 0 && i < _currentArgCount)
+    return _currentArgs[i].key;
+  return String();
+}
+
+int ESP8266WebServer::args()
+{
+  return _currentArgCount;
+}
+
+bool ESP8266WebServer::hasArg(const String &name)
+{
+  for (int i = 0; i < _currentArgCount; ++i)
+  {
+    if (_currentArgs[i].key == name)
+      return true;
+  }
+  return false;
+}
+
+String ESP8266WebServer::header(String name)
+{
+  for (int i = 0; i < _headerKeysCount; ++i)
+  {
+    if (_currentHeaders[i].key.equalsIgnoreCase(name))
+      return _currentHeaders[i].value;
+  }
+  return String();
+}
+
+void ESP8266WebServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount)
+{
+  _headerKeysCount = headerKeysCount + 1;
+  delete[] _currentHeaders;
+  _currentHeaders = new RequestArgument[_headerKeysCount];
+  _currentHeaders[0].key = AUTHORIZATION_HEADER;
+  for (int i = 1; i < _headerKeysCount; i++)
+    _currentHeaders[i].key = headerKeys[i - 1];
+}
+
+String ESP8266WebServer::header(int i)
+{
+  if (i >= 0 && i < _headerKeysCount)
+    return _currentHeaders[i].value;
+  return String();
+}
+
+String ESP8266WebServer::headerName(int i)
+{
+  if (i >= 0 && i < _headerKeysCount)
+    return _currentHeaders[i].key;
+  return String();
+}
+
+int ESP8266WebServer::headers()
+{
+  return _headerKeysCount;
+}
+
+bool ESP8266WebServer::hasHeader(String name)
+{
+  for (int i = 0; i < _headerKeysCount; ++i)
+  {
+    if (_currentHeaders[i].key.equalsIgnoreCase(name) && _currentHeaders[i].value.length() > 0)
+      return true;
+  }
+  return false;
+}
+
+String ESP8266WebServer::hostHeader()
+{
+  return _hostHeader;
+}
+
+void ESP8266WebServer::_handleRequest()
+{
+  bool handled = false;
+  if (_currentHandler)
+    handled = _currentHandler->handle(*this, _currentMethod, _currentUri);
+  if (!handled && _notFoundHandler)
+  {
+    _notFoundHandler();
+    handled = true;
+  }
+  if (!handled)
+  {
+    send(404, "text/html", String("Not found: ") + _currentUri);
+    handled = true;
+  }
+  if (handled)
+    _finalizeResponse();
+  _currentUri = "";
+}
+
+void ESP8266WebServer::_finalizeResponse()
+{
+  if (_chunked)
+    sendContent("");
+}
+
+String ESP8266WebServer::_responseCodeToString(int code)
+{
+  switch (code)
+  {
+  case 100: return "Continue";
+  case 101: return "Switching Protocols";
+  case 200: return "OK";
+  case 201: return "Created";
+  case 202: return "Accepted";
+  case 203: return "Non-Authoritative Information";
+  case 204: return "No Content";
+  case 205: return "Reset Content";
+  case 206: return "Partial Content";
+  case 300: return "Multiple Choices";
+  case 301: return "Moved Permanently";
+  case 302: return "Found";
+  case 303: return "See Other";
+  case 304: return "Not Modified";
+  case 305: return "Use Proxy";
+  case 307: return "Temporary Redirect";
+  case 400: return "Bad Request";
+  case 401: return "Unauthorized";
+  case 402: return "Payment Required";
+  case 403: return "Forbidden";
+  case 404: return "Not Found";
+  case 405: return "Method Not Allowed";
+  case 406: return "Not Acceptable";
+  case 407: return "Proxy Authentication Required";
+  case 408: return "Request Time-out";
+  case 409: return "Conflict";
+  case 410: return "Gone";
+  case 411: return "Length Required";
+  case 412: return "Precondition Failed";
+  case 413: return "Request Entity Too Large";
+  case 414: return "Request-URI Too Large";
+  case 415: return "Unsupported Media Type";
+  case 416: return "Requested range not satisfiable";
+  case 417: return "Expectation Failed";
+  case 429: return "Too Many Requests";
+  case 500: return "Internal Server Error";
+  case 501: return "Not Implemented";
+  case 502: return "Bad Gateway";
+  case 503: return "Service Unavailable";
+  case 504: return "Gateway Time-out";
+  case 505: return "HTTP Version not supported";
+  case 507: return "Insufficient Storage";
+  default: return "";
+  }
+}
+
+// reads a line without the CRLF, -1 on a timeout
+static bool readLine(WiFiClient &client, String &line)
+{
+  line = client.readStringUntil('\r');
+  client.readStringUntil('\n');
+  return true;
+}
+
+static char *readBytesWithTimeout(WiFiClient &client, size_t maxLength, size_t &dataLength, int timeout_ms)
+{
+  char *buf = (char *)malloc(maxLength + 1);
+  if (!buf)
+    return NULL;
+  unsigned long timeout = client.getTimeout();
+  client.setTimeout(timeout_ms);
+  dataLength = client.readBytes(buf, maxLength);
+  client.setTimeout(timeout);
+  buf[dataLength] = '\0';
+  return buf;
+}
+
+bool ESP8266WebServer::_parseRequest(WiFiClient &client)
+{
+  // Read the first line of HTTP request
+  String req;
+  readLine(client, req);
+
+  // reset header value
+  for (int i = 0; i < _headerKeysCount; ++i)
+    _currentHeaders[i].value = String();
+
+  // First line of HTTP request looks like "GET /path HTTP/1.1"
+  // Retrieve the "/path" part by finding the spaces
+  int addr_start = req.indexOf(' ');
+  int addr_end = req.indexOf(' ', addr_start + 1);
+  if (addr_start == -1 || addr_end == -1)
+    return false;
+
+  String methodStr = req.substring(0, addr_start);
+  String url = req.substring(addr_start + 1, addr_end);
+  String versionEnd = req.substring(addr_end + 8);
+  _currentVersion = atoi(versionEnd.c_str());
+  String searchStr = "";
+  int hasSearch = url.indexOf('?');
+  if (hasSearch != -1)
+  {
+    searchStr = url.substring(hasSearch + 1);
+    url = url.substring(0, hasSearch);
+  }
+  _currentUri = url;
+  _chunked = false;
+  _hostHeader = "";
+
+  HTTPMethod method = HTTP_GET;
+  if (methodStr == "POST")
+    method = HTTP_POST;
+  else if (methodStr == "DELETE")
+    method = HTTP_DELETE;
+  else if (methodStr == "OPTIONS")
+    method = HTTP_OPTIONS;
+  else if (methodStr == "PUT")
+    method = HTTP_PUT;
+  else if (methodStr == "PATCH")
+    method = HTTP_PATCH;
+  _currentMethod = method;
+
+  // attach handler
+  RequestHandler *handler;
+  for (handler = _firstHandler; handler; handler = handler->next())
+  {
+    if (handler->canHandle(_currentMethod, _currentUri))
+      break;
+  }
+  _currentHandler = handler;
+
+  String boundaryStr;
+  bool isForm = false;
+  bool isEncoded = false;
+  uint32_t contentLength = 0;
+  // parse headers
+  while (1)
+  {
+    readLine(client, req);
+    if (req == "")
+      break; // no moar headers
+    int headerDiv = req.indexOf(':');
+    if (headerDiv == -1)
+      break;
+    String headerName = req.substring(0, headerDiv);
+    String headerValue = req.substring(headerDiv + 1);
+    headerValue.trim();
+    _collectHeader(headerName.c_str(), headerValue.c_str());
+
+    if (headerName.equalsIgnoreCase("Content-Type"))
+    {
+      if (headerValue.startsWith("text/plain"))
+      {
+        isForm = false;
+      }
+      else if (headerValue.startsWith("application/x-www-form-urlencoded"))
+      {
+        isForm = false;
+        isEncoded = true;
+      }
+      else if (headerValue.startsWith("multipart/"))
+      {
+        boundaryStr = headerValue.substring(headerValue.indexOf('=') + 1);
+        boundaryStr.replace("\"", "");
+        isForm = true;
+      }
+    }
+    else if (headerName.equalsIgnoreCase(Content_Length))
+    {
+      contentLength = headerValue.toInt();
+    }
+    else if (headerName.equalsIgnoreCase("Host"))
+    {
+      _hostHeader = headerValue;
+    }
+  }
+
+  // below is needed only when POST type request
+  if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_DELETE)
+  {
+    if (!isForm)
+    {
+      size_t plainLength;
+      char *plainBuf = readBytesWithTimeout(client, contentLength, plainLength, HTTP_MAX_POST_WAIT);
+      if (!plainBuf || plainLength < contentLength)
+      {
+        free(plainBuf);
+        return false;
+      }
+      if (contentLength > 0)
+      {
+        if (isEncoded)
+        {
+          // url encoded form
+          if (searchStr != "")
+            searchStr += '&';
+          searchStr += plainBuf;
+        }
+        _parseArguments(searchStr);
+        if (!isEncoded)
+        {
+          // plain post json or other data
+          RequestArgument &arg = _currentArgs[_currentArgCount++];
+          arg.key = "plain";
+          arg.value = String(plainBuf);
+        }
+      }
+      else
+      {
+        // No content - but we can still have arguments in the URL.
+        _parseArguments(searchStr);
+      }
+      free(plainBuf);
+    }
+    else
+    {
+      _parseArguments(searchStr);
+      if (!_parseForm(client, boundaryStr, contentLength))
+        return false;
+    }
+  }
+  else
+  {
+    _parseArguments(searchStr);
+  }
+  return true;
+}
+
+bool ESP8266WebServer::_collectHeader(const char *headerName, const char *headerValue)
+{
+  for (int i = 0; i < _headerKeysCount; i++)
+  {
+    if (_currentHeaders[i].key.equalsIgnoreCase(headerName))
+    {
+      _currentHeaders[i].value = headerValue;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Arguments without "=" are kept with an empty value, so "?download"
+// works as a flag.
+void ESP8266WebServer::_parseArguments(String data)
+{
+  delete[] _currentArgs;
+  _currentArgs = 0;
+  _currentArgCount = 0;
+
+  if (data.length() == 0)
+  {
+    // room for "plain"
+    _currentArgs = new RequestArgument[1];
+    return;
+  }
+
+  _currentArgCount = 1;
+  for (int i = 0; i < (int)data.length();)
+  {
+    i = data.indexOf('&', i);
+    if (i == -1)
+      break;
+    ++i;
+    ++_currentArgCount;
+  }
+
+  _currentArgs = new RequestArgument[_currentArgCount + 1];
+  int pos = 0;
+  int iarg;
+  for (iarg = 0; iarg < _currentArgCount;)
+  {
+    int next_arg_index = data.indexOf('&', pos);
+    String pair = next_arg_index == -1 ? data.substring(pos) : data.substring(pos, next_arg_index);
+    if (pair.length() > 0)
+    {
+      int equal_sign_index = pair.indexOf('=');
+      RequestArgument &arg = _currentArgs[iarg++];
+      arg.key = urlDecode(equal_sign_index == -1 ? pair : pair.substring(0, equal_sign_index));
+      arg.value = equal_sign_index == -1 ? String() : urlDecode(pair.substring(equal_sign_index + 1));
+    }
+    if (next_arg_index == -1)
+      break;
+    pos = next_arg_index + 1;
+  }
+  _currentArgCount = iarg;
+}
+
+void ESP8266WebServer::_uploadWriteByte(uint8_t b)
+{
+  if (_currentUpload->currentSize == HTTP_UPLOAD_BUFLEN)
+  {
+    if (_currentHandler && _currentHandler->canUpload(_currentUri))
+      _currentHandler->upload(*this, _currentUri, *_currentUpload);
+    _currentUpload->totalSize += _currentUpload->currentSize;
+    _currentUpload->currentSize = 0;
+  }
+  _currentUpload->buf[_currentUpload->currentSize++] = b;
+}
+
+// Reads a multipart/form-data body. Fields become arguments, a file is
+// passed to the upload handler in HTTP_UPLOAD_BUFLEN pieces.
+bool ESP8266WebServer::_parseForm(WiFiClient &client, String boundary, uint32_t len)
+{
+  (void)len;
+  String line;
+  readLine(client, line);
+  if (line != "--" + boundary)
+    return false;
+
+  std::vector<RequestArgument> postArgs;
+  String marker = "\r\n--" + boundary;
+  unsigned long timeout = client.getTimeout();
+  client.setTimeout(HTTP_MAX_POST_WAIT);
+
+  bool ok = false;
+  while (true)
+  {
+    String argName;
+    String argType;
+    String argFilename;
+    bool argIsFile = false;
+
+    // part headers
+    while (true)
+    {
+      readLine(client, line);
+      if (line.length() == 0)
+        break;
+      if (line.startsWith("Content-Disposition") || line.startsWith("content-disposition"))
+      {
+        int nameStart = line.indexOf("name=");
+        if (nameStart != -1)
+        {
+          argName = line.substring(nameStart + 5);
+          int semi = argName.indexOf(';');
+          if (semi != -1)
+            argName = argName.substring(0, semi);
+          argName.replace("\"", "");
+          int fileStart = line.indexOf("filename=");
+          if (fileStart != -1)
+          {
+            argFilename = line.substring(fileStart + 9);
+            argFilename.replace("\"", "");
+            argIsFile = true;
+          }
+        }
+      }
+      else if (line.startsWith("Content-Type") || line.startsWith("content-type"))
+      {
+        argType = line.substring(line.indexOf(':') + 1);
+        argType.trim();
+      }
+    }
+
+    if (argIsFile)
+    {
+      _currentUpload.reset(new HTTPUpload());
+      _currentUpload->status = UPLOAD_FILE_START;
+      _currentUpload->name = argName;
+      _currentUpload->filename = argFilename;
+      _currentUpload->type = argType.length() ? argType : String("text/plain");
+      _currentUpload->totalSize = 0;
+      _currentUpload->currentSize = 0;
+      _currentUpload->contentLength = len;
+      if (_currentHandler && _currentHandler->canUpload(_currentUri))
+        _currentHandler->upload(*this, _currentUri, *_currentUpload);
+      _currentUpload->status = UPLOAD_FILE_WRITE;
+    }
+
+    // the body runs up to CRLF "--" boundary; a CR only starts the marker
+    String value;
+    size_t matched = 0;
+    bool found = false;
+    while (!found)
+    {
+      int c = client.read();
+      if (c < 0)
+      {
+        // wait for more, up to the timeout
+        uint8_t b;
+        if (client.readBytes(&b, 1) != 1)
+          break;
+        c = b;
+      }
+      if ((char)c == marker[matched])
+      {
+        if (++matched == marker.length())
+          found = true;
+        continue;
+      }
+      for (size_t i = 0; i < matched; ++i)
+      {
+        if (argIsFile)
+          _uploadWriteByte(marker[i]);
+        else
+          value += marker[i];
+      }
+      matched = (char)c == marker[0] ? 1 : 0;
+      if (!matched)
+      {
+        if (argIsFile)
+          _uploadWriteByte(c);
+        else
+          value += (char)c;
+      }
+    }
+    if (!found)
+      break;
+
+    if (argIsFile)
+    {
+      // the last piece is passed with UPLOAD_FILE_WRITE, then the end
+      if (_currentUpload->currentSize && _currentHandler && _currentHandler->canUpload(_currentUri))
+        _currentHandler->upload(*this, _currentUri, *_currentUpload);
+      _currentUpload->totalSize += _currentUpload->currentSize;
+      _currentUpload->currentSize = 0;
+      _currentUpload->status = UPLOAD_FILE_END;
+      if (_currentHandler && _currentHandler->canUpload(_currentUri))
+        _currentHandler->upload(*this, _currentUri, *_currentUpload);
+    }
+    else
+    {
+      RequestArgument arg;
+      arg.key = argName;
+      arg.value = value;
+      postArgs.push_back(arg);
+    }
+
+    // "--" after the boundary ends the body, CRLF starts the next part
+    char end[2];
+    if (client.readBytes(end, 2) != 2)
+      break;
+    if (end[0] == '-' && end[1] == '-')
+    {
+      readLine(client, line);
+      ok = true;
+      break;
+    }
+  }
+  client.setTimeout(timeout);
+
+  if (!ok)
+    return _parseFormUploadAborted();
+
+  RequestArgument *args = new RequestArgument[_currentArgCount + postArgs.size() + 1];
+  for (int i = 0; i < _currentArgCount; ++i)
+    args[i] = _currentArgs[i];
+  for (size_t i = 0; i < postArgs.size(); ++i)
+    args[_currentArgCount + i] = postArgs[i];
+  delete[] _currentArgs;
+  _currentArgs = args;
+  _currentArgCount += postArgs.size();
+  return true;
+}
+
+bool ESP8266WebServer::_parseFormUploadAborted()
+{
+  if (_currentUpload)
+  {
+    _currentUpload->status = UPLOAD_FILE_ABORTED;
+    if (_currentHandler && _currentHandler->canUpload(_currentUri))
+      _currentHandler->upload(*this, _currentUri, *_currentUpload);
+  }
+  return false;
+}
+
+String ESP8266WebServer::urlDecode(const String &text)
+{
+  String decoded = "";
+  char temp[] = "0x00";
+  unsigned int len = text.length();
+  unsigned int i = 0;
+  while (i < len)
+  {
+    char decodedChar;
+    char encodedChar = text.charAt(i++);
+    if ((encodedChar == '%') && (i + 1 < len))
+    {
+      temp[2] = text.charAt(i++);
+      temp[3] = text.charAt(i++);
+      decodedChar = strtol(temp, NULL, 16);
+    }
+    else
+    {
+      if (encodedChar == '+')
+        decodedChar = ' ';
+      else
+        decodedChar = encodedChar; // normal ascii char
+    }
+    decoded += decodedChar;
+  }
+  return decoded;
+}
@@ -0,0 +1,226 @@
+#ifndef ESP8266WEBSERVER_H
+#define ESP8266WEBSERVER_H
+
+#include "Arduino.h"
+#include "ESP8266WiFi.h"
+#include "FS.h"
+
+#include <functional>
+#include <memory>
+
+// The web server of core 2.4.2 with the same protected members, so code
+// that reaches into them (MeteredWebServer) builds on the host unchanged.
+
+enum HTTPMethod
+{
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+enum HTTPUploadStatus
+{
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED
+};
+enum HTTPClientStatus
+{
+    HC_NONE,
+    HC_WAIT_READ,
+    HC_WAIT_CLOSE
+};
+enum HTTPAuthMethod
+{
+    BASIC_AUTH,
+    DIGEST_AUTH
+};
+
+#define HTTP_DOWNLOAD_UNIT_SIZE 1460
+
+#ifndef HTTP_UPLOAD_BUFLEN
+#define HTTP_UPLOAD_BUFLEN 2048
+#endif
+
+#define HTTP_MAX_DATA_WAIT 5000  // ms to wait for the client to send the request
+#define HTTP_MAX_POST_WAIT 5000  // ms to wait for POST data to arrive
+#define HTTP_MAX_SEND_WAIT 5000  // ms to wait for data chunk to be ACKed
+#define HTTP_MAX_CLOSE_WAIT 2000 // ms to wait for the client to close the connection
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class ESP8266WebServer;
+
+typedef struct
+{
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;   // file size
+    size_t currentSize; // size of data currently in buf
+    size_t contentLength;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+} HTTPUpload;
+
+class RequestHandler
+{
+  public:
+    virtual ~RequestHandler() {}
+    virtual bool canHandle(HTTPMethod method, String uri)
+    {
+        (void)method;
+        (void)uri;
+        return false;
+    }
+    virtual bool canUpload(String uri)
+    {
+        (void)uri;
+        return false;
+    }
+    virtual bool handle(ESP8266WebServer &server, HTTPMethod requestMethod, String requestUri)
+    {
+        (void)server;
+        (void)requestMethod;
+        (void)requestUri;
+        return false;
+    }
+    virtual void upload(ESP8266WebServer &server, String requestUri, HTTPUpload &upload)
+    {
+        (void)server;
+        (void)requestUri;
+        (void)upload;
+    }
+
+    RequestHandler *next() { return _next; }
+    void next(RequestHandler *r) { _next = r; }
+
+  private:
+    RequestHandler *_next = nullptr;
+};
+
+class ESP8266WebServer
+{
+  public:
+    ESP8266WebServer(IPAddress addr, int port = 80);
+    ESP8266WebServer(int port = 80);
+    virtual ~ESP8266WebServer();
+
+    virtual void begin();
+    virtual void handleClient();
+
+    virtual void close();
+    void stop();
+
+    bool authenticate(const char *username, const char *password);
+    void requestAuthentication(HTTPAuthMethod mode = BASIC_AUTH, const char *realm = NULL, const String &authFailMsg = String(""));
+
+    typedef std::function<void(void)> THandlerFunction;
+    void on(const String &uri, THandlerFunction handler);
+    void on(const String &uri, HTTPMethod method, THandlerFunction fn);
+    void on(const String &uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn);
+    void addHandler(RequestHandler *handler);
+    void onNotFound(THandlerFunction fn);   // called when handler is not assigned
+    void onFileUpload(THandlerFunction fn); // handle file uploads
+
+    String uri() { return _currentUri; }
+    HTTPMethod method() { return _currentMethod; }
+    virtual WiFiClient client() { return _currentClient; }
+    HTTPUpload &upload() { return *_currentUpload; }
+
+    String arg(String name);        // get request argument value by name
+    String arg(int i);              // get request argument value by number
+    String argName(int i);          // get request argument name by number
+    int args();                     // get arguments count
+    bool hasArg(const String &name); // check if argument exists
+
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount); // set the request headers to collect
+    String header(String name);      // get request header value by name
+    String header(int i);            // get request header value by number
+    String headerName(int i);        // get request header name by number
+    int headers();                   // get header count
+    bool hasHeader(String name);     // check if header exists
+
+    String hostHeader(); // get request host header if available or empty String if not
+
+    // send response to the client
+    // code - HTTP response code, can be 200 or 404
+    // content_type - HTTP content type, like "text/plain" or "image/png"
+    // content - actual content body
+    void send(int code, const char *content_type = NULL, const String &content = String(""));
+    void send(int code, char *content_type, const String &content);
+    void send(int code, const String &content_type, const String &content);
+    void send_P(int code, PGM_P content_type, PGM_P content);
+    void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+
+    void setContentLength(const size_t contentLength);
+    void sendHeader(const String &name, const String &value, bool first = false);
+    void sendContent(const String &content);
+    void sendContent_P(PGM_P content);
+    void sendContent_P(PGM_P content, size_t size);
+
+    static String urlDecode(const String &text);
+
+    template <typename T>
+    size_t streamFile(T &file, const String &contentType)
+    {
+        _streamFileCore(file.size(), file.name(), contentType);
+        return _currentClient.write(file);
+    }
+
+  protected:
+    virtual size_t _currentClientWrite(const char *b, size_t l) { return _currentClient.write(b, l); }
+    virtual size_t _currentClientWrite_P(PGM_P b, size_t l) { return _currentClient.write_P(b, l); }
+    void _addRequestHandler(RequestHandler *handler);
+    void _handleRequest();
+    void _finalizeResponse();
+    bool _parseRequest(WiFiClient &client);
+    void _parseArguments(String data);
+    static String _responseCodeToString(int code);
+    bool _parseForm(WiFiClient &client, String boundary, uint32_t len);
+    bool _parseFormUploadAborted();
+    void _uploadWriteByte(uint8_t b);
+    void _prepareHeader(String &response, int code, const char *content_type, size_t contentLength);
+    bool _collectHeader(const char *headerName, const char *headerValue);
+    void _streamFileCore(const size_t fileSize, const String &fileName, const String &contentType);
+
+    struct RequestArgument
+    {
+        String key;
+        String value;
+    };
+
+    WiFiServer _server;
+
+    WiFiClient _currentClient;
+    HTTPMethod _currentMethod;
+    String _currentUri;
+    uint8_t _currentVersion;
+    HTTPClientStatus _currentStatus;
+    unsigned long _statusChange;
+
+    RequestHandler *_currentHandler;
+    RequestHandler *_firstHandler;
+    RequestHandler *_lastHandler;
+    THandlerFunction _notFoundHandler;
+    THandlerFunction _fileUploadHandler;
+
+    int _currentArgCount;
+    RequestArgument *_currentArgs;
+    std::unique_ptr<HTTPUpload> _currentUpload;
+
+    int _headerKeysCount;
+    RequestArgument *_currentHeaders;
+    size_t _contentLength;
+    String _responseHeaders;
+
+    String _hostHeader;
+    bool _chunked;
+};
+
+#endif
@@ -0,0 +1,343 @@
+#include "ESP8266WiFi.h"
+
+ESP8266WiFiClass WiFi;
+
+static std::vector<host::Network> scripted;
+static unsigned long scanTime = 2000;
+static uint32_t beginCount = 0;
+static bool dropped = false;
+static bool dhcp = true;
+
+ESP8266WiFiClass::ESP8266WiFiClass()
+    : _mode(WIFI_STA), _channel(0), _hasBssid(false), _joining(false), _lost(false), _joinAt(0), _apUp(false), _scanning(false),
+      _scanned(false), _scanAt(0)
+{
+  memset(_bssid, 0, sizeof(_bssid));
+}
+
+bool ESP8266WiFiClass::mode(WiFiMode_t mode)
+{
+  _mode = mode;
+  if (!(mode & WIFI_STA))
+    _joining = false;
+  if (!(mode & WIFI_AP))
+    _apUp = false;
+  return true;
+}
+
+bool ESP8266WiFiClass::enableSTA(bool enable)
+{
+  return mode((WiFiMode_t)(enable ? _mode | WIFI_STA : _mode & ~WIFI_STA));
+}
+
+bool ESP8266WiFiClass::enableAP(bool enable)
+{
+  return mode((WiFiMode_t)(enable ? _mode | WIFI_AP : _mode & ~WIFI_AP));
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel, const uint8_t *bssid, bool connect)
+{
+  _ssid = ssid ? ssid : "";
+  _pass = passphrase ? passphrase : "";
+  _channel = channel;
+  _hasBssid = bssid != NULL;
+  if (bssid)
+    memcpy(_bssid, bssid, sizeof(_bssid));
+  else
+    memset(_bssid, 0, sizeof(_bssid));
+  if (connect)
+    return begin();
+  return status();
+}
+
+wl_status_t ESP8266WiFiClass::begin()
+{
+  enableSTA(true);
+  ++beginCount;
+  _joining = true;
+  _lost = false;
+  dropped = false;
+  _joinAt = millis();
+  return status();
+}
+
+bool ESP8266WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2)
+{
+  (void)dns2;
+  // as in core 2.4.2: only all three zero starts the DHCP client again,
+  // anything else is a static address, even with the ip left at zero
+  dhcp = (uint32_t)local_ip == 0 && (uint32_t)gateway == 0 && (uint32_t)subnet == 0;
+  _ip = local_ip;
+  _gateway = gateway;
+  _subnet = subnet;
+  _dns = dns1;
+  return true;
+}
+
+bool ESP8266WiFiClass::reconnect()
+{
+  if (!_joining)
+    return false;
+  begin();
+  return true;
+}
+
+bool ESP8266WiFiClass::disconnect(bool wifioff)
+{
+  _joining = false;
+  if (wifioff)
+    enableSTA(false);
+  return true;
+}
+
+int ESP8266WiFiClass::findJoined()
+{
+  for (size_t i = 0; i < scripted.size(); ++i)
+  {
+    const host::Network &net = scripted[i];
+    if (net.ssid != _ssid)
+      continue;
+    // a direct connect only finds the access point where it was
+    if (_channel && net.channel != _channel)
+      continue;
+    if (_hasBssid && memcmp(net.bssid, _bssid, sizeof(_bssid)) != 0)
+      continue;
+    return i;
+  }
+  return -1;
+}
+
+wl_status_t ESP8266WiFiClass::status()
+{
+  if (!(_mode & WIFI_STA) || !_joining)
+    return WL_DISCONNECTED;
+  if (dropped && !_lost)
+    _lost = true;
+  if (_lost)
+    return WL_CONNECTION_LOST;
+
+  int index = findJoined();
+  if (index < 0)
+    return millis() - _joinAt >= scanTime ? WL_NO_SSID_AVAIL : WL_DISCONNECTED;
+  const host::Network &net = scripted[index];
+  if (millis() - _joinAt < net.connectDelay)
+    return WL_DISCONNECTED;
+  if (net.encrypted && net.pass != _pass)
+    return WL_CONNECT_FAILED;
+  return WL_CONNECTED;
+}
+
+IPAddress ESP8266WiFiClass::localIP()
+{
+  if (status() != WL_CONNECTED)
+    return IPAddress();
+  return !dhcp ? _ip : IPAddress(192, 168, 1, 100);
+}
+
+IPAddress ESP8266WiFiClass::subnetMask()
+{
+  return !dhcp ? _subnet : IPAddress(255, 255, 255, 0);
+}
+
+IPAddress ESP8266WiFiClass::gatewayIP()
+{
+  return !dhcp ? _gateway : IPAddress(192, 168, 1, 1);
+}
+
+IPAddress ESP8266WiFiClass::dnsIP(uint8_t dns_no)
+{
+  (void)dns_no;
+  return !dhcp ? _dns : IPAddress(192, 168, 1, 1);
+}
+
+String ESP8266WiFiClass::macAddress()
+{
+  return "5C:CF:7F:C0:FF:EE";
+}
+
+bool ESP8266WiFiClass::hostname(const char *name)
+{
+  _hostname = name;
+  return true;
+}
+
+String ESP8266WiFiClass::hostname()
+{
+  return _hostname.length() ? _hostname : String("ESP_C0FFEE");
+}
+
+String ESP8266WiFiClass::SSID() const
+{
+  return _ssid;
+}
+
+String ESP8266WiFiClass::psk() const
+{
+  return _pass;
+}
+
+uint8_t *ESP8266WiFiClass::BSSID()
+{
+  int index = status() == WL_CONNECTED ? findJoined() : -1;
+  if (index < 0)
+    return NULL;
+  memcpy(_bssid, scripted[index].bssid, sizeof(_bssid));
+  return _bssid;
+}
+
+static String formatBssid(const uint8_t *bssid)
+{
+  char buf[18];
+  if (!bssid)
+    return String();
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+  return String(buf);
+}
+
+String ESP8266WiFiClass::BSSIDstr()
+{
+  return formatBssid(BSSID());
+}
+
+int32_t ESP8266WiFiClass::RSSI()
+{
+  int index = status() == WL_CONNECTED ? findJoined() : -1;
+  return index < 0 ? 31 : scripted[index].rssi;
+}
+
+int32_t ESP8266WiFiClass::channel()
+{
+  int index = status() == WL_CONNECTED ? findJoined() : -1;
+  return index < 0 ? _channel : scripted[index].channel;
+}
+
+bool ESP8266WiFiClass::softAP(const char *ssid, const char *passphrase, int channel, int ssid_hidden, int max_connection)
+{
+  (void)ssid;
+  (void)channel;
+  (void)ssid_hidden;
+  (void)max_connection;
+  // the SDK refuses a passphrase shorter than WPA allows
+  if (passphrase && *passphrase && strlen(passphrase) < 8)
+    return false;
+  enableAP(true);
+  _apUp = true;
+  return true;
+}
+
+bool ESP8266WiFiClass::softAPdisconnect(bool wifioff)
+{
+  _apUp = false;
+  if (wifioff)
+    enableAP(false);
+  return true;
+}
+
+IPAddress ESP8266WiFiClass::softAPIP()
+{
+  return _apUp ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+int8_t ESP8266WiFiClass::scanNetworks(bool async, bool show_hidden, uint8_t channel, uint8_t *ssid)
+{
+  (void)show_hidden;
+  (void)channel;
+  (void)ssid;
+  _results.clear();
+  _scanning = true;
+  _scanned = false;
+  _scanAt = millis();
+  if (async)
+    return WIFI_SCAN_RUNNING;
+  // a blocking scan takes its time all the same
+  delay(scanTime);
+  return scanComplete();
+}
+
+int8_t ESP8266WiFiClass::scanComplete()
+{
+  if (_scanning && millis() - _scanAt >= scanTime)
+  {
+    _results = scripted;
+    _scanning = false;
+    _scanned = true;
+  }
+  if (_scanning)
+    return WIFI_SCAN_RUNNING;
+  if (!_scanned)
+    return WIFI_SCAN_FAILED;
+  return _results.size() > 127 ? 127 : _results.size();
+}
+
+void ESP8266WiFiClass::scanDelete()
+{
+  _results.clear();
+  _scanned = false;
+}
+
+String ESP8266WiFiClass::SSID(uint8_t i)
+{
+  return i < _results.size() ? _results[i].ssid : String();
+}
+
+uint8_t ESP8266WiFiClass::encryptionType(uint8_t i)
+{
+  if (i >= _results.size())
+    return -1;
+  return _results[i].encrypted ? ENC_TYPE_CCMP : ENC_TYPE_NONE;
+}
+
+int32_t ESP8266WiFiClass::RSSI(uint8_t i)
+{
+  return i < _results.size() ? _results[i].rssi : 0;
+}
+
+uint8_t *ESP8266WiFiClass::BSSID(uint8_t i)
+{
+  return i < _results.size() ? _results[i].bssid : NULL;
+}
+
+String ESP8266WiFiClass::BSSIDstr(uint8_t i)
+{
+  return formatBssid(BSSID(i));
+}
+
+int32_t ESP8266WiFiClass::channel(uint8_t i)
+{
+  return i < _results.size() ? _results[i].channel : 0;
+}
+
+namespace host
+{
+
+void addNetwork(const Network &network)
+{
+  scripted.push_back(network);
+}
+
+void clearNetworks()
+{
+  scripted.clear();
+}
+
+void setScanTime(unsigned long ms)
+{
+  scanTime = ms;
+}
+
+void dropWifi()
+{
+  dropped = true;
+}
+
+uint32_t wifiBegins()
+{
+  return beginCount;
+}
+
+bool wifiDhcp()
+{
+  return dhcp;
+}
+
+} // namespace host
@@ -0,0 +1,128 @@
+#ifndef ESP8266WiFi_h
+#define ESP8266WiFi_h
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+#include "HostSim.h"
+
+#include <vector>
+
+typedef enum WiFiMode
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+typedef enum
+{
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+enum wl_enc_type
+{
+    ENC_TYPE_WEP = 5,
+    ENC_TYPE_TKIP = 2,
+    ENC_TYPE_CCMP = 4,
+    ENC_TYPE_NONE = 7,
+    ENC_TYPE_AUTO = 8
+};
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+#define WL_MAC_ADDR_LENGTH 6
+
+// Station and access point driven by the script of host::addNetwork().
+// Sockets always use 127.0.0.1, the addresses here are what a sketch
+// would see on a network.
+class ESP8266WiFiClass
+{
+  public:
+    ESP8266WiFiClass();
+
+    bool mode(WiFiMode_t mode);
+    WiFiMode_t getMode() { return _mode; }
+    bool enableSTA(bool enable);
+    bool enableAP(bool enable);
+    bool persistent(bool persistent) { (void)persistent; return true; }
+    bool setAutoConnect(bool autoConnect) { (void)autoConnect; return true; }
+    bool setAutoReconnect(bool autoReconnect) { (void)autoReconnect; return true; }
+
+    wl_status_t begin(const char *ssid, const char *passphrase = NULL, int32_t channel = 0, const uint8_t *bssid = NULL, bool connect = true);
+    wl_status_t begin();
+    bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = (uint32_t)0, IPAddress dns2 = (uint32_t)0);
+    bool reconnect();
+    bool disconnect(bool wifioff = false);
+    bool isConnected() { return status() == WL_CONNECTED; }
+    wl_status_t status();
+
+    IPAddress localIP();
+    IPAddress subnetMask();
+    IPAddress gatewayIP();
+    IPAddress dnsIP(uint8_t dns_no = 0);
+    String macAddress();
+    bool hostname(const char *name);
+    bool hostname(const String &name) { return hostname(name.c_str()); }
+    String hostname();
+
+    String SSID() const;
+    String psk() const;
+    uint8_t *BSSID();
+    String BSSIDstr();
+    int32_t RSSI();
+    int32_t channel();
+
+    bool softAP(const char *ssid, const char *passphrase = NULL, int channel = 1, int ssid_hidden = 0, int max_connection = 4);
+    bool softAPdisconnect(bool wifioff = false);
+    IPAddress softAPIP();
+
+    int8_t scanNetworks(bool async = false, bool show_hidden = false, uint8_t channel = 0, uint8_t *ssid = NULL);
+    int8_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t networkItem);
+    uint8_t encryptionType(uint8_t networkItem);
+    int32_t RSSI(uint8_t networkItem);
+    uint8_t *BSSID(uint8_t networkItem);
+    String BSSIDstr(uint8_t networkItem);
+    int32_t channel(uint8_t networkItem);
+    bool isHidden(uint8_t networkItem) { (void)networkItem; return false; }
+
+  protected:
+    // index of the scripted network begin() was given, -1 if unknown
+    int findJoined();
+
+    WiFiMode_t _mode;
+    String _ssid;
+    String _pass;
+    int32_t _channel;
+    uint8_t _bssid[WL_MAC_ADDR_LENGTH];
+    bool _hasBssid;
+    bool _joining;
+    bool _lost;
+    unsigned long _joinAt;
+    IPAddress _ip;
+    IPAddress _gateway;
+    IPAddress _subnet;
+    IPAddress _dns;
+    String _hostname;
+    bool _apUp;
+
+    bool _scanning;
+    bool _scanned;
+    unsigned long _scanAt;
+    std::vector<host::Network> _results;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
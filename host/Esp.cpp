@@ -0,0 +1,157 @@
+#include "Arduino.h"
+#include "HostSim.h"
+
+#include <map>
+#include <vector>
+
+EspClass ESP;
+
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_CHIP_SIZE   (4UL << 20)
+#define RTC_USER_SIZE     512
+
+// sectors are allocated on first use, untouched flash reads as erased
+static std::map<uint32_t, std::vector<uint8_t> > flashSectors;
+static std::map<uint32_t, uint32_t> flashEraseCounts;
+static uint32_t flashWriteCount = 0;
+static int flashWritesLeft = -1;
+static int flashTornLeft = -1;
+static uint32_t rtcMemory[RTC_USER_SIZE / 4];
+
+static std::vector<uint8_t> &sectorData(uint32_t sector)
+{
+  std::vector<uint8_t> &data = flashSectors[sector];
+  if (data.empty())
+    data.assign(FLASH_SECTOR_SIZE, 0xFF);
+  return data;
+}
+
+uint32_t EspClass::getChipId()
+{
+  return 0x00C0FFEE;
+}
+
+uint8_t EspClass::getCpuFreqMHz()
+{
+  return 80;
+}
+
+// the host counts microseconds at the 80 MHz of the device
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(micros() * 80ULL);
+}
+
+String EspClass::getResetReason()
+{
+  return "Power on";
+}
+
+const char *EspClass::getSdkVersion()
+{
+  return "host";
+}
+
+uint32_t EspClass::getFlashChipSize()
+{
+  return FLASH_CHIP_SIZE;
+}
+
+bool EspClass::flashEraseSector(uint32_t sector)
+{
+  if ((sector + 1) * FLASH_SECTOR_SIZE > FLASH_CHIP_SIZE)
+    return false;
+  sectorData(sector).assign(FLASH_SECTOR_SIZE, 0xFF);
+  ++flashEraseCounts[sector];
+  return true;
+}
+
+bool EspClass::flashWrite(uint32_t offset, uint32_t *data, size_t size)
+{
+  if ((offset & 3) || (size & 3) || offset + size > FLASH_CHIP_SIZE)
+    return false;
+  ++flashWriteCount;
+
+  size_t len = size;
+  bool torn = flashWritesLeft == 0;
+  if (torn)
+  {
+    len = (size / 2) & ~3UL;
+    if (flashTornLeft > 0 && --flashTornLeft == 0)
+      flashWritesLeft = -1;
+  }
+  else if (flashWritesLeft > 0)
+  {
+    --flashWritesLeft;
+  }
+
+  // programming only clears bits, like NOR flash
+  const uint8_t *src = (const uint8_t *)data;
+  for (size_t i = 0; i < len; ++i)
+  {
+    uint32_t addr = offset + i;
+    sectorData(addr / FLASH_SECTOR_SIZE)[addr % FLASH_SECTOR_SIZE] &= src[i];
+  }
+  return !torn;
+}
+
+bool EspClass::flashRead(uint32_t offset, uint32_t *data, size_t size)
+{
+  if ((offset & 3) || (size & 3) || offset + size > FLASH_CHIP_SIZE)
+    return false;
+  uint8_t *dst = (uint8_t *)data;
+  for (size_t i = 0; i < size; ++i)
+  {
+    uint32_t addr = offset + i;
+    std::map<uint32_t, std::vector<uint8_t> >::const_iterator it = flashSectors.find(addr / FLASH_SECTOR_SIZE);
+    dst[i] = it == flashSectors.end() ? 0xFF : it->second[addr % FLASH_SECTOR_SIZE];
+  }
+  return true;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size)
+{
+  if (offset * 4 + size > RTC_USER_SIZE || (size & 3))
+    return false;
+  memcpy(data, rtcMemory + offset, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size)
+{
+  if (offset * 4 + size > RTC_USER_SIZE || (size & 3))
+    return false;
+  memcpy(rtcMemory + offset, data, size);
+  return true;
+}
+
+namespace host
+{
+
+uint32_t flashErases(uint32_t sector)
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = flashEraseCounts.find(sector);
+  return it == flashEraseCounts.end() ? 0 : it->second;
+}
+
+uint32_t flashWrites()
+{
+  return flashWriteCount;
+}
+
+void failFlashWritesAfter(int count, int failures)
+{
+  flashWritesLeft = count;
+  flashTornLeft = failures;
+}
+
+void resetFlash()
+{
+  flashSectors.clear();
+  flashEraseCounts.clear();
+  flashWriteCount = 0;
+  flashWritesLeft = -1;
+  flashTornLeft = -1;
+}
+
+} // namespace host
@@ -0,0 +1,39 @@
+#ifndef Esp_h
+#define Esp_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "WString.h"
+
+// The parts of the SDK the library uses. Heap figures follow the
+// allocations of the process, see Heap.cpp; flash and RTC memory are
+// kept in RAM with the erase and write rules of the real parts.
+class EspClass
+{
+  public:
+    void restart();
+    void reset() { restart(); }
+
+    uint32_t getFreeHeap();
+    uint16_t getMaxFreeBlockSize();
+    uint8_t getHeapFragmentation();
+    uint32_t getChipId();
+    uint8_t getCpuFreqMHz();
+    uint32_t getCycleCount();
+    String getResetReason();
+    const char *getSdkVersion();
+
+    uint32_t getFlashChipSize();
+    uint32_t getFlashChipRealSize() { return getFlashChipSize(); }
+    bool flashEraseSector(uint32_t sector);
+    bool flashWrite(uint32_t offset, uint32_t *data, size_t size);
+    bool flashRead(uint32_t offset, uint32_t *data, size_t size);
+
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,449 @@
+#include "FS.h"
+#include "HostSim.h"
+
+#include <algorithm>
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPIFFS_OBJ_NAME_LEN   32
+#define SPIFFS_PAGE_SIZE      256
+#define SPIFFS_BLOCK_SIZE     8192
+#define SPIFFS_MAX_OPEN_FILES 5
+
+static String defaultRoot;
+static size_t capacity = 1024 * 1024;
+static int renameFailures = 0;
+static int renamesBeforeFailure = 0;
+static uint32_t pageWrites = 0;
+static size_t bytesRead = 0;
+
+fs::FS SPIFFS;
+
+namespace fs
+{
+
+// bytes a file takes, whole pages
+static size_t pages(size_t size)
+{
+  return (size + SPIFFS_PAGE_SIZE - 1) / SPIFFS_PAGE_SIZE * SPIFFS_PAGE_SIZE;
+}
+
+class FSImpl
+{
+  public:
+    FSImpl(const char *root) : root(root ? root : ""), used(0), mounted(false) {}
+
+    String base()
+    {
+      if (root.length())
+        return root;
+      if (defaultRoot.length())
+        return defaultRoot;
+      const char *env = getenv("HOST_SPIFFS_DIR");
+      return env && *env ? String(env) : String("spiffs");
+    }
+
+    // host path of a SPIFFS name, empty when the name is not allowed
+    String hostPath(const char *path)
+    {
+      if (!path || !*path || strlen(path) > SPIFFS_OBJ_NAME_LEN - 1)
+        return String();
+      String name = path;
+      if (name.indexOf("..") >= 0)
+        return String();
+      if (!name.startsWith("/"))
+        name = "/" + name;
+      return base() + name;
+    }
+
+    static bool makeParents(const String &path)
+    {
+      for (int slash = path.indexOf('/', 1); slash > 0; slash = path.indexOf('/', slash + 1))
+      {
+        String dir = path.substring(0, slash);
+        if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST)
+          return false;
+      }
+      return true;
+    }
+
+    static size_t fileSize(const String &path)
+    {
+      struct stat st;
+      return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) ? st.st_size : 0;
+    }
+
+    static bool isFile(const String &path)
+    {
+      struct stat st;
+      return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    }
+
+    void walk(const String &dir, const String &prefix, std::vector<String> &names, std::vector<size_t> &sizes)
+    {
+      DIR *d = opendir(dir.c_str());
+      if (!d)
+        return;
+      struct dirent *entry;
+      while ((entry = readdir(d)) != NULL)
+      {
+        if (entry->d_name[0] == '.' && (entry->d_name[1] == 0 || (entry->d_name[1] == '.' && entry->d_name[2] == 0)))
+          continue;
+        String path = dir + "/" + entry->d_name;
+        String name = prefix + "/" + entry->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+          continue;
+        if (S_ISDIR(st.st_mode))
+        {
+          walk(path, name, names, sizes);
+        }
+        else if (S_ISREG(st.st_mode))
+        {
+          names.push_back(name);
+          sizes.push_back(st.st_size);
+        }
+      }
+      closedir(d);
+    }
+
+    void recount()
+    {
+      std::vector<String> names;
+      std::vector<size_t> sizes;
+      walk(base(), "", names, sizes);
+      used = 0;
+      for (size_t i = 0; i < sizes.size(); ++i)
+        used += pages(sizes[i]);
+    }
+
+    String root;
+    size_t used;
+    bool mounted;
+};
+
+class FileImpl
+{
+  public:
+    FileImpl(const FSImplPtr &fs, FILE *f, const char *name, size_t size) : fs(fs), f(f), name(name), size(size) {}
+    ~FileImpl() { close(); }
+
+    void close()
+    {
+      if (f)
+        fclose(f);
+      f = NULL;
+    }
+
+    FSImplPtr fs;
+    FILE *f;
+    String name;
+    size_t size;
+};
+
+size_t File::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+  if (!_p || !_p->f)
+    return 0;
+  size_t pos = ftell(_p->f);
+  // a full SPIFFS writes what fits and reports the short write
+  size_t room = capacity > _p->fs->used ? capacity - _p->fs->used : 0;
+  size_t limit = pages(_p->size) + room;
+  if (pos + size > limit)
+    size = limit > pos ? limit - pos : 0;
+  size_t n = fwrite(buf, 1, size, _p->f);
+  if (n > 0)
+    pageWrites += (pos + n - 1) / SPIFFS_PAGE_SIZE - pos / SPIFFS_PAGE_SIZE + 1;
+  size_t end = max(pos + n, _p->size);
+  _p->fs->used += pages(end) - pages(_p->size);
+  _p->size = end;
+  return n;
+}
+
+int File::available()
+{
+  if (!_p || !_p->f)
+    return 0;
+  long pos = ftell(_p->f);
+  return pos < (long)_p->size ? _p->size - pos : 0;
+}
+
+int File::read()
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek()
+{
+  if (!_p || !_p->f)
+    return -1;
+  int c = fgetc(_p->f);
+  if (c != EOF)
+    ungetc(c, _p->f);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush()
+{
+  if (_p && _p->f)
+    fflush(_p->f);
+}
+
+size_t File::read(uint8_t *buf, size_t size)
+{
+  if (!_p || !_p->f)
+    return 0;
+  size_t n = fread(buf, 1, size, _p->f);
+  bytesRead += n;
+  return n;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+  if (!_p || !_p->f)
+    return false;
+  long target = pos;
+  if (mode == SeekCur)
+    target += ftell(_p->f);
+  else if (mode == SeekEnd)
+    target = _p->size - pos;
+  // SPIFFS does not seek past the end
+  if (target < 0 || target > (long)_p->size)
+    return false;
+  return fseek(_p->f, target, SEEK_SET) == 0;
+}
+
+size_t File::position() const
+{
+  if (!_p || !_p->f)
+    return 0;
+  return ftell(_p->f);
+}
+
+size_t File::size() const
+{
+  return _p ? _p->size : 0;
+}
+
+void File::close()
+{
+  if (_p)
+  {
+    _p->close();
+    _p = FileImplPtr();
+  }
+}
+
+File::operator bool() const
+{
+  return _p && _p->f;
+}
+
+const char *File::name() const
+{
+  return _p ? _p->name.c_str() : NULL;
+}
+
+File Dir::openFile(const char *mode)
+{
+  if (!_fs || _index < 0 || _index >= (int)_names.size())
+    return File();
+  return FS(_fs).open(_names[_index], mode);
+}
+
+String Dir::fileName()
+{
+  return _index >= 0 && _index < (int)_names.size() ? _names[_index] : String();
+}
+
+size_t Dir::fileSize()
+{
+  return _index >= 0 && _index < (int)_sizes.size() ? _sizes[_index] : 0;
+}
+
+bool Dir::next()
+{
+  return ++_index < (int)_names.size();
+}
+
+FS::FS(const char *root) : _impl(std::make_shared<FSImpl>(root))
+{
+}
+
+bool FS::begin()
+{
+  String base = _impl->base();
+  if (mkdir(base.c_str(), 0755) < 0 && errno != EEXIST)
+    return false;
+  _impl->recount();
+  _impl->mounted = true;
+  return true;
+}
+
+void FS::end()
+{
+  _impl->mounted = false;
+}
+
+bool FS::format()
+{
+  String base = _impl->base();
+  host::removeTree(base.c_str());
+  return begin();
+}
+
+bool FS::info(FSInfo &info)
+{
+  if (!_impl->mounted)
+    return false;
+  info.totalBytes = capacity;
+  info.usedBytes = min(_impl->used, capacity);
+  info.blockSize = SPIFFS_BLOCK_SIZE;
+  info.pageSize = SPIFFS_PAGE_SIZE;
+  info.maxOpenFiles = SPIFFS_MAX_OPEN_FILES;
+  info.maxPathLength = SPIFFS_OBJ_NAME_LEN;
+  return true;
+}
+
+File FS::open(const char *path, const char *mode)
+{
+  String file = _impl->hostPath(path);
+  if (!_impl->mounted || !file.length() || !mode)
+    return File();
+
+  bool writing = mode[0] == 'w' || mode[0] == 'a';
+  bool exists = FSImpl::isFile(file);
+  if (!writing && !exists)
+    return File();
+  if (writing && !FSImpl::makeParents(file))
+    return File();
+
+  size_t size = exists ? FSImpl::fileSize(file) : 0;
+  String flags = String(mode[0]) + (strchr(mode, '+') ? "+" : "") + "b";
+  FILE *f = fopen(file.c_str(), flags.c_str());
+  if (!f)
+    return File();
+  // other handles see the writes at once, as on SPIFFS
+  if (writing)
+    setvbuf(f, NULL, _IONBF, 0);
+  if (mode[0] == 'w')
+  {
+    _impl->used -= min(_impl->used, pages(size));
+    size = 0;
+  }
+  if (mode[0] == 'a')
+    fseek(f, 0, SEEK_END);
+
+  String name = path[0] == '/' ? String(path) : "/" + String(path);
+  return File(std::make_shared<FileImpl>(_impl, f, name.c_str(), size));
+}
+
+bool FS::exists(const char *path)
+{
+  String file = _impl->hostPath(path);
+  return _impl->mounted && file.length() && FSImpl::isFile(file);
+}
+
+Dir FS::openDir(const char *path)
+{
+  Dir dir;
+  if (!_impl->mounted)
+    return dir;
+  std::vector<String> names;
+  std::vector<size_t> sizes;
+  _impl->walk(_impl->base(), "", names, sizes);
+
+  std::vector<size_t> order;
+  String prefix = path ? path : "";
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    if (names[i].startsWith(prefix))
+      order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return names[a] < names[b]; });
+
+  dir._fs = _impl;
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    dir._names.push_back(names[order[i]]);
+    dir._sizes.push_back(sizes[order[i]]);
+  }
+  return dir;
+}
+
+bool FS::remove(const char *path)
+{
+  String file = _impl->hostPath(path);
+  if (!_impl->mounted || !file.length() || !FSImpl::isFile(file))
+    return false;
+  size_t size = FSImpl::fileSize(file);
+  if (unlink(file.c_str()) < 0)
+    return false;
+  _impl->used -= min(_impl->used, pages(size));
+  return true;
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo)
+{
+  String from = _impl->hostPath(pathFrom);
+  String to = _impl->hostPath(pathTo);
+  if (!_impl->mounted || !from.length() || !to.length())
+    return false;
+  if (!FSImpl::isFile(from) || FSImpl::isFile(to))
+    return false;
+  if (renameFailures > 0 && renamesBeforeFailure-- <= 0)
+  {
+    --renameFailures;
+    return false;
+  }
+  if (!FSImpl::makeParents(to))
+    return false;
+  return ::rename(from.c_str(), to.c_str()) == 0;
+}
+
+} // namespace fs
+
+namespace host
+{
+
+void setFsRoot(const char *dir)
+{
+  defaultRoot = dir ? dir : "";
+}
+
+const char *fsRoot()
+{
+  return defaultRoot.c_str();
+}
+
+void setFsCapacity(size_t bytes)
+{
+  capacity = bytes;
+}
+
+void failRenames(int count, int after)
+{
+  renameFailures = count;
+  renamesBeforeFailure = after;
+}
+
+uint32_t fsPageWrites()
+{
+  return pageWrites;
+}
+
+size_t fsBytesRead()
+{
+  return bytesRead;
+}
+
+} // namespace host
@@ -0,0 +1,124 @@
+#ifndef FS_H
+#define FS_H
+
+#include "Arduino.h"
+
+#include <memory>
+#include <vector>
+
+namespace fs
+{
+
+class FileImpl;
+class FSImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+typedef std::shared_ptr<FSImpl> FSImplPtr;
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream
+{
+  public:
+    File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+
+    size_t write(uint8_t) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t *buf, size_t size);
+    size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+    using Stream::readBytes;
+
+    bool seek(uint32_t pos, SeekMode mode);
+    bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char *name() const;
+
+  protected:
+    FileImplPtr _p;
+};
+
+class Dir
+{
+  public:
+    Dir() : _index(-1) {}
+
+    File openFile(const char *mode);
+    String fileName();
+    size_t fileSize();
+    bool next();
+
+  protected:
+    friend class FS;
+    FSImplPtr _fs;
+    std::vector<String> _names;
+    std::vector<size_t> _sizes;
+    int _index;
+};
+
+struct FSInfo
+{
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+// SPIFFS over a directory of the host. Names are flat like on SPIFFS, a
+// "/" in a name becomes a subdirectory on disk. Renames do not replace
+// an existing file and names are limited to SPIFFS_OBJ_NAME_LEN - 1.
+class FS
+{
+  public:
+    // root NULL follows host::setFsRoot()
+    FS(const char *root = NULL);
+
+    bool begin();
+    void end();
+    bool format();
+    bool info(FSInfo &info);
+
+    File open(const char *path, const char *mode);
+    File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    Dir openDir(const char *path);
+    Dir openDir(const String &path) { return openDir(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *pathFrom, const char *pathTo);
+    bool rename(const String &pathFrom, const String &pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+
+  protected:
+    friend class Dir;
+    FS(const FSImplPtr &impl) : _impl(impl) {}
+    FSImplPtr _impl;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::Dir;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::FSInfo;
+
+extern fs::FS SPIFFS;
+
+#endif
@@ -0,0 +1,171 @@
+#include "Arduino.h"
+#include "HostSim.h"
+
+#include <atomic>
+#include <new>
+
+#include <errno.h>
+
+#include <malloc.h>
+
+// Counts live allocations so ESP.getFreeHeap() moves like it does on the
+// device. glibc lets a program replace malloc, the originals stay
+// reachable as __libc_*.
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+// RAM left to the sketch after the SDK and core took theirs
+#ifndef HOST_HEAP_SIZE
+#define HOST_HEAP_SIZE 81920
+#endif
+
+static std::atomic<long> heapBytes(0);
+static std::atomic<long> heapMost(0);
+
+static void *tracked(void *ptr)
+{
+  if (ptr)
+  {
+    long used = heapBytes += malloc_usable_size(ptr);
+    long most = heapMost.load();
+    while (used > most && !heapMost.compare_exchange_weak(most, used))
+      ;
+  }
+  return ptr;
+}
+
+static void untrack(void *ptr)
+{
+  if (ptr)
+    heapBytes -= malloc_usable_size(ptr);
+}
+
+extern "C" void *malloc(size_t size)
+{
+  return tracked(__libc_malloc(size));
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  return tracked(__libc_calloc(count, size));
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  untrack(ptr);
+  void *next = __libc_realloc(ptr, size);
+  // a failed realloc leaves the old block as it was
+  if (!next && size && ptr)
+    return tracked(ptr);
+  return tracked(next);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size)
+{
+  return tracked(__libc_memalign(alignment, size));
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+  return tracked(__libc_memalign(alignment, size));
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+  void *p = tracked(__libc_memalign(alignment, size));
+  if (!p)
+    return ENOMEM;
+  *ptr = p;
+  return 0;
+}
+
+extern "C" void free(void *ptr)
+{
+  untrack(ptr);
+  __libc_free(ptr);
+}
+
+void *operator new(size_t size)
+{
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+  long used = heapBytes.load();
+  return used < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - used : 0;
+}
+
+uint16_t EspClass::getMaxFreeBlockSize()
+{
+  uint32_t heap = getFreeHeap();
+  return heap > 0xFFFF ? 0xFFFF : heap;
+}
+
+uint8_t EspClass::getHeapFragmentation()
+{
+  return 0;
+}
+
+namespace host
+{
+
+size_t heapUsed()
+{
+  long used = heapBytes.load();
+  return used > 0 ? used : 0;
+}
+
+size_t heapPeak()
+{
+  return heapMost.load();
+}
+
+void resetHeapPeak()
+{
+  heapMost = heapBytes.load();
+}
+
+} // namespace host
@@ -0,0 +1,95 @@
+#ifndef HostSim_h
+#define HostSim_h
+
+#include "Arduino.h"
+
+#include <vector>
+
+// Controls of the host backend for tests and benchmarks. Everything has a
+// default that behaves like a board that just booted, so a sketch runs
+// without touching any of it.
+namespace host
+{
+
+// millis() and micros() follow the wall clock unless the clock is manual,
+// then they only move through advance() and delay()
+void useManualClock(bool manual);
+void advance(unsigned long ms);
+
+// WiFiServer binds port + offset on 127.0.0.1; PORT_EPHEMERAL lets the
+// kernel choose, boundPort() tells which one it did
+const int PORT_EPHEMERAL = -1;
+void setPortOffset(int offset);
+uint16_t boundPort(uint16_t port);
+
+// bytes a connection takes before availableForWrite() reports it full,
+// the send buffer of lwIP is 2 * 1460
+void setSendWindow(size_t bytes);
+size_t sendWindow();
+
+// SPIFFS is a directory, created on begin(); the size is what info()
+// reports and writes are refused beyond it
+void setFsRoot(const char *dir);
+const char *fsRoot();
+void setFsCapacity(size_t bytes);
+// after the next after renames, count renames fail without touching
+// the files
+void failRenames(int count, int after = 0);
+// pages programmed by File::write(), a write that starts or ends inside
+// a page programs that page again
+uint32_t fsPageWrites();
+// bytes read through File::read()
+size_t fsBytesRead();
+
+// EEPROM.commit() writes the whole image to this file
+void setEepromFile(const char *path);
+uint32_t eepromCommits();
+
+// flash sectors, erased to 0xFF, writes only clear bits
+uint32_t flashErases(uint32_t sector);
+uint32_t flashWrites();
+// after count more good writes, the next failures writes (-1 for all)
+// stop half way and fail, like a reset during a write; a count of -1
+// makes them whole again
+void failFlashWritesAfter(int count, int failures = -1);
+void resetFlash();
+
+// an access point WiFi.begin() can join and a scan reports
+struct Network
+{
+    String ssid;
+    String pass;
+    int32_t rssi;
+    int32_t channel;
+    uint8_t bssid[6];
+    bool encrypted;
+    // ms from WiFi.begin() to WL_CONNECTED
+    unsigned long connectDelay;
+};
+
+void addNetwork(const Network &network);
+void clearNetworks();
+// ms an asynchronous scan takes
+void setScanTime(unsigned long ms);
+// the station loses its access point, it can be joined again
+void dropWifi();
+uint32_t wifiBegins();
+// the station's DHCP client runs, WiFi.config() has not set a static address
+bool wifiDhcp();
+
+// bytes allocated with new or malloc and not freed yet
+size_t heapUsed();
+size_t heapPeak();
+void resetHeapPeak();
+
+// ESP.restart() was called, the host keeps running
+bool restarted();
+void clearRestarted();
+
+// an empty directory below $TMPDIR, removed with removeTree()
+String makeTempDir(const char *prefix);
+void removeTree(const char *dir);
+
+} // namespace host
+
+#endif
@@ -0,0 +1,61 @@
+#include "Arduino.h"
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+    : _address(first | second << 8 | third << 16 | (uint32_t)fourth << 24)
+{
+}
+
+IPAddress::IPAddress(const uint8_t *address)
+    : _address(address[0] | address[1] << 8 | address[2] << 16 | (uint32_t)address[3] << 24)
+{
+}
+
+bool IPAddress::fromString(const char *address)
+{
+  uint32_t acc = 0;
+  uint8_t dots = 0;
+  bool digit = false;
+  uint32_t result = 0;
+
+  for (; *address; ++address)
+  {
+    char c = *address;
+    if (c >= '0' && c <= '9')
+    {
+      acc = acc * 10 + (c - '0');
+      if (acc > 255)
+        return false;
+      digit = true;
+    }
+    else if (c == '.')
+    {
+      if (dots == 3 || !digit)
+        return false;
+      result |= acc << (8 * dots++);
+      acc = 0;
+      digit = false;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  if (dots != 3 || !digit)
+    return false;
+  _address = result | acc << 24;
+  return true;
+}
+
+String IPAddress::toString() const
+{
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(buf);
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+  return p.print(toString());
+}
@@ -0,0 +1,37 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+
+#include "Printable.h"
+#include "WString.h"
+
+// IPv4 address, stored in network order like the lwIP one
+class IPAddress : public Printable
+{
+  public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+    IPAddress(uint32_t address) : _address(address) {}
+    IPAddress(const uint8_t *address);
+
+    bool fromString(const char *address);
+    bool fromString(const String &address) { return fromString(address.c_str()); }
+
+    operator uint32_t() const { return _address; }
+    bool operator==(const IPAddress &addr) const { return _address == addr._address; }
+    bool operator==(uint32_t addr) const { return _address == addr; }
+    bool operator!=(const IPAddress &addr) const { return _address != addr._address; }
+    uint8_t operator[](int index) const { return (_address >> (8 * index)) & 0xFF; }
+
+    bool isSet() const { return _address != 0; }
+    String toString() const;
+    size_t printTo(Print &p) const override;
+
+  protected:
+    uint32_t _address;
+};
+
+extern const IPAddress INADDR_NONE;
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __ESP8266_MD5_BUILDER__
+#define __ESP8266_MD5_BUILDER__
+
+#include "Arduino.h"
+
+class MD5Builder
+{
+  public:
+    void begin(void);
+    void add(const uint8_t *data, const uint16_t len);
+    void add(const char *data) { add((const uint8_t *)data, strlen(data)); }
+    void add(const String &data) { add((const uint8_t *)data.c_str(), data.length()); }
+    void addHexString(const char *data);
+    void addHexString(const String &data) { addHexString(data.c_str()); }
+    bool addStream(Stream &stream, const size_t maxLen);
+    void calculate(void);
+    void getBytes(uint8_t *output);
+    void getChars(char *output);
+    String toString(void);
+
+  protected:
+    void transform(const uint8_t *block);
+
+    uint32_t _state[4];
+    uint64_t _length;
+    uint8_t _block[64];
+    uint8_t _digest[16];
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+static std::string formatUnsigned(unsigned long value, unsigned char base)
+{
+  if (base < 2 || base > 36)
+    base = 10;
+  char buf[8 * sizeof(long) + 1];
+  char *p = buf + sizeof(buf) - 1;
+  *p = 0;
+  do
+  {
+    int digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value);
+  return p;
+}
+
+static std::string formatSigned(long value, unsigned char base)
+{
+  // the core prints negative numbers in other bases as two's complement
+  if (base == 10 && value < 0)
+    return "-" + formatUnsigned(0UL - (unsigned long)value, 10);
+  return formatUnsigned((unsigned long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned char decimalPlaces)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  return buf;
+}
+
+String::String(unsigned char value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : _s(base == 10 ? formatSigned(value, base) : formatUnsigned((unsigned int)value, base)) {}
+String::String(unsigned int value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : _s(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(float value, unsigned char decimalPlaces) : _s(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : _s(formatFloat(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String &s) const
+{
+  return _s.size() == s._s.size() && strcasecmp(_s.c_str(), s._s.c_str()) == 0;
+}
+
+bool String::equalsConstantTime(const String &s) const
+{
+  if (_s.size() != s._s.size())
+    return false;
+  unsigned char diff = 0;
+  for (size_t i = 0; i < _s.size(); ++i)
+    diff |= _s[i] ^ s._s[i];
+  return diff == 0;
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const
+{
+  if (offset > _s.size() || prefix._s.size() > _s.size() - offset)
+    return false;
+  return _s.compare(offset, prefix._s.size(), prefix._s) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+  if (suffix._s.size() > _s.size())
+    return false;
+  return _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+}
+
+char &String::operator[](unsigned int index)
+{
+  static char dummy;
+  if (index >= _s.size())
+  {
+    dummy = 0;
+    return dummy;
+  }
+  return _s[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
+{
+  if (!bufsize || !buf)
+    return;
+  if (index >= _s.size())
+  {
+    buf[0] = 0;
+    return;
+  }
+  size_t n = _s.size() - index;
+  if (n > bufsize - 1)
+    n = bufsize - 1;
+  memcpy(buf, _s.data() + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+  size_t pos = _s.find(ch, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const
+{
+  if (fromIndex >= _s.size())
+    return -1;
+  size_t pos = _s.find(str._s, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const
+{
+  return lastIndexOf(ch, _s.size() - 1);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const
+{
+  if (fromIndex >= _s.size())
+    return -1;
+  size_t pos = _s.rfind(ch, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String &str) const
+{
+  return lastIndexOf(str, _s.size() - str._s.size());
+}
+
+int String::lastIndexOf(const String &str, unsigned int fromIndex) const
+{
+  if (str._s.size() == 0 || str._s.size() > _s.size() || fromIndex >= _s.size())
+    return -1;
+  size_t pos = _s.rfind(str._s, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int left, unsigned int right) const
+{
+  if (left > right)
+  {
+    unsigned int temp = right;
+    right = left;
+    left = temp;
+  }
+  if (left >= _s.size())
+    return String();
+  if (right > _s.size())
+    right = _s.size();
+  return String(_s.substr(left, right - left));
+}
+
+void String::replace(char find, char replace)
+{
+  for (size_t i = 0; i < _s.size(); ++i)
+  {
+    if (_s[i] == find)
+      _s[i] = replace;
+  }
+}
+
+void String::replace(const String &find, const String &replace)
+{
+  if (find._s.empty())
+    return;
+  size_t pos = 0;
+  while ((pos = _s.find(find._s, pos)) != std::string::npos)
+  {
+    _s.replace(pos, find._s.size(), replace._s);
+    pos += replace._s.size();
+  }
+}
+
+void String::remove(unsigned int index)
+{
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+  if (index >= _s.size())
+    return;
+  _s.erase(index, count);
+}
+
+void String::toLowerCase()
+{
+  for (size_t i = 0; i < _s.size(); ++i)
+    _s[i] = tolower((unsigned char)_s[i]);
+}
+
+void String::toUpperCase()
+{
+  for (size_t i = 0; i < _s.size(); ++i)
+    _s[i] = toupper((unsigned char)_s[i]);
+}
+
+void String::trim()
+{
+  size_t begin = 0;
+  while (begin < _s.size() && isspace((unsigned char)_s[begin]))
+    ++begin;
+  size_t end = _s.size();
+  while (end > begin && isspace((unsigned char)_s[end - 1]))
+    --end;
+  _s = _s.substr(begin, end - begin);
+}
+
+long String::toInt() const
+{
+  return atol(_s.c_str());
+}
+
+float String::toFloat() const
+{
+  return atof(_s.c_str());
+}
+
+double String::toDouble() const
+{
+  return atof(_s.c_str());
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, char rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, int rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, unsigned int rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, long rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, unsigned long rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
+
+String operator+(const String &lhs, const __FlashStringHelper *rhs)
+{
+  String s(lhs);
+  s.concat(rhs);
+  return s;
+}
@@ -0,0 +1,329 @@
+#include "WiFiClient.h"
+#include "HostSim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+unsigned long hostWallMillis();
+
+// how long stop() waits for the peer to take what was written (ms)
+#define CLIENT_STOP_FLUSH_WAIT 300
+
+// One connection, shared by every WiFiClient copy. The descriptor is
+// non-blocking; writes wait on poll() up to the client timeout.
+class HostSocket
+{
+  public:
+    HostSocket(int fd) : fd(fd), noDelay(false)
+    {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      // a peer gone away must not kill the process on the next write
+      int one = 1;
+      setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    }
+
+    ~HostSocket() { close(); }
+
+    void close()
+    {
+      if (fd >= 0)
+        ::close(fd);
+      fd = -1;
+    }
+
+    // bytes written and not acknowledged yet
+    size_t unacked()
+    {
+      int queued = 0;
+      if (fd < 0 || ioctl(fd, SIOCOUTQ, &queued) < 0)
+        return 0;
+      return queued;
+    }
+
+    int fd;
+    bool noDelay;
+};
+
+WiFiClient::WiFiClient()
+{
+  _timeout = 5000;
+}
+
+WiFiClient::WiFiClient(int fd) : _socket(std::make_shared<HostSocket>(fd))
+{
+  _timeout = 5000;
+}
+
+WiFiClient::WiFiClient(const WiFiClient &other) : Stream(other), _socket(other._socket)
+{
+}
+
+WiFiClient &WiFiClient::operator=(const WiFiClient &other)
+{
+  _socket = other._socket;
+  _timeout = other._timeout;
+  return *this;
+}
+
+WiFiClient::~WiFiClient()
+{
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  _socket.reset();
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *res = NULL;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &res) != 0 || !res)
+    return 0;
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int ok = fd >= 0 && ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+  freeaddrinfo(res);
+  if (!ok)
+  {
+    if (fd >= 0)
+      ::close(fd);
+    return 0;
+  }
+  _socket = std::make_shared<HostSocket>(fd);
+  return 1;
+}
+
+uint8_t WiFiClient::status()
+{
+  // the lwIP states that matter here, CLOSED and ESTABLISHED
+  return connected() ? 4 : 0;
+}
+
+uint8_t WiFiClient::connected()
+{
+  if (!_socket || _socket->fd < 0)
+    return 0;
+  char c;
+  ssize_t n = recv(_socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0)
+    return 1;
+  if (n == 0)
+    return 0;
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+WiFiClient::operator bool()
+{
+  return connected();
+}
+
+size_t WiFiClient::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size)
+{
+  if (!_socket || _socket->fd < 0)
+    return 0;
+
+  size_t sent = 0;
+  unsigned long start = hostWallMillis();
+  while (sent < size)
+  {
+    ssize_t n = send(_socket->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n > 0)
+    {
+      sent += n;
+      continue;
+    }
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      break;
+    unsigned long waited = hostWallMillis() - start;
+    if (waited >= _timeout)
+      break;
+    struct pollfd pfd = {_socket->fd, POLLOUT, 0};
+    poll(&pfd, 1, _timeout - waited);
+  }
+  return sent;
+}
+
+size_t WiFiClient::write(Stream &stream)
+{
+  uint8_t buf[1460];
+  size_t total = 0;
+  while (stream.available() > 0)
+  {
+    size_t n = stream.readBytes(buf, min((size_t)stream.available(), sizeof(buf)));
+    if (n == 0)
+      break;
+    size_t written = write(buf, n);
+    total += written;
+    if (written != n)
+      break;
+  }
+  return total;
+}
+
+int WiFiClient::available()
+{
+  if (!_socket || _socket->fd < 0)
+    return 0;
+  int n = 0;
+  if (ioctl(_socket->fd, FIONREAD, &n) < 0)
+    return 0;
+  return n;
+}
+
+int WiFiClient::read()
+{
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size)
+{
+  if (!_socket || _socket->fd < 0 || size == 0)
+    return 0;
+  ssize_t n = recv(_socket->fd, buf, size, MSG_DONTWAIT);
+  return n > 0 ? (int)n : 0;
+}
+
+int WiFiClient::peek()
+{
+  uint8_t b;
+  return peekBytes(&b, 1) == 1 ? b : -1;
+}
+
+size_t WiFiClient::peekBytes(uint8_t *buffer, size_t length)
+{
+  if (!_socket || _socket->fd < 0)
+    return 0;
+  ssize_t n = recv(_socket->fd, buffer, length, MSG_PEEK | MSG_DONTWAIT);
+  return n > 0 ? n : 0;
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  unsigned long start = hostWallMillis();
+  while (count < length && _socket && _socket->fd >= 0)
+  {
+    int n = read((uint8_t *)buffer + count, length - count);
+    if (n > 0)
+    {
+      count += n;
+      continue;
+    }
+    unsigned long waited = hostWallMillis() - start;
+    if (waited >= _timeout || !connected())
+      break;
+    struct pollfd pfd = {_socket->fd, POLLIN, 0};
+    poll(&pfd, 1, _timeout - waited);
+  }
+  return count;
+}
+
+int WiFiClient::availableForWrite()
+{
+  if (!connected())
+    return 0;
+  size_t window = host::sendWindow();
+  size_t queued = _socket->unacked();
+  return queued < window ? window - queued : 0;
+}
+
+void WiFiClient::flush()
+{
+  if (!_socket)
+    return;
+  unsigned long start = hostWallMillis();
+  while (_socket->fd >= 0 && _socket->unacked() > 0 && hostWallMillis() - start < _timeout)
+    usleep(1000);
+}
+
+void WiFiClient::stop()
+{
+  if (!_socket)
+    return;
+  unsigned long timeout = _timeout;
+  _timeout = CLIENT_STOP_FLUSH_WAIT;
+  flush();
+  _timeout = timeout;
+  _socket->close();
+  _socket.reset();
+}
+
+static IPAddress socketAddress(int fd, bool peer, uint16_t *port)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  int r = peer ? getpeername(fd, (struct sockaddr *)&addr, &len) : getsockname(fd, (struct sockaddr *)&addr, &len);
+  if (r < 0 || addr.sin_family != AF_INET)
+  {
+    *port = 0;
+    return IPAddress();
+  }
+  *port = ntohs(addr.sin_port);
+  return IPAddress(addr.sin_addr.s_addr);
+}
+
+IPAddress WiFiClient::remoteIP()
+{
+  uint16_t port;
+  return _socket && _socket->fd >= 0 ? socketAddress(_socket->fd, true, &port) : IPAddress();
+}
+
+uint16_t WiFiClient::remotePort()
+{
+  uint16_t port = 0;
+  if (_socket && _socket->fd >= 0)
+    socketAddress(_socket->fd, true, &port);
+  return port;
+}
+
+IPAddress WiFiClient::localIP()
+{
+  uint16_t port;
+  return _socket && _socket->fd >= 0 ? socketAddress(_socket->fd, false, &port) : IPAddress();
+}
+
+uint16_t WiFiClient::localPort()
+{
+  uint16_t port = 0;
+  if (_socket && _socket->fd >= 0)
+    socketAddress(_socket->fd, false, &port);
+  return port;
+}
+
+void WiFiClient::setNoDelay(bool nodelay)
+{
+  if (!_socket || _socket->fd < 0)
+    return;
+  int flag = nodelay;
+  setsockopt(_socket->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  _socket->noDelay = nodelay;
+}
+
+bool WiFiClient::getNoDelay()
+{
+  return _socket && _socket->noDelay;
+}
@@ -0,0 +1,67 @@
+#ifndef wificlient_h
+#define wificlient_h
+
+#include "Arduino.h"
+
+#include <memory>
+
+class HostSocket;
+
+// A TCP connection on a POSIX socket. Copies share the connection, which
+// is closed when the last copy goes away, like the refcounted
+// ClientContext of the core.
+class WiFiClient : public Stream
+{
+  public:
+    WiFiClient();
+    WiFiClient(const WiFiClient &other);
+    WiFiClient &operator=(const WiFiClient &other);
+    virtual ~WiFiClient();
+
+    // blocking connect, for test clients
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char *host, uint16_t port);
+    int connect(const String &host, uint16_t port) { return connect(host.c_str(), port); }
+
+    uint8_t status();
+    uint8_t connected();
+    operator bool();
+    bool operator==(const WiFiClient &other) const { return _socket == other._socket; }
+    bool operator!=(const WiFiClient &other) const { return _socket != other._socket; }
+
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    size_t write_P(PGM_P buf, size_t size) { return write((const uint8_t *)buf, size); }
+    size_t write(Stream &stream);
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size);
+    int peek() override;
+    size_t peekBytes(uint8_t *buffer, size_t length);
+    size_t readBytes(char *buffer, size_t length) override;
+    using Stream::readBytes;
+    int availableForWrite() override;
+
+    // waits, up to the timeout, until everything written is acknowledged
+    void flush() override;
+    // flushes and closes the connection for every copy
+    void stop();
+
+    IPAddress remoteIP();
+    uint16_t remotePort();
+    IPAddress localIP();
+    uint16_t localPort();
+
+    void setNoDelay(bool nodelay);
+    bool getNoDelay();
+
+  protected:
+    friend class WiFiServer;
+    WiFiClient(int fd);
+
+    std::shared_ptr<HostSocket> _socket;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "WiFiServer.h"
+#include "HostSim.h"
+
+#include <map>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int portOffset = 0;
+static std::map<uint16_t, uint16_t> boundPorts;
+static size_t window = 2 * 1460;
+
+WiFiServer::WiFiServer(uint16_t port) : _port(port), _fd(-1), _noDelay(false)
+{
+}
+
+WiFiServer::WiFiServer(IPAddress addr, uint16_t port) : _port(port), _fd(-1), _noDelay(false)
+{
+  (void)addr;
+}
+
+WiFiServer::~WiFiServer()
+{
+  close();
+}
+
+void WiFiServer::begin(uint16_t port)
+{
+  _port = port;
+  begin();
+}
+
+void WiFiServer::begin()
+{
+  if (_fd >= 0)
+    return;
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (fd < 0)
+    return;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(portOffset == host::PORT_EPHEMERAL ? 0 : _port + portOffset);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+  {
+    fprintf(stderr, "WiFiServer: cannot listen for port %u: %s\n", _port, strerror(errno));
+    ::close(fd);
+    return;
+  }
+
+  socklen_t len = sizeof(addr);
+  getsockname(fd, (struct sockaddr *)&addr, &len);
+  boundPorts[_port] = ntohs(addr.sin_port);
+  _fd = fd;
+}
+
+void WiFiServer::acceptPending()
+{
+  if (_fd < 0)
+    return;
+  for (;;)
+  {
+    int fd = accept4(_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+      break;
+    _pending.push_back(fd);
+  }
+}
+
+bool WiFiServer::hasClient()
+{
+  acceptPending();
+  return !_pending.empty();
+}
+
+WiFiClient WiFiServer::available(uint8_t *status)
+{
+  (void)status;
+  acceptPending();
+  if (_pending.empty())
+    return WiFiClient();
+  WiFiClient client(_pending.front());
+  _pending.pop_front();
+  if (_noDelay)
+    client.setNoDelay(true);
+  return client;
+}
+
+uint8_t WiFiServer::status()
+{
+  // LISTEN or CLOSED
+  return _fd >= 0 ? 1 : 0;
+}
+
+void WiFiServer::close()
+{
+  while (!_pending.empty())
+  {
+    ::close(_pending.front());
+    _pending.pop_front();
+  }
+  if (_fd >= 0)
+    ::close(_fd);
+  _fd = -1;
+}
+
+namespace host
+{
+
+void setPortOffset(int offset)
+{
+  portOffset = offset;
+}
+
+uint16_t boundPort(uint16_t port)
+{
+  std::map<uint16_t, uint16_t>::const_iterator it = boundPorts.find(port);
+  return it == boundPorts.end() ? 0 : it->second;
+}
+
+void setSendWindow(size_t bytes)
+{
+  window = bytes;
+}
+
+size_t sendWindow()
+{
+  return window;
+}
+
+} // namespace host
@@ -0,0 +1,38 @@
+#ifndef wifiserver_h
+#define wifiserver_h
+
+#include "WiFiClient.h"
+
+#include <deque>
+
+// Listens on 127.0.0.1, at the port given plus the offset set through
+// host::setPortOffset().
+class WiFiServer
+{
+  public:
+    WiFiServer(uint16_t port);
+    WiFiServer(IPAddress addr, uint16_t port);
+    virtual ~WiFiServer();
+
+    void begin();
+    void begin(uint16_t port);
+    bool hasClient();
+    // an accepted connection, or a false client when there is none
+    WiFiClient available(uint8_t *status = NULL);
+    void setNoDelay(bool nodelay) { _noDelay = nodelay; }
+    bool getNoDelay() { return _noDelay; }
+    uint8_t status();
+    void close();
+    void stop() { close(); }
+
+  protected:
+    // takes the connections the kernel has ready
+    void acceptPending();
+
+    uint16_t _port;
+    int _fd;
+    bool _noDelay;
+    std::deque<int> _pending;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "bearssl/bearssl_hash.h"
+#include "bearssl/bearssl_hmac.h"
+
+#include <string.h>
+
+// SHA-256 (FIPS 180-4) and HMAC (RFC 2104) for the BearSSL shim
+
+static const uint32_t sha256K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotr(uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+static void compress(uint32_t *val, const unsigned char *block)
+{
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i)
+    w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 | (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+  for (int i = 16; i < 64; ++i)
+  {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = val[0], b = val[1], c = val[2], d = val[3];
+  uint32_t e = val[4], f = val[5], g = val[6], h = val[7];
+  for (int i = 0; i < 64; ++i)
+  {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  val[0] += a;
+  val[1] += b;
+  val[2] += c;
+  val[3] += d;
+  val[4] += e;
+  val[5] += f;
+  val[6] += g;
+  val[7] += h;
+}
+
+static void vtableInit(const br_hash_class **ctx)
+{
+  br_sha256_init((br_sha256_context *)ctx);
+}
+
+static void vtableUpdate(const br_hash_class **ctx, const void *data, size_t len)
+{
+  br_sha256_update((br_sha256_context *)ctx, data, len);
+}
+
+static void vtableOut(const br_hash_class *const *ctx, void *dst)
+{
+  br_sha256_out((const br_sha256_context *)ctx, dst);
+}
+
+extern "C" const br_hash_class br_sha256_vtable = {
+  sizeof(br_sha256_context), br_sha256_ID, vtableInit, vtableUpdate, vtableOut};
+
+void br_sha256_init(br_sha256_context *ctx)
+{
+  static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  ctx->vtable = &br_sha256_vtable;
+  memcpy(ctx->val, init, sizeof(ctx->val));
+  ctx->count = 0;
+}
+
+void br_sha256_update(br_sha256_context *ctx, const void *data, size_t len)
+{
+  const unsigned char *p = (const unsigned char *)data;
+  while (len > 0)
+  {
+    size_t fill = ctx->count & 63;
+    size_t n = 64 - fill < len ? 64 - fill : len;
+    memcpy(ctx->buf + fill, p, n);
+    ctx->count += n;
+    p += n;
+    len -= n;
+    if ((ctx->count & 63) == 0)
+      compress(ctx->val, ctx->buf);
+  }
+}
+
+void br_sha256_out(const br_sha256_context *ctx, void *out)
+{
+  // padding goes into a copy, the context can be extended afterwards
+  br_sha256_context copy = *ctx;
+  uint64_t bits = ctx->count * 8;
+  unsigned char pad = 0x80;
+  br_sha256_update(&copy, &pad, 1);
+  pad = 0;
+  while ((copy.count & 63) != 56)
+    br_sha256_update(&copy, &pad, 1);
+  unsigned char length[8];
+  for (int i = 0; i < 8; ++i)
+    length[i] = bits >> (56 - i * 8);
+  br_sha256_update(&copy, length, 8);
+
+  unsigned char *digest = (unsigned char *)out;
+  for (int i = 0; i < 8; ++i)
+  {
+    digest[i * 4] = copy.val[i] >> 24;
+    digest[i * 4 + 1] = copy.val[i] >> 16;
+    digest[i * 4 + 2] = copy.val[i] >> 8;
+    digest[i * 4 + 3] = copy.val[i];
+  }
+}
+
+void br_hmac_key_init(br_hmac_key_context *kc, const br_hash_class *digest_vtable, const void *key, size_t key_len)
+{
+  unsigned char block[64];
+  memset(block, 0, sizeof(block));
+  if (key_len > sizeof(block))
+  {
+    br_sha256_context sha;
+    br_sha256_init(&sha);
+    br_sha256_update(&sha, key, key_len);
+    br_sha256_out(&sha, block);
+  }
+  else
+  {
+    memcpy(block, key, key_len);
+  }
+
+  kc->dig_vtable = digest_vtable;
+  unsigned char pad[64];
+  for (int i = 0; i < 64; ++i)
+    pad[i] = block[i] ^ 0x36;
+  br_sha256_init(&kc->ksi);
+  br_sha256_update(&kc->ksi, pad, sizeof(pad));
+  for (int i = 0; i < 64; ++i)
+    pad[i] = block[i] ^ 0x5c;
+  br_sha256_init(&kc->kso);
+  br_sha256_update(&kc->kso, pad, sizeof(pad));
+  memset(block, 0, sizeof(block));
+}
+
+void br_hmac_init(br_hmac_context *ctx, const br_hmac_key_context *kc, size_t out_len)
+{
+  ctx->dig = kc->ksi;
+  ctx->kso = kc->kso;
+  ctx->out_len = out_len == 0 || out_len > br_sha256_SIZE ? br_sha256_SIZE : out_len;
+}
+
+void br_hmac_update(br_hmac_context *ctx, const void *data, size_t len)
+{
+  br_sha256_update(&ctx->dig, data, len);
+}
+
+size_t br_hmac_out(const br_hmac_context *ctx, void *out)
+{
+  unsigned char inner[br_sha256_SIZE];
+  br_sha256_out(&ctx->dig, inner);
+  br_sha256_context outer = ctx->kso;
+  br_sha256_update(&outer, inner, sizeof(inner));
+  unsigned char mac[br_sha256_SIZE];
+  br_sha256_out(&outer, mac);
+  memcpy(out, mac, ctx->out_len);
+  return ctx->out_len;
+}
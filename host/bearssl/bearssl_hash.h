@@ -0,0 +1,45 @@
+#ifndef BR_BEARSSL_HASH_H__
+#define BR_BEARSSL_HASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The SHA-256 part of BearSSL's hash API, as shipped with the ESP8266
+// core, enough for the library to build on the host.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct br_hash_class_ br_hash_class;
+struct br_hash_class_
+{
+    size_t context_size;
+    uint32_t desc;
+    void (*init)(const br_hash_class **ctx);
+    void (*update)(const br_hash_class **ctx, const void *data, size_t len);
+    void (*out)(const br_hash_class *const *ctx, void *dst);
+};
+
+#define br_sha256_ID    4
+#define br_sha256_SIZE  32
+
+typedef struct
+{
+    const br_hash_class *vtable;
+    unsigned char buf[64];
+    uint64_t count;
+    uint32_t val[8];
+} br_sha256_context;
+
+extern const br_hash_class br_sha256_vtable;
+
+void br_sha256_init(br_sha256_context *ctx);
+void br_sha256_update(br_sha256_context *ctx, const void *data, size_t len);
+void br_sha256_out(const br_sha256_context *ctx, void *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
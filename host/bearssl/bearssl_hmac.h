@@ -0,0 +1,43 @@
+#ifndef BR_BEARSSL_HMAC_H__
+#define BR_BEARSSL_HMAC_H__
+
+#include "bearssl_hash.h"
+
+// BearSSL's HMAC API over the host SHA-256, see bearssl_hash.h.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    const br_hash_class *dig_vtable;
+    // the hash after the inner and the outer key block
+    br_sha256_context ksi;
+    br_sha256_context kso;
+} br_hmac_key_context;
+
+void br_hmac_key_init(br_hmac_key_context *kc, const br_hash_class *digest_vtable, const void *key, size_t key_len);
+
+typedef struct
+{
+    br_sha256_context dig;
+    br_sha256_context kso;
+    size_t out_len;
+} br_hmac_context;
+
+// out_len 0 for the whole digest
+void br_hmac_init(br_hmac_context *ctx, const br_hmac_key_context *kc, size_t out_len);
+void br_hmac_update(br_hmac_context *ctx, const void *data, size_t len);
+size_t br_hmac_out(const br_hmac_context *ctx, void *out);
+
+static inline size_t br_hmac_size(br_hmac_context *ctx)
+{
+    return ctx->out_len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
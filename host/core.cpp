@@ -0,0 +1,152 @@
+#include "Arduino.h"
+#include "HostSim.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool manualClock = false;
+static uint64_t manualMicros = 0;
+static bool restartRequested = false;
+
+static uint64_t wallMicros()
+{
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+// timeouts of blocking calls, they must end even on a manual clock
+unsigned long hostWallMillis()
+{
+  return wallMicros() / 1000;
+}
+
+unsigned long millis(void)
+{
+  return micros() / 1000;
+}
+
+unsigned long micros(void)
+{
+  return manualClock ? manualMicros : wallMicros();
+}
+
+void delay(unsigned long ms)
+{
+  if (manualClock)
+    manualMicros += ms * 1000ULL;
+  else if (ms)
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  if (manualClock)
+    manualMicros += us;
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void)
+{
+}
+
+static std::mt19937 &generator()
+{
+  static std::mt19937 gen(std::random_device{}());
+  return gen;
+}
+
+long random(long howbig)
+{
+  if (howbig <= 0)
+    return 0;
+  return generator()() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+  if (howsmall >= howbig)
+    return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+  generator().seed(seed);
+}
+
+uint32_t hostRandom32()
+{
+  return generator()();
+}
+
+void EspClass::restart()
+{
+  restartRequested = true;
+}
+
+namespace host
+{
+
+void useManualClock(bool manual)
+{
+  if (manual && !manualClock)
+    manualMicros = wallMicros();
+  manualClock = manual;
+}
+
+void advance(unsigned long ms)
+{
+  manualMicros += ms * 1000ULL;
+}
+
+bool restarted()
+{
+  return restartRequested;
+}
+
+void clearRestarted()
+{
+  restartRequested = false;
+}
+
+String makeTempDir(const char *prefix)
+{
+  const char *tmp = getenv("TMPDIR");
+  String path = String(tmp && *tmp ? tmp : "/tmp") + "/" + prefix + "XXXXXX";
+  if (!mkdtemp(path.begin()))
+    return String();
+  return path;
+}
+
+void removeTree(const char *dir)
+{
+  DIR *d = opendir(dir);
+  if (!d)
+  {
+    unlink(dir);
+    return;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(d)) != NULL)
+  {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    String path = String(dir) + "/" + entry->d_name;
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+      removeTree(path.c_str());
+    else
+      unlink(path.c_str());
+  }
+  closedir(d);
+  rmdir(dir);
+}
+
+} // namespace host
@@ -0,0 +1,20 @@
+#include "AssetBundle.h"
+
+bool AssetBundle::find(const char *path, AssetEntry *entry)
+{
+  size_t lo = 0;
+  size_t hi = _count;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    memcpy_P(entry, &_entries[mid], sizeof(*entry));
+    int cmp = strcmp_P(path, entry->path);
+    if (cmp == 0)
+      return true;
+    if (cmp > 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return false;
+}
@@ -0,0 +1,55 @@
+#ifndef AssetBundle_h
+#define AssetBundle_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// data is gzip compressed
+#define ASSET_GZIP 1
+
+// One file of a bundle made by tools/pack_assets.py. The entries and
+// every string and byte they point to are in PROGMEM. A compressed entry
+// packed with --plain also has the uncompressed bytes, for clients that
+// do not take gzip and for ?download, otherwise plain is NULL.
+struct AssetEntry
+{
+    const char *path;
+    const char *type;
+    const char *etag;
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t flags;
+    const char *plainETag;
+    const uint8_t *plain;
+    uint32_t plainSize;
+};
+
+// Table of AssetEntry sorted by path, as the generated header declares it.
+class AssetBundle
+{
+  public:
+    AssetBundle() : _entries(NULL), _count(0)
+    {
+    }
+
+    void begin(const AssetEntry *entries, size_t count)
+    {
+        _entries = entries;
+        _count = count;
+    }
+
+    bool enabled() { return _count > 0; }
+    size_t count() { return _count; }
+
+    // binary search, entry gets a RAM copy of the table row
+    bool find(const char *path, AssetEntry *entry);
+
+  protected:
+    const AssetEntry *_entries;
+    size_t _count;
+};
+
+#endif
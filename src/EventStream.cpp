@@ -0,0 +1,164 @@
+#include "EventStream.h"
+
+#include <new>
+
+static const char eventHeaders[] = "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: text/event-stream\r\n"
+                                   "Cache-Control: no-cache\r\n"
+                                   "Connection: keep-alive\r\n"
+                                   "\r\n";
+
+void EventStream::reset(EventClient &subscriber)
+{
+  subscriber.head = 0;
+  subscriber.used = 0;
+  subscriber.missed = 0;
+}
+
+// closes the connection and gives the queue back
+void EventStream::release(EventClient &subscriber)
+{
+  subscriber.client.stop();
+  subscriber.client = WiFiClient();
+  subscriber.active = false;
+  delete[] subscriber.queue;
+  subscriber.queue = NULL;
+  reset(subscriber);
+}
+
+EventStream::~EventStream()
+{
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+  {
+    if (_clients[i].active)
+      release(_clients[i]);
+  }
+}
+
+int EventStream::clients()
+{
+  int count = 0;
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+  {
+    if (_clients[i].active)
+      ++count;
+  }
+  return count;
+}
+
+bool EventStream::subscribe(WiFiClient &client)
+{
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+  {
+    EventClient &subscriber = _clients[i];
+    if (subscriber.active)
+      continue;
+
+    subscriber.queue = new (std::nothrow) char[EVENT_QUEUE_SIZE];
+    if (!subscriber.queue)
+      return false;
+    subscriber.active = true;
+    subscriber.client = client;
+    subscriber.client.setNoDelay(true);
+    reset(subscriber);
+    queue(subscriber, eventHeaders, sizeof(eventHeaders) - 1);
+    client = WiFiClient();
+    return true;
+  }
+  return false;
+}
+
+void EventStream::queue(EventClient &subscriber, const char *data, size_t len)
+{
+  if (len > EVENT_QUEUE_SIZE - subscriber.used)
+  {
+    ++_dropped;
+    ++subscriber.missed;
+    return;
+  }
+
+  size_t tail = (subscriber.head + subscriber.used) % EVENT_QUEUE_SIZE;
+  size_t first = min(len, EVENT_QUEUE_SIZE - tail);
+  memcpy(subscriber.queue + tail, data, first);
+  memcpy(subscriber.queue, data + first, len - first);
+  subscriber.used += len;
+  subscriber.missed = 0;
+}
+
+void EventStream::broadcast(const char *event, const String &data)
+{
+  if (clients() == 0)
+    return;
+
+  size_t eventLen = event ? strlen(event) : 0;
+  String message;
+  message.reserve(eventLen + data.length() + 16);
+  if (eventLen > 0)
+  {
+    message += "event: ";
+    message += event;
+    message += '\n';
+  }
+  int start = 0;
+  do
+  {
+    int end = data.indexOf('\n', start);
+    if (end < 0)
+      end = data.length();
+    message += "data: ";
+    message += data.substring(start, end);
+    message += '\n';
+    start = end + 1;
+  } while (start <= (int)data.length());
+  message += '\n';
+
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+  {
+    if (_clients[i].active)
+      queue(_clients[i], message.c_str(), message.length());
+  }
+}
+
+void EventStream::send(EventClient &subscriber)
+{
+  while (subscriber.used > 0)
+  {
+    size_t room = subscriber.client.availableForWrite();
+    size_t len = min(min(subscriber.used, EVENT_QUEUE_SIZE - subscriber.head), room);
+    if (len == 0)
+      return;
+    size_t n = subscriber.client.write((const uint8_t *)subscriber.queue + subscriber.head, len);
+    subscriber.head = (subscriber.head + n) % EVENT_QUEUE_SIZE;
+    subscriber.used -= n;
+    if (n < len)
+      return;
+  }
+  subscriber.head = 0;
+}
+
+void EventStream::handle()
+{
+  if (millis() - _lastPing > EVENT_PING_INTERVAL)
+  {
+    _lastPing = millis();
+    static const char ping[] = ":\n\n";
+    for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+    {
+      if (_clients[i].active)
+        queue(_clients[i], ping, sizeof(ping) - 1);
+    }
+  }
+
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+  {
+    EventClient &subscriber = _clients[i];
+    if (!subscriber.active)
+      continue;
+    if (!subscriber.client.connected() || subscriber.missed >= EVENT_MAX_MISSED)
+    {
+      release(subscriber);
+      continue;
+    }
+    send(subscriber);
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef EventStream_h
+#define EventStream_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WiFi.h>
+
+// an unused slot takes a few bytes, the queue is allocated on subscribe
+#ifndef EVENT_MAX_CLIENTS
+#define EVENT_MAX_CLIENTS     8
+#endif
+// output queued per subscriber, messages that do not fit are dropped
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE      512
+#endif
+// messages in a row a subscriber may miss before it is disconnected
+#define EVENT_MAX_MISSED      8
+// ms between keep-alive comments, they also find dead connections
+#define EVENT_PING_INTERVAL   15000
+
+struct EventClient
+{
+    WiFiClient client;
+    // EVENT_QUEUE_SIZE bytes while active, NULL otherwise
+    char *queue;
+    size_t head;
+    size_t used;
+    uint8_t missed;
+    bool active;
+};
+
+// Server-Sent Events to up to EVENT_MAX_CLIENTS subscribers.
+//
+// broadcast() formats a message once and copies it into the queue of
+// every subscriber; handle() sends the queues as far as each socket
+// accepts. A message is queued whole or not at all, so a slow client
+// misses messages instead of holding up the others, and is dropped after
+// EVENT_MAX_MISSED in a row. Browsers reconnect an EventSource by
+// themselves.
+class EventStream
+{
+  public:
+    EventStream() : _lastPing(0), _dropped(0)
+    {
+        for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+        {
+            reset(_clients[i]);
+            _clients[i].queue = NULL;
+            _clients[i].active = false;
+        }
+    }
+    ~EventStream();
+
+    // takes over the connection of a request, the response headers are
+    // queued first; false when every slot is taken or there is no memory
+    // for the queue, the client is left alone then
+    bool subscribe(WiFiClient &client);
+    // data may span lines, each goes out as its own "data:" field
+    void broadcast(const char *event, const String &data);
+    void handle();
+
+    int clients();
+    // messages not queued for a subscriber that was behind
+    uint32_t dropped() { return _dropped; }
+
+  protected:
+    void reset(EventClient &subscriber);
+    void release(EventClient &subscriber);
+    void queue(EventClient &subscriber, const char *data, size_t len);
+    void send(EventClient &subscriber);
+
+    EventClient _clients[EVENT_MAX_CLIENTS];
+    unsigned long _lastPing;
+    uint32_t _dropped;
+};
+
+#endif
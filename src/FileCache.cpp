@@ -0,0 +1,143 @@
+#include "FileCache.h"
+
+void FileCache::setCapacity(size_t capacity, size_t maxFileSize)
+{
+  _capacity = capacity;
+  _maxFileSize = min(maxFileSize, capacity);
+  while (_size > _capacity)
+    evict(leastRecent());
+}
+
+size_t FileCache::leastRecent()
+{
+  size_t oldest = 0;
+  for (size_t i = 1; i < _files.size(); ++i)
+  {
+    if (_files[i].used < _files[oldest].used)
+      oldest = i;
+  }
+  return oldest;
+}
+
+int FileCache::indexOf(const String &path)
+{
+  for (size_t i = 0; i < _files.size(); ++i)
+  {
+    if (_files[i].path == path)
+      return i;
+  }
+  return -1;
+}
+
+bool FileCache::contains(const String &path)
+{
+  return indexOf(path) >= 0;
+}
+
+CachedFile *FileCache::find(const String &path)
+{
+  if (!enabled())
+    return NULL;
+  int i = indexOf(path);
+  if (i < 0)
+  {
+    ++_misses;
+    return NULL;
+  }
+  ++_hits;
+  _files[i].used = ++_tick;
+  return &_files[i];
+}
+
+CachedFile *FileCache::add(const String &path, File &file)
+{
+  size_t size = file.size();
+  if (!enabled() || size > _maxFileSize)
+    return NULL;
+  remove(path);
+
+  while (_size + size > _capacity && !_files.empty())
+    evict(leastRecent());
+
+  CachedFile entry;
+  entry.data = (uint8_t *)malloc(size ? size : 1);
+  if (!entry.data)
+    return NULL;
+  file.seek(0, SeekSet);
+  if (file.read(entry.data, size) != size)
+  {
+    // the caller streams the file instead, from its start
+    free(entry.data);
+    file.seek(0, SeekSet);
+    return NULL;
+  }
+  entry.path = path;
+  entry.size = size;
+  entry.used = ++_tick;
+  _files.push_back(entry);
+  _size += size;
+  return &_files.back();
+}
+
+void FileCache::evict(size_t index)
+{
+  _size -= _files[index].size;
+  free(_files[index].data);
+  _files.erase(_files.begin() + index);
+}
+
+void FileCache::remove(const String &path)
+{
+  int i = indexOf(path);
+  if (i >= 0)
+    evict(i);
+  i = missingIndexOf(path);
+  if (i >= 0)
+    _missing.erase(_missing.begin() + i);
+}
+
+void FileCache::clear()
+{
+  while (!_files.empty())
+    evict(_files.size() - 1);
+  _missing.clear();
+}
+
+int FileCache::missingIndexOf(const String &path)
+{
+  for (size_t i = 0; i < _missing.size(); ++i)
+  {
+    if (_missing[i].path == path)
+      return i;
+  }
+  return -1;
+}
+
+bool FileCache::isMissing(const String &path)
+{
+  int i = missingIndexOf(path);
+  if (i < 0)
+    return false;
+  // written since by something else than the helper, look again
+  if (millis() - _missing[i].since >= FILE_CACHE_MISSING_TTL)
+  {
+    _missing.erase(_missing.begin() + i);
+    return false;
+  }
+  return true;
+}
+
+void FileCache::setMissing(const String &path)
+{
+  if (!enabled())
+    return;
+  int i = missingIndexOf(path);
+  if (i >= 0)
+    _missing.erase(_missing.begin() + i);
+  else if (_missing.size() >= FILE_CACHE_MISSING)
+    _missing.erase(_missing.begin());
+  MissingPath entry;
+  entry.path = path;
+  entry.since = millis();
+  _missing.push_back(entry);
+}
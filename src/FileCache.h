@@ -0,0 +1,87 @@
+#ifndef FileCache_h
+#define FileCache_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <FS.h>
+#include <vector>
+
+// files larger than this are never cached, by default
+#define FILE_CACHE_MAX_FILE 4096
+// paths remembered as missing, e.g. the .gz variants that do not exist
+#define FILE_CACHE_MISSING  8
+// ms a path is remembered as missing, it may be written behind the cache
+#define FILE_CACHE_MISSING_TTL 5000
+
+struct CachedFile
+{
+    String path;
+    uint8_t *data;
+    size_t size;
+    uint32_t used;
+};
+
+struct MissingPath
+{
+    String path;
+    unsigned long since;
+};
+
+// Contents of small files kept in RAM, least recently used evicted first.
+// Capacity counts file contents only. Disabled while the capacity is 0.
+// A few paths known not to exist are kept too, so probing for a missing
+// variant of a cached file does not reach the filesystem either, until
+// FILE_CACHE_MISSING_TTL has passed or the path is removed.
+class FileCache
+{
+  public:
+    FileCache() : _capacity(0), _maxFileSize(FILE_CACHE_MAX_FILE), _size(0), _tick(0), _hits(0), _misses(0)
+    {
+    }
+
+    ~FileCache()
+    {
+        clear();
+    }
+
+    void setCapacity(size_t capacity, size_t maxFileSize = FILE_CACHE_MAX_FILE);
+    bool enabled() { return _capacity > 0; }
+
+    bool contains(const String &path);
+    // counts a hit or a miss
+    CachedFile *find(const String &path);
+    // reads the whole file, NULL if it is too large or memory is short
+    CachedFile *add(const String &path, File &file);
+    // forgets the file and that it was missing, after it was written or removed
+    void remove(const String &path);
+    void clear();
+
+    bool isMissing(const String &path);
+    void setMissing(const String &path);
+
+    uint32_t hits() { return _hits; }
+    uint32_t misses() { return _misses; }
+    size_t size() { return _size; }
+    size_t count() { return _files.size(); }
+
+  protected:
+    int indexOf(const String &path);
+    int missingIndexOf(const String &path);
+    size_t leastRecent();
+    void evict(size_t index);
+
+    std::vector<CachedFile> _files;
+    std::vector<MissingPath> _missing;
+    size_t _capacity;
+    size_t _maxFileSize;
+    size_t _size;
+    uint32_t _tick;
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "JsonReader.h"
+
+void JsonReader::skipSpace()
+{
+  while (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n')
+    ++_p;
+}
+
+bool JsonReader::fail(const char *error)
+{
+  if (!_error)
+    _error = error;
+  _done = true;
+  return false;
+}
+
+static int hexDigit(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+bool JsonReader::readString(String &str)
+{
+  str = "";
+  if (*_p != '"')
+    return fail("string expected");
+  ++_p;
+
+  while (*_p != '"')
+  {
+    char c = *_p++;
+    if (c == 0 || (uint8_t)c < 0x20)
+      return fail("unterminated string");
+    if (c != '\\')
+    {
+      str += c;
+      continue;
+    }
+
+    c = *_p++;
+    switch (c)
+    {
+    case '"':
+    case '\\':
+    case '/':
+      str += c;
+      break;
+    case 'b':
+      str += '\b';
+      break;
+    case 'f':
+      str += '\f';
+      break;
+    case 'n':
+      str += '\n';
+      break;
+    case 'r':
+      str += '\r';
+      break;
+    case 't':
+      str += '\t';
+      break;
+    case 'u':
+    {
+      uint16_t code = 0;
+      for (int i = 0; i < 4; ++i)
+      {
+        int digit = hexDigit(*_p++);
+        if (digit < 0)
+          return fail("bad escape");
+        code = code << 4 | digit;
+      }
+      // as UTF-8, surrogate pairs are not joined
+      if (code < 0x80)
+      {
+        str += (char)code;
+      }
+      else if (code < 0x800)
+      {
+        str += (char)(0xc0 | code >> 6);
+        str += (char)(0x80 | (code & 0x3f));
+      }
+      else
+      {
+        str += (char)(0xe0 | code >> 12);
+        str += (char)(0x80 | ((code >> 6) & 0x3f));
+        str += (char)(0x80 | (code & 0x3f));
+      }
+      break;
+    }
+    default:
+      return fail("bad escape");
+    }
+  }
+  ++_p;
+  return true;
+}
+
+bool JsonReader::readLiteral(String &value, JsonType &type)
+{
+  const char *start = _p;
+  if (*_p == '-' || (*_p >= '0' && *_p <= '9'))
+  {
+    type = JSON_NUMBER;
+    while (*_p == '-' || *_p == '+' || *_p == '.' || *_p == 'e' || *_p == 'E' || (*_p >= '0' && *_p <= '9'))
+      ++_p;
+  }
+  else
+  {
+    while (*_p >= 'a' && *_p <= 'z')
+      ++_p;
+    size_t len = _p - start;
+    if (len == 4 && strncmp(start, "true", 4) == 0)
+      type = JSON_BOOL;
+    else if (len == 5 && strncmp(start, "false", 5) == 0)
+      type = JSON_BOOL;
+    else if (len == 4 && strncmp(start, "null", 4) == 0)
+      type = JSON_NULL;
+    else if (*start == '{' || *start == '[')
+      return fail("nested values are not supported");
+    else
+      return fail("value expected");
+  }
+
+  value = "";
+  value.reserve(_p - start);
+  for (const char *p = start; p < _p; ++p)
+    value += *p;
+  return true;
+}
+
+bool JsonReader::next(String &key, String &value, JsonType &type)
+{
+  if (_done)
+    return false;
+
+  skipSpace();
+  if (!_started)
+  {
+    if (*_p != '{')
+      return fail("object expected");
+    ++_p;
+    _started = true;
+    skipSpace();
+    if (*_p == '}')
+    {
+      ++_p;
+      _done = true;
+    }
+  }
+  else if (*_p == ',')
+  {
+    ++_p;
+    skipSpace();
+  }
+  else if (*_p == '}')
+  {
+    ++_p;
+    _done = true;
+  }
+  else
+  {
+    return fail("',' or '}' expected");
+  }
+
+  if (_done)
+  {
+    skipSpace();
+    if (*_p)
+      return fail("trailing characters");
+    return false;
+  }
+
+  if (!readString(key))
+    return false;
+  skipSpace();
+  if (*_p != ':')
+    return fail("':' expected");
+  ++_p;
+  skipSpace();
+
+  if (*_p == '"')
+  {
+    type = JSON_STRING;
+    return readString(value);
+  }
+  return readLiteral(value, type);
+}
@@ -0,0 +1,53 @@
+#ifndef JsonReader_h
+#define JsonReader_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+enum JsonType
+{
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_BOOL,
+    JSON_NULL
+};
+
+// Reads the members of one flat JSON object, such as a request body.
+// Numbers and booleans are returned as their text. Nested objects and
+// arrays are not supported and fail the document.
+//
+//   JsonReader json(body.c_str());
+//   String key, value;
+//   JsonType type;
+//   while (json.next(key, value, type))
+//     ...
+//   if (json.failed())
+//     ... json.error()
+class JsonReader
+{
+  public:
+    JsonReader(const char *text) : _p(text), _started(false), _done(false), _error(NULL)
+    {
+    }
+
+    // false at the end of the object or on an error
+    bool next(String &key, String &value, JsonType &type);
+    bool failed() { return _error != NULL; }
+    const char *error() { return _error; }
+
+  protected:
+    void skipSpace();
+    bool fail(const char *error);
+    bool readString(String &str);
+    bool readLiteral(String &value, JsonType &type);
+
+    const char *_p;
+    bool _started;
+    bool _done;
+    const char *_error;
+};
+
+#endif
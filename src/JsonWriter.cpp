@@ -0,0 +1,160 @@
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+void JsonWriter::begin(int code, const char *contentType)
+{
+  _len = 0;
+  _comma = false;
+  _started = true;
+  METRICS_RESPONSE(code);
+  _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _server.send(code, contentType, "");
+}
+
+void JsonWriter::end()
+{
+  if (!_started)
+    return;
+  flush();
+  // empty chunk terminates a chunked response
+  _server.sendContent_P("", 0);
+  _started = false;
+}
+
+void JsonWriter::separate()
+{
+  if (_comma)
+    write(',');
+  _comma = false;
+}
+
+void JsonWriter::beginObject()
+{
+  separate();
+  write('{');
+}
+
+void JsonWriter::endObject()
+{
+  write('}');
+  _comma = true;
+}
+
+void JsonWriter::beginArray()
+{
+  separate();
+  write('[');
+}
+
+void JsonWriter::endArray()
+{
+  write(']');
+  _comma = true;
+}
+
+void JsonWriter::key(const char *name)
+{
+  separate();
+  writeString(name, strlen(name));
+  write(':');
+}
+
+void JsonWriter::writeString(const char *str, size_t len)
+{
+  write('"');
+  for (size_t i = 0; i < len; ++i)
+  {
+    char ch = str[i];
+    if (ch == '"' || ch == '\\')
+    {
+      write('\\');
+      write(ch);
+    }
+    else if ((uint8_t)ch < 0x20)
+    {
+      printf("\\u%04x", ch);
+    }
+    else
+    {
+      write(ch);
+    }
+  }
+  write('"');
+}
+
+void JsonWriter::value(const char *str)
+{
+  separate();
+  writeString(str, strlen(str));
+  _comma = true;
+}
+
+void JsonWriter::value(const String &str)
+{
+  separate();
+  writeString(str.c_str(), str.length());
+  _comma = true;
+}
+
+void JsonWriter::value(bool b)
+{
+  separate();
+  print(b ? "true" : "false");
+  _comma = true;
+}
+
+void JsonWriter::value(int n)
+{
+  value((long)n);
+}
+
+void JsonWriter::value(unsigned int n)
+{
+  value((unsigned long)n);
+}
+
+void JsonWriter::value(long n)
+{
+  separate();
+  print(n);
+  _comma = true;
+}
+
+void JsonWriter::value(unsigned long n)
+{
+  separate();
+  print(n);
+  _comma = true;
+}
+
+void JsonWriter::nullValue()
+{
+  separate();
+  print("null");
+  _comma = true;
+}
+
+size_t JsonWriter::write(uint8_t ch)
+{
+  if (_len == sizeof(_buf))
+    flush();
+  _buf[_len++] = ch;
+  return 1;
+}
+
+size_t JsonWriter::write(const uint8_t *buf, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+    write(buf[i]);
+  return size;
+}
+
+void JsonWriter::flush()
+{
+  // an empty chunk would end the response early
+  if (_len == 0)
+    return;
+  _server.sendContent_P(_buf, _len);
+  METRICS_SENT(_len);
+  _len = 0;
+}
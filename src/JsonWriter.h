@@ -0,0 +1,81 @@
+#ifndef JsonWriter_h
+#define JsonWriter_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WebServer.h>
+
+#ifndef JSON_WRITER_BUFFER_SIZE
+#define JSON_WRITER_BUFFER_SIZE 256
+#endif
+
+// Streams a JSON document to the current client of the web server.
+// The response is sent with an unknown length, so HTTP/1.1 clients get
+// it with "Transfer-Encoding: chunked", one chunk per filled buffer.
+// Memory use stays at JSON_WRITER_BUFFER_SIZE whatever the output size.
+//
+//   JsonWriter json(server);
+//   json.begin();
+//   json.beginObject();
+//   json.member("result", 1);
+//   json.endObject();
+//   json.end();
+class JsonWriter : public Print
+{
+  public:
+    JsonWriter(ESP8266WebServer &server) : _server(server), _len(0), _comma(false), _started(false)
+    {
+    }
+
+    ~JsonWriter()
+    {
+        end();
+    }
+
+    void begin(int code = 200, const char *contentType = "application/json");
+    void end();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char *name);
+
+    void value(const char *str);
+    void value(const String &str);
+    void value(bool b);
+    void value(int n);
+    void value(unsigned int n);
+    void value(long n);
+    void value(unsigned long n);
+    void nullValue();
+
+    template <typename T>
+    void member(const char *name, const T &v)
+    {
+        key(name);
+        value(v);
+    }
+
+    // raw output, bypasses separators and escaping
+    size_t write(uint8_t ch) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    void flush() override;
+
+  protected:
+    void separate();
+    void writeString(const char *str, size_t len);
+
+    ESP8266WebServer &_server;
+    char _buf[JSON_WRITER_BUFFER_SIZE];
+    size_t _len;
+    bool _comma;
+    bool _started;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "Logger.h"
+
+Logger ServerLog;
+
+static const char levelChars[] = "-EWID";
+
+Logger::Logger() : _out(NULL), _level(SERVERHELPER_LOG_LEVEL), _head(0), _used(0), _dropped(0), _droppedReported(0)
+{
+}
+
+void Logger::log(uint8_t level, const char *tag, PGM_P format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  vlog(level, tag, format, args);
+  va_end(args);
+}
+
+void Logger::vlog(uint8_t level, const char *tag, PGM_P format, va_list args)
+{
+  if (level > _level || level == LOG_LEVEL_NONE)
+    return;
+
+  char line[LOG_LINE_MAX];
+  int len;
+
+  // "<millis> [<level>][<tag>] <message>\r\n", truncated to fit the line
+  len = snprintf_P(line, sizeof(line), PSTR("%lu [%c][%s] "), millis(), levelChars[level], tag);
+  if (len < (int)sizeof(line) - 2)
+  {
+    int n = vsnprintf_P(line + len, sizeof(line) - 2 - len, format, args);
+    if (n > 0)
+      len += min(n, (int)sizeof(line) - 3 - len);
+  }
+  else
+  {
+    len = sizeof(line) - 3;
+  }
+  line[len++] = '\r';
+  line[len++] = '\n';
+
+  push(line, len);
+}
+
+void Logger::push(const char *data, size_t len)
+{
+  // make room by evicting the oldest lines, a new message is worth more
+  while (LOG_BUFFER_SIZE - _used < len)
+  {
+    char ch;
+    do
+    {
+      ch = _buf[_head];
+      _head = (_head + 1) % LOG_BUFFER_SIZE;
+      --_used;
+    } while (ch != '\n' && _used > 0);
+    ++_dropped;
+  }
+
+  size_t tail = (_head + _used) % LOG_BUFFER_SIZE;
+  size_t first = min(len, LOG_BUFFER_SIZE - tail);
+  memcpy(_buf + tail, data, first);
+  memcpy(_buf, data + first, len - first);
+  _used += len;
+}
+
+bool Logger::drain()
+{
+  if (_used == 0 || !_out)
+    return false;
+
+  // never more than the output takes without blocking, e.g. the UART FIFO
+  size_t room = _out->availableForWrite();
+
+  // evicted lines preceded the ones still queued, report them first
+  if (_dropped != _droppedReported)
+  {
+    char line[48];
+    int len = snprintf_P(line, sizeof(line), PSTR("%lu [W][log] %u messages dropped\r\n"), millis(),
+                         (unsigned)(_dropped - _droppedReported));
+    if (room < (size_t)len || _out->write((const uint8_t *)line, len) != (size_t)len)
+      return false;
+    _droppedReported = _dropped;
+    room -= len;
+  }
+
+  // one contiguous piece of the ring per call
+  size_t len = min(min(_used, room), min((size_t)LOG_DRAIN_SLICE, LOG_BUFFER_SIZE - _head));
+  if (len == 0)
+    return false;
+  size_t n = _out->write((const uint8_t *)_buf + _head, len);
+  _head = (_head + n) % LOG_BUFFER_SIZE;
+  _used -= n;
+  return _used > 0 && n > 0;
+}
+
+void Logger::flush()
+{
+  // the UART empties by itself, a telnet queue only in loop()
+  unsigned long start = millis();
+  while (_used > 0 && _out && millis() - start < LOG_FLUSH_TIMEOUT)
+  {
+    drain();
+    yield();
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef Logger_h
+#define Logger_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+
+// messages above this level are compiled out, their arguments are
+// still type checked but never evaluated
+#ifndef SERVERHELPER_LOG_LEVEL
+#define SERVERHELPER_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// RAM ring holding formatted messages until loop() drains them
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE   1024
+#endif
+// longest message, longer ones are truncated
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX      128
+#endif
+// bytes written to the output per drain() call
+#ifndef LOG_DRAIN_SLICE
+#define LOG_DRAIN_SLICE   64
+#endif
+// ms flush() waits for the output to take the rest
+#ifndef LOG_FLUSH_TIMEOUT
+#define LOG_FLUSH_TIMEOUT 500
+#endif
+
+// Leveled log with printf-style formats kept in flash.
+//
+// Messages are formatted into a ring buffer and written to the output
+// by drain(), a slice at a time, so a slow or absent reader never holds
+// up the caller. When the ring is full the oldest messages are dropped
+// and counted; the count is reported ahead of the remaining messages.
+//
+//   LOG_INFO("wifi", "connected in %lu ms", ms);
+class Logger
+{
+  public:
+    Logger();
+
+    void setOutput(Print *out) { _out = out; }
+    void setLevel(uint8_t level) { _level = level; }
+    uint8_t level() { return _level; }
+
+    void log(uint8_t level, const char *tag, PGM_P format, ...) __attribute__((format(printf, 4, 5)));
+    void vlog(uint8_t level, const char *tag, PGM_P format, va_list args);
+
+    // writes up to LOG_DRAIN_SLICE bytes, no more than the output's
+    // availableForWrite(); false once the ring is empty or the output full
+    bool drain();
+    // writes everything, blocking up to LOG_FLUSH_TIMEOUT, e.g. before a restart
+    void flush();
+
+    uint32_t dropped() { return _dropped; }
+    size_t pending() { return _used; }
+
+  protected:
+    void push(const char *data, size_t len);
+
+    Print *_out;
+    uint8_t _level;
+    char _buf[LOG_BUFFER_SIZE];
+    size_t _head;
+    size_t _used;
+    uint32_t _dropped;
+    uint32_t _droppedReported;
+};
+
+extern Logger ServerLog;
+
+#if SERVERHELPER_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(tag, format, ...) ServerLog.log(LOG_LEVEL_ERROR, tag, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(tag, format, ...) do { if (0) ServerLog.log(LOG_LEVEL_ERROR, tag, PSTR(format), ##__VA_ARGS__); } while (0)
+#endif
+
+#if SERVERHELPER_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(tag, format, ...) ServerLog.log(LOG_LEVEL_WARN, tag, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARN(tag, format, ...) do { if (0) ServerLog.log(LOG_LEVEL_WARN, tag, PSTR(format), ##__VA_ARGS__); } while (0)
+#endif
+
+#if SERVERHELPER_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(tag, format, ...) ServerLog.log(LOG_LEVEL_INFO, tag, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(tag, format, ...) do { if (0) ServerLog.log(LOG_LEVEL_INFO, tag, PSTR(format), ##__VA_ARGS__); } while (0)
+#endif
+
+#if SERVERHELPER_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(tag, format, ...) ServerLog.log(LOG_LEVEL_DEBUG, tag, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, format, ...) do { if (0) ServerLog.log(LOG_LEVEL_DEBUG, tag, PSTR(format), ##__VA_ARGS__); } while (0)
+#endif
+
+#endif
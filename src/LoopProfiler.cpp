@@ -0,0 +1,156 @@
+#include "LoopProfiler.h"
+#include "SettingsStore.h"
+
+static_assert(sizeof(ProfilerRecord) % 4 == 0, "ProfilerRecord must be whole RTC blocks");
+static_assert(PROFILER_RTC_OFFSET * 4 + sizeof(ProfilerRecord) <= 512, "ProfilerRecord does not fit in RTC user memory");
+
+static const char *const stageNames[] = {"wifi", "ota", "telnet", "scan", "http", "log", "idle"};
+
+static uint32_t recordCrc(const ProfilerRecord &record)
+{
+  // magic and stage change outside of save()
+  const uint8_t *start = (const uint8_t *)&record.stalls;
+  return SettingsStore::crc32(0, start, (const uint8_t *)&record.crc - start);
+}
+
+LoopProfiler::LoopProfiler()
+    : _previousValid(false), _stage(PROFILE_IDLE), _start(0), _stallMicros(PROFILER_STALL_THRESHOLD * 1000UL), _cyclesPerMicro(80)
+{
+  memset(_stats, 0, sizeof(_stats));
+  memset(&_record, 0, sizeof(_record));
+  memset(&_previous, 0, sizeof(_previous));
+}
+
+const char *LoopProfiler::stageName(uint32_t stage)
+{
+  return stage <= PROFILE_IDLE ? stageNames[stage] : "?";
+}
+
+void LoopProfiler::restore()
+{
+  _cyclesPerMicro = ESP.getCpuFreqMHz();
+
+  ESP.rtcUserMemoryRead(PROFILER_RTC_OFFSET, (uint32_t *)&_previous, sizeof(_previous));
+  _previousValid = _previous.magic == PROFILER_MAGIC && _previous.crc == recordCrc(_previous);
+
+  memset(&_record, 0, sizeof(_record));
+  _record.magic = PROFILER_MAGIC;
+  _record.stage = PROFILE_IDLE;
+  _record.stallStage = PROFILE_IDLE;
+  save();
+}
+
+void LoopProfiler::writeStage(uint32_t stage)
+{
+  _record.stage = stage;
+  ESP.rtcUserMemoryWrite(PROFILER_RTC_OFFSET + offsetof(ProfilerRecord, stage) / 4, &_record.stage, sizeof(_record.stage));
+}
+
+void LoopProfiler::save()
+{
+  _record.crc = recordCrc(_record);
+  ESP.rtcUserMemoryWrite(PROFILER_RTC_OFFSET, (uint32_t *)&_record, sizeof(_record));
+}
+
+void LoopProfiler::begin(ProfileStage stage)
+{
+  _stage = stage;
+  writeStage(stage);
+  _start = ESP.getCycleCount();
+}
+
+bool LoopProfiler::end()
+{
+  uint32_t cycles = ESP.getCycleCount() - _start;
+  if (_stage >= PROFILE_STAGES)
+    return false;
+
+  StageStats &stats = _stats[_stage];
+  ++stats.count;
+  stats.cycles += cycles;
+  if (cycles > stats.maxCycles)
+    stats.maxCycles = cycles;
+
+  uint32_t us = toMicros(cycles);
+  int bucket = 0;
+  while (bucket < PROFILER_BUCKETS - 1 && us >= (1UL << bucket))
+    ++bucket;
+  ++stats.buckets[bucket];
+
+  bool dirty = false;
+  if (us > _record.maxMicros[_stage])
+  {
+    _record.maxMicros[_stage] = us;
+    dirty = true;
+  }
+
+  bool stalled = us >= _stallMicros;
+  if (stalled)
+  {
+    ++_record.stalls;
+    _record.stallStage = _stage;
+    _record.stallMicros = us;
+    _record.stallAt = millis();
+    _record.stallUri[0] = 0;
+    dirty = true;
+  }
+
+  // a new maximum is rare once the loop has settled
+  if (dirty)
+    save();
+  return stalled;
+}
+
+void LoopProfiler::stallContext(const char *uri)
+{
+  strncpy(_record.stallUri, uri, sizeof(_record.stallUri) - 1);
+  _record.stallUri[sizeof(_record.stallUri) - 1] = 0;
+  save();
+}
+
+void LoopProfiler::idle()
+{
+  _stage = PROFILE_IDLE;
+  writeStage(PROFILE_IDLE);
+}
+
+uint32_t LoopProfiler::averageMicros(ProfileStage stage)
+{
+  const StageStats &stats = _stats[stage];
+  if (!stats.count)
+    return 0;
+  return toMicros(stats.cycles / stats.count);
+}
+
+uint32_t LoopProfiler::percentileMicros(ProfileStage stage, uint8_t percent)
+{
+  const StageStats &stats = _stats[stage];
+  uint64_t target = ((uint64_t)stats.count * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < PROFILER_BUCKETS; ++bucket)
+  {
+    seen += stats.buckets[bucket];
+    if (seen >= target && seen > 0)
+      return bucket < PROFILER_BUCKETS - 1 ? (1UL << bucket) : toMicros(stats.maxCycles);
+  }
+  return 0;
+}
+
+void LoopProfiler::printTo(Print &out)
+{
+  out.println("stage   count      avg      p50      p99      max (us)");
+  for (int i = 0; i < PROFILE_STAGES; ++i)
+  {
+    ProfileStage stage = (ProfileStage)i;
+    out.printf("%-7s %-10u %-8u %-8u %-8u %u\r\n", stageName(i), (unsigned)_stats[i].count, (unsigned)averageMicros(stage),
+               (unsigned)percentileMicros(stage, 50), (unsigned)percentileMicros(stage, 99), (unsigned)toMicros(_stats[i].maxCycles));
+  }
+  out.printf("stalls %u (threshold %u us)\r\n", (unsigned)_record.stalls, (unsigned)_stallMicros);
+
+  if (!_previousValid)
+    return;
+  out.printf("previous boot: reset during %s, %u stalls\r\n", stageName(_previous.stage), (unsigned)_previous.stalls);
+  if (_previous.stalls)
+    out.printf("  last stall: %s %u us at %u ms %s\r\n", stageName(_previous.stallStage), (unsigned)_previous.stallMicros,
+               (unsigned)_previous.stallAt, _previous.stallUri);
+}
@@ -0,0 +1,111 @@
+#ifndef LoopProfiler_h
+#define LoopProfiler_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// a stage taking longer than this is recorded as a stall (ms)
+#ifndef PROFILER_STALL_THRESHOLD
+#define PROFILER_STALL_THRESHOLD  100
+#endif
+// first 4-byte block of RTC user memory used, clear of the OTA command
+#ifndef PROFILER_RTC_OFFSET
+#define PROFILER_RTC_OFFSET       64
+#endif
+#define PROFILER_MAGIC            0x50524F46UL    // "PROF"
+// power of two latency buckets, 1 us up to 32 ms and above
+#define PROFILER_BUCKETS          16
+#define PROFILER_URI_SIZE         32
+
+enum ProfileStage
+{
+    PROFILE_WIFI,
+    PROFILE_OTA,
+    PROFILE_TELNET,
+    PROFILE_SCAN,
+    PROFILE_HTTP,
+    PROFILE_LOG,
+    PROFILE_STAGES,
+    PROFILE_IDLE = PROFILE_STAGES
+};
+
+struct StageStats
+{
+    uint32_t count;
+    uint64_t cycles;
+    uint32_t maxCycles;
+    uint32_t buckets[PROFILER_BUCKETS];
+};
+
+// Kept in RTC memory, survives a soft or watchdog reset.
+// stage is written on every stage change and is not covered by crc.
+struct ProfilerRecord
+{
+    uint32_t magic;
+    uint32_t stage;
+    uint32_t stalls;
+    uint32_t stallStage;
+    uint32_t stallMicros;
+    uint32_t stallAt;
+    char stallUri[PROFILER_URI_SIZE];
+    uint32_t maxMicros[PROFILE_STAGES];
+    uint32_t crc;
+};
+
+// Times the stages of ServerHelper::loop() with the CPU cycle counter.
+//
+//   profiler.begin(PROFILE_HTTP);
+//   server.handleClient();
+//   if (profiler.end())
+//     profiler.stallContext(server.uri().c_str());
+//
+// Averages and percentiles are kept in RAM; the stage that is running,
+// the last stall and the worst time of each stage go to RTC memory, so
+// after a reset restore() tells what the previous boot was doing.
+class LoopProfiler
+{
+  public:
+    LoopProfiler();
+
+    // loads the record of the previous boot, then starts a new one
+    void restore();
+    bool hasPrevious() { return _previousValid; }
+    const ProfilerRecord &previous() { return _previous; }
+
+    void begin(ProfileStage stage);
+    // true if the stage stalled
+    bool end();
+    void stallContext(const char *uri);
+    // between loops, a reset now is not blamed on a stage
+    void idle();
+
+    void setStallThreshold(uint32_t ms) { _stallMicros = ms * 1000; }
+
+    const StageStats &stats(ProfileStage stage) { return _stats[stage]; }
+    uint32_t averageMicros(ProfileStage stage);
+    // upper bound of the bucket holding the given percentile, in us
+    uint32_t percentileMicros(ProfileStage stage, uint8_t percent);
+
+    void printTo(Print &out);
+
+    static const char *stageName(uint32_t stage);
+
+  protected:
+    void writeStage(uint32_t stage);
+    void save();
+    uint32_t toMicros(uint32_t cycles) { return cycles / _cyclesPerMicro; }
+
+    StageStats _stats[PROFILE_STAGES];
+    ProfilerRecord _record;
+    ProfilerRecord _previous;
+    bool _previousValid;
+    ProfileStage _stage;
+    uint32_t _start;
+    uint32_t _stallMicros;
+    uint32_t _cyclesPerMicro;
+};
+
+#endif
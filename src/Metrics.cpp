@@ -0,0 +1,186 @@
+#include "Metrics.h"
+#include "JsonWriter.h"
+
+#if SERVERHELPER_METRICS
+
+Metrics ServerMetrics;
+
+static const uint16_t bucketBounds[METRICS_BUCKETS] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+static const char *const statusNames[6] = {"none", "1xx", "2xx", "3xx", "4xx", "5xx"};
+
+RouteMetrics *Metrics::find(const void *key, const char *label, bool labelProgmem)
+{
+  for (size_t i = 0; i < _routes.size(); ++i)
+  {
+    if (_routes[i].key == key)
+      return &_routes[i];
+  }
+
+  RouteMetrics route;
+  memset(&route, 0, sizeof(route));
+  route.key = key;
+  route.label = label;
+  route.labelProgmem = labelProgmem;
+  _routes.push_back(route);
+  return &_routes.back();
+}
+
+void Metrics::begin(const void *key, const char *label, bool labelProgmem)
+{
+  _current = find(key, label, labelProgmem);
+  _code = 0;
+  _bytes = 0;
+  _start = micros();
+}
+
+void Metrics::response(int code)
+{
+  // the first status is the one that went out
+  if (_code == 0)
+    _code = code;
+}
+
+void Metrics::sent(size_t bytes)
+{
+  _bytes += bytes;
+}
+
+void Metrics::end()
+{
+  if (!_current)
+    return;
+
+  unsigned long elapsed = micros() - _start;
+  RouteMetrics &route = *_current;
+  _current = NULL;
+
+  ++route.count;
+  int status = _code / 100;
+  ++route.status[status >= 1 && status <= 5 ? status : 0];
+  route.bytes += _bytes;
+  route.sumMicros += elapsed;
+
+  size_t bucket = 0;
+  while (bucket < METRICS_BUCKETS && elapsed > bucketBounds[bucket] * 1000UL)
+    ++bucket;
+  ++route.buckets[bucket];
+}
+
+void Metrics::copyLabel(const RouteMetrics &route, char *buf, size_t size)
+{
+  if (route.labelProgmem)
+    strncpy_P(buf, route.label, size - 1);
+  else
+    strncpy(buf, route.label, size - 1);
+  buf[size - 1] = 0;
+}
+
+static void printLabel(Print &out, const char *label)
+{
+  // label values escape backslash and double quote
+  for (const char *p = label; *p; ++p)
+  {
+    if (*p == '\\' || *p == '"')
+      out.print('\\');
+    out.print(*p);
+  }
+}
+
+void Metrics::printPrometheus(Print &out)
+{
+  char label[64];
+
+  out.print(F("# TYPE serverhelper_requests_total counter\n"));
+  for (size_t i = 0; i < _routes.size(); ++i)
+  {
+    copyLabel(_routes[i], label, sizeof(label));
+    for (int s = 0; s < 6; ++s)
+    {
+      if (!_routes[i].status[s])
+        continue;
+      out.print(F("serverhelper_requests_total{route=\""));
+      printLabel(out, label);
+      out.printf("\",code=\"%s\"} %u\n", statusNames[s], (unsigned)_routes[i].status[s]);
+    }
+  }
+
+  out.print(F("# TYPE serverhelper_response_bytes_total counter\n"));
+  for (size_t i = 0; i < _routes.size(); ++i)
+  {
+    copyLabel(_routes[i], label, sizeof(label));
+    out.print(F("serverhelper_response_bytes_total{route=\""));
+    printLabel(out, label);
+    out.printf("\"} %u\n", (unsigned)_routes[i].bytes);
+  }
+
+  out.print(F("# TYPE serverhelper_request_duration_seconds histogram\n"));
+  for (size_t i = 0; i < _routes.size(); ++i)
+  {
+    const RouteMetrics &route = _routes[i];
+    copyLabel(route, label, sizeof(label));
+    uint32_t cumulative = 0;
+    for (int b = 0; b <= METRICS_BUCKETS; ++b)
+    {
+      cumulative += route.buckets[b];
+      out.print(F("serverhelper_request_duration_seconds_bucket{route=\""));
+      printLabel(out, label);
+      if (b < METRICS_BUCKETS)
+        out.printf("\",le=\"%u.%03u\"} %u\n", bucketBounds[b] / 1000, bucketBounds[b] % 1000, (unsigned)cumulative);
+      else
+        out.printf("\",le=\"+Inf\"} %u\n", (unsigned)cumulative);
+    }
+    out.print(F("serverhelper_request_duration_seconds_sum{route=\""));
+    printLabel(out, label);
+    out.printf("\"} %lu.%06lu\n", (unsigned long)(route.sumMicros / 1000000), (unsigned long)(route.sumMicros % 1000000));
+    out.print(F("serverhelper_request_duration_seconds_count{route=\""));
+    printLabel(out, label);
+    out.printf("\"} %u\n", (unsigned)route.count);
+  }
+}
+
+void Metrics::printJson(JsonWriter &json)
+{
+  char label[64];
+
+  json.beginObject();
+  json.key("buckets_ms");
+  json.beginArray();
+  for (int b = 0; b < METRICS_BUCKETS; ++b)
+    json.value((unsigned int)bucketBounds[b]);
+  json.endArray();
+
+  json.key("routes");
+  json.beginArray();
+  for (size_t i = 0; i < _routes.size(); ++i)
+  {
+    const RouteMetrics &route = _routes[i];
+    copyLabel(route, label, sizeof(label));
+    json.beginObject();
+    json.member("route", (const char *)label);
+    json.member("count", route.count);
+    json.member("bytes", route.bytes);
+    json.member("sum_us", (unsigned long)route.sumMicros);
+
+    json.key("status");
+    json.beginObject();
+    for (int s = 0; s < 6; ++s)
+    {
+      if (route.status[s])
+        json.member(statusNames[s], route.status[s]);
+    }
+    json.endObject();
+
+    // per bucket, not cumulative; the last one is above the largest bound
+    json.key("latency");
+    json.beginArray();
+    for (int b = 0; b <= METRICS_BUCKETS; ++b)
+      json.value(route.buckets[b]);
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+}
+
+#endif
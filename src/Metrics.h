@@ -0,0 +1,198 @@
+#ifndef Metrics_h
+#define Metrics_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WebServer.h>
+#include <vector>
+
+// set to 0 to compile the request metrics and /metrics out
+#ifndef SERVERHELPER_METRICS
+#define SERVERHELPER_METRICS 1
+#endif
+
+// upper bounds of the latency buckets in ms, the last bucket is +Inf
+#define METRICS_BUCKETS 10
+
+class JsonWriter;
+
+struct RouteMetrics
+{
+    // handler or PROGMEM uri identifying the route
+    const void *key;
+    const char *label;
+    bool labelProgmem;
+
+    uint32_t count;
+    // by status class, [0] for requests that sent no status
+    uint32_t status[6];
+    uint32_t bytes;
+    uint64_t sumMicros;
+    uint32_t buckets[METRICS_BUCKETS + 1];
+};
+
+// Request counts, status classes, bytes sent and latency histograms per
+// route. One request is measured at a time, between begin() and end();
+// recording it is a pointer search over the routes seen so far and a
+// walk over the buckets.
+class Metrics
+{
+  public:
+    Metrics() : _current(NULL), _start(0), _code(0), _bytes(0)
+    {
+    }
+
+    void begin(const void *key, const char *label, bool labelProgmem = false);
+    void response(int code);
+    void sent(size_t bytes);
+    void end();
+
+    // Prometheus text exposition format
+    void printPrometheus(Print &out);
+    void printJson(JsonWriter &json);
+
+  protected:
+    RouteMetrics *find(const void *key, const char *label, bool labelProgmem);
+    void copyLabel(const RouteMetrics &route, char *buf, size_t size);
+
+    std::vector<RouteMetrics> _routes;
+    RouteMetrics *_current;
+    unsigned long _start;
+    int _code;
+    size_t _bytes;
+};
+
+#if SERVERHELPER_METRICS
+extern Metrics ServerMetrics;
+#define METRICS_BEGIN(key, label, progmem) ServerMetrics.begin(key, label, progmem)
+#define METRICS_RESPONSE(code) ServerMetrics.response(code)
+#define METRICS_SENT(bytes) ServerMetrics.sent(bytes)
+#define METRICS_END() ServerMetrics.end()
+#else
+#define METRICS_BEGIN(key, label, progmem) do {} while (0)
+#define METRICS_RESPONSE(code) do {} while (0)
+#define METRICS_SENT(bytes) do {} while (0)
+#define METRICS_END() do {} while (0)
+#endif
+
+// ESP8266WebServer that reports the status and body size of what the
+// application sends to ServerMetrics. The send methods are not virtual,
+// so only calls made through this type are seen; JsonWriter reports
+// its own output.
+class MeteredWebServer : public ESP8266WebServer
+{
+  public:
+    MeteredWebServer(int port = 80) : ESP8266WebServer(port)
+    {
+    }
+
+    void send(int code, const char *content_type = NULL, const String &content = String(""))
+    {
+        METRICS_RESPONSE(code);
+        METRICS_SENT(content.length());
+        ESP8266WebServer::send(code, content_type, content);
+    }
+
+    void send(int code, char *content_type, const String &content)
+    {
+        send(code, (const char *)content_type, content);
+    }
+
+    void send(int code, const String &content_type, const String &content)
+    {
+        send(code, content_type.c_str(), content);
+    }
+
+    void send_P(int code, PGM_P content_type, PGM_P content)
+    {
+        METRICS_RESPONSE(code);
+        METRICS_SENT(strlen_P(content));
+        ESP8266WebServer::send_P(code, content_type, content);
+    }
+
+    void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength)
+    {
+        METRICS_RESPONSE(code);
+        METRICS_SENT(contentLength);
+        ESP8266WebServer::send_P(code, content_type, content, contentLength);
+    }
+
+    void sendContent(const String &content)
+    {
+        METRICS_SENT(content.length());
+        ESP8266WebServer::sendContent(content);
+    }
+
+    void sendContent_P(PGM_P content)
+    {
+        METRICS_SENT(strlen_P(content));
+        ESP8266WebServer::sendContent_P(content);
+    }
+
+    void sendContent_P(PGM_P content, size_t size)
+    {
+        METRICS_SENT(size);
+        ESP8266WebServer::sendContent_P(content, size);
+    }
+
+    // Takes the connection of the current request, after its headers are
+    // sent. handleClient() then moves on to the next client at once instead
+    // of waiting for this one to close.
+    WiFiClient detachClient()
+    {
+        WiFiClient client = _currentClient;
+        _currentClient = WiFiClient();
+        _currentStatus = HC_NONE;
+        return client;
+    }
+
+    // Gives a connection back to the server, e.g. a kept-alive client
+    // whose next request is waiting. False while another client is
+    // served, the caller tries again later.
+    bool attachClient(WiFiClient &client)
+    {
+        if (_currentStatus != HC_NONE)
+            return false;
+        _currentClient = client;
+        _currentStatus = HC_WAIT_READ;
+        _statusChange = millis();
+        return true;
+    }
+
+    // the client may send another request on this connection; needs the
+    // Connection header collected
+    bool keepAlive()
+    {
+        return _currentVersion >= 1 && !header("Connection").equalsIgnoreCase("close");
+    }
+
+    // send() without a body and without "Connection: close", for a body
+    // that someone else writes before the connection is used again
+    void sendKeepAlive(int code, const String &contentType, size_t contentLength)
+    {
+        METRICS_RESPONSE(code);
+        String response = "HTTP/1.1 " + String(code) + " " + _responseCodeToString(code) + "\r\n";
+        response += "Content-Type: " + contentType + "\r\n";
+        response += "Content-Length: " + String((unsigned long)contentLength) + "\r\n";
+        response += "Connection: keep-alive\r\n";
+        response += _responseHeaders;
+        response += "\r\n";
+        _responseHeaders = String();
+        _currentClient.write(response.c_str(), response.length());
+    }
+
+    template <typename T>
+    size_t streamFile(T &file, const String &contentType)
+    {
+        size_t sent = ESP8266WebServer::streamFile(file, contentType);
+        METRICS_RESPONSE(200);
+        METRICS_SENT(sent);
+        return sent;
+    }
+};
+
+#endif
@@ -0,0 +1,295 @@
+#include "RouteDispatcher.h"
+#include "ServerHelper.h"
+#include "Metrics.h"
+
+static uint32_t segmentHash(const char *str, int len)
+{
+  uint32_t hash = 5381;
+  for (int i = 0; i < len; ++i)
+    hash = hash * 33 + (uint8_t)str[i];
+  return hash;
+}
+
+static int segmentEnd(const String &uri, int pos)
+{
+  int end = uri.indexOf('/', pos);
+  if (end < 0)
+    end = uri.length();
+  return end;
+}
+
+void RouteDispatcher::add(MyRequestHandler *handler)
+{
+  const String &uri = handler->uri();
+  RouteNode *node = &_root;
+
+  // "/a/b" is stored as the segments "a" and "b", "/" as one empty segment
+  int pos = uri.startsWith("/") ? 1 : 0;
+  while (true)
+  {
+    int end = segmentEnd(uri, pos);
+    String segment = uri.substring(pos, end);
+    bool last = end >= (int)uri.length();
+
+    if (segment == "*" && last)
+    {
+      if (!node->wildcard)
+      {
+        node->wildcard = new RouteNode();
+        node->wildcard->segment = segment;
+      }
+      node = node->wildcard;
+    }
+    else if (segment.startsWith("{") && segment.endsWith("}") && segment.length() > 2)
+    {
+      if (!node->param)
+      {
+        node->param = new RouteNode();
+        node->param->segment = segment.substring(1, segment.length() - 1);
+      }
+      node = node->param;
+    }
+    else
+    {
+      uint32_t hash = segmentHash(segment.c_str(), segment.length());
+      RouteNode *child = node->children;
+      while (child && !(child->hash == hash && child->segment == segment))
+        child = child->next;
+
+      if (!child)
+      {
+        child = new RouteNode();
+        child->segment = segment;
+        child->hash = hash;
+        child->next = node->children;
+        node->children = child;
+      }
+      node = child;
+    }
+
+    if (last)
+      break;
+    pos = end + 1;
+  }
+
+  // keep registration order, the first matching method wins
+  handler->next(NULL);
+  if (!node->handlers)
+  {
+    node->handlers = handler;
+    return;
+  }
+  RequestHandler *tail = node->handlers;
+  while (tail->next())
+    tail = tail->next();
+  tail->next(handler);
+}
+
+MyRequestHandler *RouteDispatcher::find(HTTPMethod method, const String &uri)
+{
+  _args.clear();
+  _argNodes.clear();
+  return match(&_root, uri, uri.startsWith("/") ? 1 : 0, method);
+}
+
+MyRequestHandler *RouteDispatcher::matchMethod(RouteNode *node, HTTPMethod method)
+{
+  for (RequestHandler *h = node->handlers; h; h = h->next())
+  {
+    MyRequestHandler *handler = static_cast<MyRequestHandler *>(h);
+    if (handler->allows(method))
+      return handler;
+  }
+  return NULL;
+}
+
+MyRequestHandler *RouteDispatcher::match(RouteNode *node, const String &uri, int pos, HTTPMethod method)
+{
+  int end = segmentEnd(uri, pos);
+  int len = end - pos;
+  bool last = end >= (int)uri.length();
+  const char *segment = uri.c_str() + pos;
+  MyRequestHandler *handler;
+
+  // literal segments take precedence over parameters and wildcards
+  uint32_t hash = segmentHash(segment, len);
+  for (RouteNode *child = node->children; child; child = child->next)
+  {
+    if (child->hash == hash && (int)child->segment.length() == len && memcmp(child->segment.c_str(), segment, len) == 0)
+    {
+      handler = last ? matchMethod(child, method) : match(child, uri, end + 1, method);
+      if (handler)
+        return handler;
+      break;
+    }
+  }
+
+  if (node->param && len > 0)
+  {
+    _args.push_back(uri.substring(pos, end));
+    _argNodes.push_back(node->param);
+    handler = last ? matchMethod(node->param, method) : match(node->param, uri, end + 1, method);
+    if (handler)
+      return handler;
+    _args.pop_back();
+    _argNodes.pop_back();
+  }
+
+  if (node->wildcard)
+  {
+    handler = matchMethod(node->wildcard, method);
+    if (handler)
+    {
+      _args.push_back(uri.substring(pos));
+      _argNodes.push_back(node->wildcard);
+      return handler;
+    }
+  }
+
+  return NULL;
+}
+
+void RouteDispatcher::setStatic(const StaticRoute *routes, size_t count)
+{
+  _static = routes;
+  _staticCount = count;
+  _staticSorted = true;
+
+  StaticRoute prev, cur;
+  for (size_t i = 0; i < count; ++i)
+  {
+    memcpy_P(&cur, &routes[i], sizeof(cur));
+    if (i > 0)
+    {
+      // compare the PROGMEM strings through a RAM copy of one of them
+      char uri[64];
+      strncpy_P(uri, prev.uri, sizeof(uri) - 1);
+      uri[sizeof(uri) - 1] = 0;
+      if (strlen(uri) == sizeof(uri) - 1 || strcmp_P(uri, cur.uri) > 0)
+      {
+        _staticSorted = false;
+        break;
+      }
+    }
+    prev = cur;
+  }
+}
+
+bool RouteDispatcher::readStatic(size_t i, HTTPMethod method, StaticRoute *route)
+{
+  memcpy_P(route, &_static[i], sizeof(*route));
+  return route->method == HTTP_ANY || route->method == method;
+}
+
+bool RouteDispatcher::findStatic(HTTPMethod method, const String &uri, StaticRoute *route)
+{
+  if (!_static)
+    return false;
+
+  const char *requested = uri.c_str();
+  if (!_staticSorted)
+  {
+    for (size_t i = 0; i < _staticCount; ++i)
+    {
+      if (readStatic(i, method, route) && strcmp_P(requested, route->uri) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  size_t lo = 0;
+  size_t hi = _staticCount;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    memcpy_P(route, &_static[mid], sizeof(*route));
+    if (strcmp_P(requested, route->uri) > 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  // entries sharing a uri are adjacent, pick the first allowed method
+  for (size_t i = lo; i < _staticCount; ++i)
+  {
+    bool allowed = readStatic(i, method, route);
+    if (strcmp_P(requested, route->uri) != 0)
+      break;
+    if (allowed)
+      return true;
+  }
+  return false;
+}
+
+String RouteDispatcher::pathArg(int i)
+{
+  if (i < 0 || i >= (int)_args.size())
+    return String();
+  return _args[i];
+}
+
+String RouteDispatcher::pathArg(const String &name)
+{
+  for (size_t i = 0; i < _argNodes.size(); ++i)
+  {
+    if (_argNodes[i]->segment == name)
+      return _args[i];
+  }
+  return String();
+}
+
+bool RouteDispatcher::canHandle(HTTPMethod requestMethod, String requestUri)
+{
+  StaticRoute route;
+  if (findStatic(requestMethod, requestUri, &route))
+    return true;
+  return find(requestMethod, requestUri) != NULL;
+}
+
+bool RouteDispatcher::canUpload(String requestUri)
+{
+  StaticRoute route;
+  if (findStatic(HTTP_POST, requestUri, &route))
+    return route.ufn != NULL;
+  MyRequestHandler *handler = find(HTTP_POST, requestUri);
+  return handler && handler->hasUpload();
+}
+
+bool RouteDispatcher::handle(ESP8266WebServer &server, HTTPMethod requestMethod, String requestUri)
+{
+  (void)server;
+  StaticRoute route;
+  if (findStatic(requestMethod, requestUri, &route))
+  {
+    METRICS_BEGIN(route.uri, route.uri, true);
+    if (!_auth || _auth())
+      route.fn();
+    METRICS_END();
+    return true;
+  }
+
+  MyRequestHandler *handler = find(requestMethod, requestUri);
+  if (!handler)
+    return false;
+  METRICS_BEGIN(handler, handler->uri().c_str(), false);
+  handler->invoke();
+  METRICS_END();
+  return true;
+}
+
+void RouteDispatcher::upload(ESP8266WebServer &server, String requestUri, HTTPUpload &upload)
+{
+  (void)server;
+  (void)upload;
+  StaticRoute route;
+  if (findStatic(HTTP_POST, requestUri, &route))
+  {
+    if (route.ufn && (!_auth || _auth()))
+      route.ufn();
+    return;
+  }
+
+  MyRequestHandler *handler = find(HTTP_POST, requestUri);
+  if (handler && handler->hasUpload())
+    handler->invokeUpload();
+}
@@ -0,0 +1,95 @@
+#ifndef RouteDispatcher_h
+#define RouteDispatcher_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WebServer.h>
+#include <vector>
+
+class MyRequestHandler;
+
+// One path segment of a registered route.
+// Literal children are kept in a sibling list, "{name}" segments in
+// param and a trailing "*" in wildcard.
+struct RouteNode
+{
+    String segment;
+    uint32_t hash;
+    RouteNode *children;
+    RouteNode *next;
+    RouteNode *param;
+    RouteNode *wildcard;
+    MyRequestHandler *handlers;
+
+    RouteNode() : hash(0), children(NULL), next(NULL), param(NULL), wildcard(NULL), handlers(NULL)
+    {
+    }
+};
+
+// Route known at build time, meant to live in a PROGMEM table.
+// uri must point to a PROGMEM string as well, matching is exact.
+struct StaticRoute
+{
+    const char *uri;
+    HTTPMethod method;
+    void (*fn)(void);
+    void (*ufn)(void);
+};
+
+// Single RequestHandler that indexes all ServerHelper routes in a
+// segment trie, so a lookup costs one walk over the request path
+// instead of one String comparison per registered route.
+//
+// Patterns:
+//   /sensor/{id}    "{id}" matches one non-empty segment
+//   /files/*        "*" as last segment matches the rest of the path
+//
+// A table of StaticRoute entries is searched before the trie. Sorted by
+// uri it is binary searched, otherwise scanned; it costs no RAM.
+class RouteDispatcher : public RequestHandler
+{
+  public:
+    typedef std::function<bool(void)> AuthHandlerFunction;
+
+    RouteDispatcher() : _static(NULL), _staticCount(0), _staticSorted(false)
+    {
+    }
+
+    void setAuth(AuthHandlerFunction auth) { _auth = auth; }
+
+    void add(MyRequestHandler *handler);
+    MyRequestHandler *find(HTTPMethod method, const String &uri);
+
+    void setStatic(const StaticRoute *routes, size_t count);
+    bool findStatic(HTTPMethod method, const String &uri, StaticRoute *route);
+
+    // values captured by "{name}" and "*" segments of the last match
+    int pathArgs() { return _args.size(); }
+    String pathArg(int i);
+    String pathArg(const String &name);
+
+    bool canHandle(HTTPMethod requestMethod, String requestUri) override;
+    bool canUpload(String requestUri) override;
+    bool handle(ESP8266WebServer &server, HTTPMethod requestMethod, String requestUri) override;
+    void upload(ESP8266WebServer &server, String requestUri, HTTPUpload &upload) override;
+
+  protected:
+    MyRequestHandler *match(RouteNode *node, const String &uri, int pos, HTTPMethod method);
+    MyRequestHandler *matchMethod(RouteNode *node, HTTPMethod method);
+    bool readStatic(size_t i, HTTPMethod method, StaticRoute *route);
+
+    AuthHandlerFunction _auth;
+    const StaticRoute *_static;
+    size_t _staticCount;
+    bool _staticSorted;
+
+    RouteNode _root;
+    std::vector<String> _args;
+    std::vector<RouteNode *> _argNodes;
+};
+
+#endif
@@ -1,7 +1,5 @@
 #include "ServerHelper.h"
 
-#define DBG_OUTPUT (*dbg_out)
-
 enum ConfigMode
 {
   SSID_PASS   = 1 << 0,
@@ -10,26 +8,153 @@ enum ConfigMode
   NAME        = 1 << 3
 };
 
-void ServerHelper::handleTelnet()
+// request headers the web server has to keep for us
+static const char *collectedHeaders[] = {
+  "Accept-Encoding",
+  "If-None-Match",
+  "Content-Length",
+  "Range",
+  "If-Range",
+  "Cookie",
+  "Connection",
+  UPLOAD_MD5_HEADER
+};
+
+// sorted by extension for the binary search in getContentType
+static constexpr MimeType mimeTypes[] = {
+  {"bin", "application/octet-stream"},
+  {"css", "text/css"},
+  {"csv", "text/csv"},
+  {"eot", "application/vnd.ms-fontobject"},
+  {"gif", "image/gif"},
+  {"gz", "application/x-gzip"},
+  {"htm", "text/html"},
+  {"html", "text/html"},
+  {"ico", "image/x-icon"},
+  {"jpeg", "image/jpeg"},
+  {"jpg", "image/jpeg"},
+  {"js", "application/javascript"},
+  {"json", "application/json"},
+  {"map", "application/json"},
+  {"mjs", "application/javascript"},
+  {"mp3", "audio/mpeg"},
+  {"mp4", "video/mp4"},
+  {"otf", "font/otf"},
+  {"pdf", "application/x-pdf"},
+  {"png", "image/png"},
+  {"svg", "image/svg+xml"},
+  {"ttf", "font/ttf"},
+  {"txt", "text/plain"},
+  {"wasm", "application/wasm"},
+  {"webmanifest", "application/manifest+json"},
+  {"webp", "image/webp"},
+  {"woff", "font/woff"},
+  {"woff2", "font/woff2"},
+  {"xml", "text/xml"},
+  {"zip", "application/x-zip"}
+};
+
+#define MIME_TYPES_COUNT  (sizeof(mimeTypes) / sizeof(mimeTypes[0]))
+#define MIME_EXT_MAX      15
+
+static constexpr bool mimeLess(const char *a, const char *b)
+{
+  return *a != *b ? (unsigned char)*a < (unsigned char)*b : (*a != 0 && mimeLess(a + 1, b + 1));
+}
+
+static constexpr bool mimeSorted(const MimeType *types, size_t count)
+{
+  return count < 2 || (mimeLess(types[0].extension, types[1].extension) && mimeSorted(types + 1, count - 1));
+}
+
+static_assert(mimeSorted(mimeTypes, MIME_TYPES_COUNT), "mimeTypes must be sorted by extension");
+
+#define FNV_OFFSET_BASIS  2166136261UL
+#define FNV_PRIME         16777619UL
+
+static_assert(sizeof(ConfigRecord) == 200, "ConfigRecord must not contain padding");
+static_assert(CONFIG_ADDR + sizeof(ConfigRecord) <= E_EEPROM_SIZE, "ConfigRecord does not fit in EEPROM");
+
+static bool configValid(const ConfigRecord &config)
 {
-  if (TelnetServer.hasClient())
+  return config.magic == CONFIG_MAGIC && config.version == CONFIG_VERSION && config.size == sizeof(config) &&
+         config.crc == SettingsStore::crc32(0, &config, offsetof(ConfigRecord, crc));
+}
+
+// files of the helper itself, not served, listed or written by clients
+static bool reservedPath(const String &path)
+{
+  return path == ETAG_INDEX_PATH || path == UPLOAD_TEMP_PATH || path == UPLOAD_BACKUP_PATH || path == UPLOAD_TARGET_PATH;
+}
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
   {
-    if (!Telnet || Telnet.connected())
-    {
-      if (Telnet)
-        Telnet.stop();
-      Telnet = TelnetServer.available();
-    }
-    else
-    {
-      TelnetServer.available().stop();
-    }
+    hash ^= data[i];
+    hash *= FNV_PRIME;
   }
+  return hash;
+}
+
+void ServerHelper::handleTelnet()
+{
+  Telnet.handle();
+}
+
+#if SERVERHELPER_METRICS
+static const char fileRouteKey = 0;
+#endif
+
+static const char *const wifiStateNames[] = {"idle", "connecting", "connected", "reconnecting", "failed", "ap"};
+
+void ServerHelper::setupConsole()
+{
+  Telnet.begin();
+
+  Telnet.addCommand("status", [&](Print &out, const String &args) {
+    (void)args;
+    out.printf("uptime %lu s\r\n", millis() / 1000);
+    out.printf("wifi %s, %s, rssi %d\r\n", wifiStateNames[wifiState], WiFi.localIP().toString().c_str(), WiFi.RSSI());
+    out.printf("heap %u\r\n", ESP.getFreeHeap());
+    out.printf("telnet %d clients, %u dropped\r\n", Telnet.clients(), Telnet.dropped());
+    out.printf("log level %u, %u dropped\r\n", ServerLog.level(), ServerLog.dropped());
+    if (fileCache.enabled())
+      out.printf("file cache %u files, %u bytes, %u hits, %u misses\r\n", (unsigned)fileCache.count(), (unsigned)fileCache.size(),
+                 (unsigned)fileCache.hits(), (unsigned)fileCache.misses());
+    out.printf("events %d subscribers, %u dropped\r\n", events.clients(), (unsigned)events.dropped());
+    if (transfers.enabled())
+      out.printf("transfers %u active, %u idle, %u completed, %u aborted, %u reused\r\n", (unsigned)transfers.active(),
+                 (unsigned)transfers.idle(), (unsigned)transfers.completed(), (unsigned)transfers.aborted(), (unsigned)transfers.reused());
+  }, "uptime, wifi and memory");
+
+  Telnet.addCommand("heap", [&](Print &out, const String &args) {
+    (void)args;
+    out.printf("free %u\r\n", ESP.getFreeHeap());
+  }, "free heap");
+
+  Telnet.addCommand("reboot", [&](Print &out, const String &args) {
+    (void)args;
+    out.println("rebooting");
+    // give the reply a moment to leave
+    restartAt = millis() + 500;
+  }, "restart the device");
+
+  Telnet.addCommand("log", [&](Print &out, const String &args) {
+    if (args.length() > 0)
+      ServerLog.setLevel(constrain(args.toInt(), LOG_LEVEL_NONE, LOG_LEVEL_DEBUG));
+    out.printf("log level %u (0 none .. 4 debug)\r\n", ServerLog.level());
+  }, "[level] show or set the log level");
+
+  Telnet.addCommand("profile", [&](Print &out, const String &args) {
+    (void)args;
+    profiler.printTo(out);
+  }, "loop stage timing and stalls");
 }
 
 void ServerHelper::OTA_setup()
 {
-  DBG_OUTPUT.println("OTA has started");
+  LOG_INFO("ota", "OTA has started");
   // Port defaults to 8266
   ArduinoOTA.setPort(8266);
 
@@ -42,29 +167,31 @@ void ServerHelper::OTA_setup()
 
   ArduinoOTA.onStart([&]() {
     onStartUpdateHandler();
-    DBG_OUTPUT.println("Start");
+    LOG_INFO("ota", "Start");
   });
   ArduinoOTA.onEnd([&]() {
-    DBG_OUTPUT.println("\nEnd");
+    LOG_INFO("ota", "End");
   });
   ArduinoOTA.onProgress([&](unsigned int progress, unsigned int total) {
-    DBG_OUTPUT.printf("Progress: %u%%\r", (progress / (total / 100)));
+    LOG_DEBUG("ota", "Progress: %u%%", (progress / (total / 100)));
   });
   ArduinoOTA.onError([&](ota_error_t error) {
-    DBG_OUTPUT.printf("Error[%u]: ", error);
     if (error == OTA_AUTH_ERROR)
-      DBG_OUTPUT.println("Auth Failed");
+      LOG_ERROR("ota", "Error[%u]: Auth Failed", error);
     else if (error == OTA_BEGIN_ERROR)
-      DBG_OUTPUT.println("Begin Failed");
+      LOG_ERROR("ota", "Error[%u]: Begin Failed", error);
     else if (error == OTA_CONNECT_ERROR)
-      DBG_OUTPUT.println("Connect Failed");
+      LOG_ERROR("ota", "Error[%u]: Connect Failed", error);
     else if (error == OTA_RECEIVE_ERROR)
-      DBG_OUTPUT.println("Receive Failed");
+      LOG_ERROR("ota", "Error[%u]: Receive Failed", error);
     else if (error == OTA_END_ERROR)
-      DBG_OUTPUT.println("End Failed");
+      LOG_ERROR("ota", "Error[%u]: End Failed", error);
+    else
+      LOG_ERROR("ota", "Error[%u]", error);
   });
   ArduinoOTA.begin();
-  DBG_OUTPUT.println("OTA has begun");
+  otaStarted = true;
+  LOG_INFO("ota", "OTA has begun");
 }
 
 void ServerHelper::clearEEPROM(int addr, int len)
@@ -75,10 +202,7 @@ void ServerHelper::clearEEPROM(int addr, int len)
   }
   EEPROM.commit();
 
-  DBG_OUTPUT.print("EEPROM: cleared from ");
-  DBG_OUTPUT.print(addr);
-  DBG_OUTPUT.print(" to ");
-  DBG_OUTPUT.println(addr + len);
+  LOG_INFO("cfg", "EEPROM: cleared from %d to %d", addr, addr + len);
 }
 
 int ServerHelper::readEEPROM(int addr, String *str, int len)
@@ -87,9 +211,7 @@ int ServerHelper::readEEPROM(int addr, String *str, int len)
   {
     char ch = char(EEPROM.read(addr + i));
     *str += ch;
-    DBG_OUTPUT.print(ch);
   }
-  DBG_OUTPUT.println();
   return addr + len;
 }
 
@@ -104,10 +226,8 @@ int ServerHelper::writeEEPROM(int addr, String str, int len)
   for (int i = 0; i < max_len; ++i)
   {
     EEPROM.write(addr + i, str[i]);
-    DBG_OUTPUT.print(str[i]);
     outaddr++;
   }
-  DBG_OUTPUT.println();
   return outaddr;
 }
 
@@ -124,33 +244,49 @@ void ServerHelper::setup(void (*handler)(void))
 {
   onStartUpdateHandler = handler;
 
-  www_username = "admin";
-  www_password = "admin";
+  ServerLog.setOutput(dbg_out);
+
+  profiler.restore();
+  if (profiler.hasPrevious() && profiler.previous().stage != PROFILE_IDLE)
+    LOG_WARN("prof", "previous boot reset during %s (%s)", LoopProfiler::stageName(profiler.previous().stage),
+             ESP.getResetReason().c_str());
 
-  TelnetServer.begin();
-  TelnetServer.setNoDelay(true);
+  setCredentials("admin", "admin");
+
+  setupConsole();
 
   WiFi.mode(WIFI_STA);
 
-  SPIFFS.begin();
+  fileSystem->begin();
+  server.collectHeaders(collectedHeaders, sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
+  loadFileTags();
+  // left behind by an upload cut short by a reset
+  recoverUpload();
+  routes.setAuth([&]() { return checkAuthentication(); });
+  server.addHandler(&routes);
+  // a kept-alive connection's next request goes through the server again
+  transfers.onRequest([&](WiFiClient &client) { return server.attachClient(client); });
   //called when the url is not defined here
-  //use it to load content from SPIFFS
+  //use it to load content from the filesystem
   server.onNotFound([&]() {
-    if (!checkAuthentication())
-      return;
-    if (!handleFileRead(server.uri()))
+    // every file shares one entry, paths would grow the table unbounded
+    METRICS_BEGIN(&fileRouteKey, "(files)", false);
+    if (checkAuthentication() && !handleFileRead(server.uri()))
       server.send(404, "text/plain", "File Not Found");
+    METRICS_END();
   });
 
-  EEPROM.begin(512);
+  EEPROM.begin(E_EEPROM_SIZE);
+  if (loadConfig())
+    LOG_INFO("cfg", "CONFIG OK");
 
   if (read_user_and_pass())
   {
-    DBG_OUTPUT.println("USER AND PASS DO EXIST");
+    LOG_INFO("cfg", "USER AND PASS DO EXIST");
   }
   else
   {
-    DBG_OUTPUT.println("USER AND PASS DON'T EXIST");
+    LOG_INFO("cfg", "USER AND PASS DON'T EXIST");
   }
 
   read_device_name();
@@ -159,35 +295,78 @@ void ServerHelper::setup(void (*handler)(void))
 
   if (read_ssid_and_pass(&essid, &epass))
   {
-    DBG_OUTPUT.println("SSID AND PASS DO EXIST");
+    LOG_INFO("cfg", "SSID AND PASS DO EXIST");
 
     if (read_and_config())
-      DBG_OUTPUT.println("READ AND CONFIG OK");
+      LOG_INFO("wifi", "READ AND CONFIG OK");
     else
-      DBG_OUTPUT.println("READ AND CONFIG FAILED");
-
-    WiFi.begin(essid.c_str(), epass.c_str());
-    if (testWifi())
+      LOG_INFO("wifi", "READ AND CONFIG FAILED");
+
+    // handleWifi takes it from here, the web server starts once connected
+    uint8_t bssid[E_BSSID_SIZE];
+    int32_t channel;
+    wifiConnectStart = millis();
+    wifiFastConnect = read_bssid_and_channel(bssid, &channel);
+    if (wifiFastConnect)
     {
-      OTA_setup();
-      launchWeb(0);
-      return;
+      LOG_INFO("wifi", "Fast connect on channel %d", channel);
+      WiFi.begin(essid.c_str(), epass.c_str(), channel, bssid);
     }
-  }
-  else
-  {
-    DBG_OUTPUT.println("SSID AND PASS DON'T EXIST");
+    else
+    {
+      WiFi.begin(essid.c_str(), epass.c_str());
+    }
+    LOG_INFO("wifi", "Waiting for Wifi to connect...");
+    setWifiState(WIFI_STATE_CONNECTING);
+    return;
   }
 
-  setupAP();
-  OTA_setup();
+  LOG_INFO("cfg", "SSID AND PASS DON'T EXIST");
+  setWifiState(WIFI_STATE_FAILED);
+  handleWifi();
 }
 
 void ServerHelper::loop()
 {
+  profiler.begin(PROFILE_WIFI);
+  handleWifi();
+  profiler.end();
+
+  profiler.begin(PROFILE_OTA);
   ArduinoOTA.handle();
+  profiler.end();
+
+  profiler.begin(PROFILE_TELNET);
   handleTelnet();
+  profiler.end();
+
+  profiler.begin(PROFILE_SCAN);
+  updateNetworkScan();
+  profiler.end();
+
+  profiler.begin(PROFILE_HTTP);
+  // handleClient() takes at most one request
+  authRejected = false;
   server.handleClient();
+  transfers.handle();
+  events.handle();
+  if (profiler.end())
+    profiler.stallContext(server.uri().c_str());
+
+  profiler.begin(PROFILE_LOG);
+  ServerLog.drain();
+  profiler.end();
+
+  profiler.idle();
+
+  if (configPending && (long)(millis() - configApplyAt) >= 0)
+    applyConfig();
+
+  if (restartAt && (long)(millis() - restartAt) >= 0)
+  {
+    ServerLog.flush();
+    ESP.restart();
+  }
 }
 
 void ServerHelper::printMyTime()
@@ -197,62 +376,149 @@ void ServerHelper::printMyTime()
   byte m = (t / 60) % 60;
   byte s = t % 60;
 
-  DBG_OUTPUT.print(h / 10);
-  DBG_OUTPUT.print(h % 10);
-  DBG_OUTPUT.print(":");
-  DBG_OUTPUT.print(m / 10);
-  DBG_OUTPUT.print(m % 10);
-  DBG_OUTPUT.print(":");
-  DBG_OUTPUT.print(s / 10);
-  DBG_OUTPUT.print(s % 10);
-  DBG_OUTPUT.println();
+  LOG_INFO("time", "%02u:%02u:%02u", h, m, s);
 }
 
 bool ServerHelper::testWifi(void)
 {
   int c = 0;
-  DBG_OUTPUT.println("Waiting for Wifi to connect...");
+  LOG_INFO("wifi", "Waiting for Wifi to connect...");
   while (c < 20)
   {
     if (WiFi.status() == WL_CONNECTED)
-    {
-      DBG_OUTPUT.println();
       return true;
-    }
     delay(500);
-    DBG_OUTPUT.print(WiFi.status());
+    LOG_DEBUG("wifi", "status %d", WiFi.status());
     c++;
   }
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("Connect timed out, opening AP");
+  LOG_WARN("wifi", "Connect timed out, opening AP");
   return false;
 }
 
-void ServerHelper::launchWeb(int webtype)
+void ServerHelper::handleWifi(void)
 {
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("WiFi connected");
+  bool connected = WiFi.status() == WL_CONNECTED;
+  unsigned long elapsed = millis() - wifiStateSince;
 
-  if (webtype == 0)
+  switch (wifiState)
   {
-    DBG_OUTPUT.print("Local IP: ");
-    DBG_OUTPUT.println(WiFi.localIP());
+  case WIFI_STATE_CONNECTING:
+    if (connected)
+    {
+      wifiConnectTime = millis() - wifiConnectStart;
+      LOG_INFO("wifi", "WiFi connected in %lu ms%s", wifiConnectTime, wifiFastConnect ? " (fast)" : "");
+      write_bssid_and_channel(WiFi.BSSID(), WiFi.channel());
+      setWifiState(WIFI_STATE_CONNECTED);
+      // a network joined later through /config finds both running
+      if (!webStarted)
+      {
+        OTA_setup();
+        launchWeb(0);
+      }
+    }
+    else if (wifiFastConnect && elapsed > WIFI_FAST_CONNECT_TIMEOUT)
+    {
+      // the access point moved or changed channel, scan for it
+      LOG_WARN("wifi", "Fast connect failed, scanning");
+      wifiFastConnect = false;
+      beginWifi();
+      wifiStateSince = millis();
+    }
+    else if (elapsed > wifiConnectTimeout)
+    {
+      LOG_WARN("wifi", "Connect timed out, opening AP");
+      setWifiState(WIFI_STATE_FAILED);
+    }
+    break;
+
+  case WIFI_STATE_FAILED:
+    setupAP();
+    if (!otaStarted)
+      OTA_setup();
+    setWifiState(WIFI_STATE_AP);
+    break;
+
+  case WIFI_STATE_CONNECTED:
+    if (!connected)
+    {
+      LOG_WARN("wifi", "WiFi connection lost");
+      wifiRetryDelay = wifiRetryMin;
+      setWifiState(WIFI_STATE_RECONNECTING);
+    }
+    break;
+
+  case WIFI_STATE_RECONNECTING:
+    if (connected)
+    {
+      LOG_INFO("wifi", "WiFi reconnected");
+      write_bssid_and_channel(WiFi.BSSID(), WiFi.channel());
+      setWifiState(WIFI_STATE_CONNECTED);
+    }
+    else if (elapsed > wifiRetryDelay)
+    {
+      WiFi.reconnect();
+      wifiStateSince = millis();
+      wifiRetryDelay = min(wifiRetryDelay * 2, wifiRetryMax);
+    }
+    break;
+
+  default:
+    break;
   }
+}
+
+void ServerHelper::beginWifi(void)
+{
+  String essid, epass;
+  if (read_ssid_and_pass(&essid, &epass))
+    WiFi.begin(essid.c_str(), epass.c_str());
+}
+
+void ServerHelper::setWifiState(WifiState state)
+{
+  WifiState from = wifiState;
+  wifiState = state;
+  wifiStateSince = millis();
+  broadcast("wifi", wifiStateNames[state]);
+  if (wifiStateHandler)
+    wifiStateHandler(from, state);
+}
+
+void ServerHelper::onWifiState(void (*handler)(WifiState from, WifiState to))
+{
+  wifiStateHandler = handler;
+}
+
+void ServerHelper::setWifiTimeout(unsigned long timeout)
+{
+  wifiConnectTimeout = timeout;
+}
+
+void ServerHelper::setWifiBackoff(unsigned long retryMin, unsigned long retryMax)
+{
+  wifiRetryMin = retryMin;
+  wifiRetryMax = retryMax;
+}
+
+void ServerHelper::launchWeb(int webtype)
+{
+  if (webtype == 0)
+    LOG_INFO("wifi", "Local IP: %s", WiFi.localIP().toString().c_str());
   else
-  {
-    DBG_OUTPUT.print("SoftAP IP: ");
-    DBG_OUTPUT.println(WiFi.softAPIP());
-  }
+    LOG_INFO("wifi", "SoftAP IP: %s", WiFi.softAPIP().toString().c_str());
 
+  // the routes are registered once, falling back to the AP later keeps them
+  if (webStarted)
+    return;
   createWebServer(webtype);
   // Start the server
   server.begin();
-  DBG_OUTPUT.println("Server started");
+  webStarted = true;
+  LOG_INFO("http", "Server started");
 }
 
 void ServerHelper::setupAP()
 {
-  DBG_OUTPUT.print("SETUP AP: ");
   WiFi.mode(WIFI_AP);
 
   if (apSSID.length() == 0 || apPASS.length() == 0)
@@ -262,105 +528,471 @@ void ServerHelper::setupAP()
 
   if (WiFi.softAP(apSSID.c_str(), apPASS.c_str()))
   {
-    DBG_OUTPUT.println("OK");
+    LOG_INFO("wifi", "SETUP AP: OK");
   }
   else
   {
-    DBG_OUTPUT.println("Failed");
+    LOG_ERROR("wifi", "SETUP AP: Failed");
+    ServerLog.flush();
     delay(1000);
     ESP.restart();
   }
   launchWeb(1);
 }
 
-void ServerHelper::listNetworks(void)
+void ServerHelper::startNetworkScan(void)
 {
-  int n = WiFi.scanNetworks();
-  DBG_OUTPUT.println("scan done");
-  if (n == 0)
-    DBG_OUTPUT.println("no networks found");
-  else
+  if (networksScanning)
+    return;
+  // async scan, results are collected by updateNetworkScan
+  WiFi.scanNetworks(true);
+  networksScanning = true;
+  LOG_DEBUG("wifi", "scan started");
+}
+
+void ServerHelper::updateNetworkScan(void)
+{
+  if (!networksScanning)
+    return;
+
+  int n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING)
+    return;
+
+  networksScanning = false;
+  if (n < 0)
   {
-    DBG_OUTPUT.print(n);
-    DBG_OUTPUT.println(" networks found");
-    for (int i = 0; i < n; ++i)
-    {
-      // Print SSID and RSSI for each network found
-      DBG_OUTPUT.print(i + 1);
-      DBG_OUTPUT.print(": ");
-      DBG_OUTPUT.print(WiFi.SSID(i));
-      DBG_OUTPUT.print(" (");
-      DBG_OUTPUT.print(WiFi.RSSI(i));
-      DBG_OUTPUT.print(")");
-      DBG_OUTPUT.println((WiFi.encryptionType(i) == ENC_TYPE_NONE) ? " " : "*");
-      delay(10);
-    }
+    LOG_WARN("wifi", "scan failed");
+    return;
   }
-  DBG_OUTPUT.println("");
-  st = "[";
+
+  networks.clear();
+  networks.reserve(n);
   for (int i = 0; i < n; ++i)
   {
-    // Print SSID and RSSI for each network found
-    st += "{\"ssid\":\"";
-    st += WiFi.SSID(i);
-    st += "\",\"rssi\":\"";
-    st += WiFi.RSSI(i);
-    st += "\",\"encyrption\":";
-    st += (WiFi.encryptionType(i) == ENC_TYPE_NONE) ? "false" : "true";
-    st += "}";
+    NetworkInfo info;
+    info.ssid = WiFi.SSID(i);
+    info.rssi = WiFi.RSSI(i);
+    info.channel = WiFi.channel(i);
+    info.encrypted = WiFi.encryptionType(i) != ENC_TYPE_NONE;
+    networks.push_back(info);
+  }
+  WiFi.scanDelete();
+
+  networksScannedAt = millis();
+  networksScanned = true;
+  LOG_DEBUG("wifi", "scan done: %d networks found", n);
+  // pages fetch /networks when told instead of polling it
+  broadcast("networks", String(n));
+}
 
-    if (i + 1 < n)
-      st += ",";
+void ServerHelper::listNetworks(void)
+{
+  // answer from the cache, a scan takes seconds and runs in the background
+  if (!networksScanned || server.arg("refresh") == "1" || millis() - networksScannedAt > NETWORKS_MAX_AGE)
+    startNetworkScan();
+
+  JsonWriter json(server);
+  json.begin();
+  json.beginObject();
+  json.member("version", NETWORKS_SCHEMA_VERSION);
+  json.member("scanning", networksScanning);
+  json.key("age");
+  if (networksScanned)
+    json.value(millis() - networksScannedAt);
+  else
+    json.nullValue();
+  json.key("networks");
+  json.beginArray();
+  for (size_t i = 0; i < networks.size(); ++i)
+  {
+    json.beginObject();
+    json.member("ssid", networks[i].ssid);
+    json.member("rssi", (long)networks[i].rssi);
+    json.member("channel", (long)networks[i].channel);
+    json.member("encryption", networks[i].encrypted);
+    json.endObject();
   }
-  st += "]";
+  json.endArray();
+  json.endObject();
+  json.end();
 }
 
-String ServerHelper::getContentType(String filename)
+String ServerHelper::getContentType(const String &filename)
 {
   if (server.hasArg("download"))
     return "application/octet-stream";
-  else if (filename.endsWith(".htm"))
-    return "text/html";
-  else if (filename.endsWith(".html"))
-    return "text/html";
-  else if (filename.endsWith(".css"))
-    return "text/css";
-  else if (filename.endsWith(".js"))
-    return "application/javascript";
-  else if (filename.endsWith(".png"))
-    return "image/png";
-  else if (filename.endsWith(".gif"))
-    return "image/gif";
-  else if (filename.endsWith(".jpg"))
-    return "image/jpeg";
-  else if (filename.endsWith(".ico"))
-    return "image/x-icon";
-  else if (filename.endsWith(".xml"))
-    return "text/xml";
-  else if (filename.endsWith(".pdf"))
-    return "application/x-pdf";
-  else if (filename.endsWith(".zip"))
-    return "application/x-zip";
-  else if (filename.endsWith(".gz"))
-    return "application/x-gzip";
+
+  // lower-cased extension, found in a single pass from the end
+  char ext[MIME_EXT_MAX + 1];
+  int len = 0;
+  int i = filename.length();
+  while (--i >= 0)
+  {
+    char ch = filename[i];
+    if (ch == '.')
+      break;
+    if (ch == '/' || len == MIME_EXT_MAX)
+      return "text/plain";
+    ext[len++] = tolower(ch);
+  }
+  if (i < 0 || len == 0)
+    return "text/plain";
+
+  for (int j = 0; j < len / 2; ++j)
+  {
+    char ch = ext[j];
+    ext[j] = ext[len - 1 - j];
+    ext[len - 1 - j] = ch;
+  }
+  ext[len] = 0;
+
+  for (size_t j = 0; j < extraMimeTypesCount; ++j)
+  {
+    if (strcmp(ext, extraMimeTypes[j].extension) == 0)
+      return extraMimeTypes[j].type;
+  }
+
+  int lo = 0;
+  int hi = MIME_TYPES_COUNT - 1;
+  while (lo <= hi)
+  {
+    int mid = (lo + hi) / 2;
+    int cmp = strcmp(ext, mimeTypes[mid].extension);
+    if (cmp == 0)
+      return mimeTypes[mid].type;
+    if (cmp < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
   return "text/plain";
 }
 
+// "0", "0.5", "1.000"; anything else counts as 0, the coding is refused
+static int parseQuality(const char *p)
+{
+  if (*p == '1')
+    return 1000;
+  if (*p != '0')
+    return 0;
+  int q = 0;
+  if (*++p == '.')
+  {
+    ++p;
+    for (int scale = 100; scale > 0 && isdigit(*p); scale /= 10, ++p)
+      q += (*p - '0') * scale;
+  }
+  return q;
+}
+
+// q of coding in an Accept-Encoding header in thousandths, -1 when the
+// coding is not listed
+static int encodingQuality(const char *header, const char *coding)
+{
+  size_t codingLen = strlen(coding);
+  const char *p = header;
+  while (*p)
+  {
+    while (*p == ' ' || *p == '\t' || *p == ',')
+      ++p;
+    const char *name = p;
+    while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+      ++p;
+    size_t nameLen = p - name;
+
+    int q = 1000;
+    while (*p && *p != ',')
+    {
+      if (*p++ != ';')
+        continue;
+      while (*p == ' ' || *p == '\t')
+        ++p;
+      if ((*p == 'q' || *p == 'Q') && p[1] == '=')
+        q = parseQuality(p + 2);
+    }
+    if (nameLen == codingLen && strncasecmp(name, coding, nameLen) == 0)
+      return q;
+  }
+  return -1;
+}
+
+bool ServerHelper::acceptsGzip()
+{
+  // "gzip;q=0" refuses it, also when "*" would take anything else
+  String encoding = server.header("Accept-Encoding");
+  int q = encodingQuality(encoding.c_str(), "gzip");
+  if (q < 0)
+    q = encodingQuality(encoding.c_str(), "x-gzip");
+  if (q < 0)
+    q = encodingQuality(encoding.c_str(), "*");
+  return q > 0;
+}
+
 bool ServerHelper::handleFileRead(String path)
 {
-  DBG_OUTPUT.println("handleFileRead: " + path);
   if (path.endsWith("/"))
     path += "index.html";
+  if (reservedPath(path))
+    return false;
+  if (assets.enabled() && sendAsset(path))
+    return true;
   String contentType = getContentType(path);
   String pathWithGz = path + ".gz";
-  if (SPIFFS.exists(path))
+
+  // a precompressed copy is sent with the original content type,
+  // streamFile adds "Content-Encoding: gzip" for it
+  bool hasGz = !server.hasArg("download") && fileExists(pathWithGz);
+  if (hasGz)
+    server.sendHeader("Vary", "Accept-Encoding");
+
+  // only a swapped-in variant is labelled as encoded, a .gz asked for
+  // by name goes out as the bytes it is
+  bool gzip = hasGz && (acceptsGzip() || !fileExists(path));
+  if (gzip)
+    path = pathWithGz;
+  else if (!fileExists(path))
+    return false;
+
+  // opened first, the ETag is checked against its size
+  File file;
+  if (!fileCache.contains(path))
+  {
+    file = fileSystem->open(path, "r");
+    if (!file)
+      return false;
+  }
+  String etag = fileETag(path, file);
+  server.sendHeader("Accept-Ranges", "bytes");
+  if (etag.length() > 0)
+  {
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", getCacheControl(path));
+    if (server.header("If-None-Match").indexOf(etag) >= 0)
+    {
+      file.close();
+      server.send(304);
+      return true;
+    }
+  }
+
+  // small files are answered from RAM, ranges are for large ones
+  bool cacheable = fileCache.enabled() && server.header("Range").length() == 0;
+  CachedFile *cached = cacheable ? fileCache.find(path) : NULL;
+  if (cached)
   {
-    File file = SPIFFS.open(path, "r");
-    size_t sent = server.streamFile(file, contentType);
     file.close();
+    sendCachedFile(cached, contentType, gzip);
     return true;
   }
-  return false;
+
+  if (!file)
+    file = fileSystem->open(path, "r");
+  if (cacheable && (cached = fileCache.add(path, file)) != NULL)
+  {
+    file.close();
+    sendCachedFile(cached, contentType, gzip);
+    return true;
+  }
+
+  size_t start, end, sent;
+  // a range of a changed file would mix two versions, send it whole
+  String ifRange = server.header("If-Range");
+  RangeResult range = ifRange.length() > 0 && ifRange != etag ? RANGE_NONE : parseRange(server.header("Range"), file.size(), &start, &end);
+  if (range == RANGE_UNSATISFIABLE)
+  {
+    server.sendHeader("Content-Range", "bytes */" + String((unsigned long)file.size()));
+    server.send(416);
+    sent = 0;
+  }
+  else if (range == RANGE_OK)
+  {
+    sent = streamFileRange(file, contentType, start, end, gzip);
+  }
+  else if (canTransfer(file.size()))
+  {
+    // what streamFile sends, with the body left to loop()
+    if (gzip)
+      server.sendHeader("Content-Encoding", "gzip");
+    sent = startTransfer(file, 200, contentType, file.size());
+  }
+  else
+  {
+    sent = server.streamFile(file, contentType);
+  }
+  file.close();
+  LOG_DEBUG("http", "handleFileRead: sent %u bytes of %s", (unsigned)sent, path.c_str());
+  return true;
+}
+
+// Parses a single "bytes=" range into inclusive offsets. Several ranges
+// are answered with the whole file, as a multipart reply would not fit
+// the streaming model; anything malformed is ignored the same way.
+RangeResult ServerHelper::parseRange(const String &header, size_t size, size_t *start, size_t *end)
+{
+  if (!header.startsWith("bytes=") || header.indexOf(',') >= 0)
+    return RANGE_NONE;
+
+  int dash = header.indexOf('-');
+  if (dash < 0)
+    return RANGE_NONE;
+  String first = header.substring(6, dash);
+  String last = header.substring(dash + 1);
+  first.trim();
+  last.trim();
+  if (first.length() == 0 && last.length() == 0)
+    return RANGE_NONE;
+  for (size_t i = 0; i < first.length(); ++i)
+    if (!isdigit(first[i]))
+      return RANGE_NONE;
+  for (size_t i = 0; i < last.length(); ++i)
+    if (!isdigit(last[i]))
+      return RANGE_NONE;
+
+  if (first.length() == 0)
+  {
+    // "-n", the last n bytes
+    size_t n = strtoul(last.c_str(), NULL, 10);
+    if (n == 0 || size == 0)
+      return RANGE_UNSATISFIABLE;
+    *start = n < size ? size - n : 0;
+    *end = size - 1;
+    return RANGE_OK;
+  }
+
+  *start = strtoul(first.c_str(), NULL, 10);
+  *end = last.length() > 0 ? strtoul(last.c_str(), NULL, 10) : size - 1;
+  if (last.length() > 0 && *end < *start)
+    return RANGE_NONE;
+  if (*start >= size)
+    return RANGE_UNSATISFIABLE;
+  if (*end >= size)
+    *end = size - 1;
+  return RANGE_OK;
+}
+
+void ServerHelper::sendCachedFile(const CachedFile *cached, const String &contentType, bool gzip)
+{
+  if (gzip)
+    server.sendHeader("Content-Encoding", "gzip");
+  server.setContentLength(cached->size);
+  server.send(200, contentType, "");
+  server.client().write((const uint8_t *)cached->data, cached->size);
+  METRICS_SENT(cached->size);
+  LOG_DEBUG("http", "handleFileRead: sent %u bytes of %s from RAM", (unsigned)cached->size, cached->path.c_str());
+}
+
+size_t ServerHelper::startTransfer(File &file, int code, const String &contentType, size_t len)
+{
+  // the connection can take the next request once the body is out
+  bool keepAlive = server.keepAlive();
+  if (keepAlive)
+  {
+    server.sendKeepAlive(code, contentType, len);
+  }
+  else
+  {
+    server.setContentLength(len);
+    server.send(code, contentType, "");
+  }
+  WiFiClient client = server.detachClient();
+  if (!transfers.add(client, file, len, keepAlive))
+    return 0;
+  // counted now, the request is over before the body is
+  METRICS_SENT(len);
+  return len;
+}
+
+bool ServerHelper::sendAsset(const String &path)
+{
+  AssetEntry entry;
+  if (!assets.find(path.c_str(), &entry))
+    return false;
+  bool gzip = entry.flags & ASSET_GZIP;
+  bool download = server.hasArg("download");
+  const char *etagP = entry.etag;
+  PGM_P data = (PGM_P)entry.data;
+  size_t size = entry.size;
+
+  // a client without gzip, and a download, get the plain bytes: the
+  // bundle's copy, else the filesystem's, else the compressed ones as
+  // handleFileRead does for a lone .gz
+  if (gzip && (download || !acceptsGzip()))
+  {
+    if (entry.plain)
+    {
+      gzip = false;
+      etagP = entry.plainETag;
+      data = (PGM_P)entry.plain;
+      size = entry.plainSize;
+    }
+    else if (fileExists(path))
+      return false;
+  }
+
+  char etag[24];
+  char type[64];
+  strncpy_P(etag, etagP, sizeof(etag) - 1);
+  etag[sizeof(etag) - 1] = 0;
+  if (download)
+    strcpy(type, "application/octet-stream");
+  else
+    strncpy_P(type, entry.type, sizeof(type) - 1);
+  type[sizeof(type) - 1] = 0;
+
+  if (entry.flags & ASSET_GZIP)
+    server.sendHeader("Vary", "Accept-Encoding");
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", getCacheControl(path));
+  if (server.header("If-None-Match").indexOf(etag) >= 0)
+  {
+    server.send(304);
+    return true;
+  }
+
+  if (gzip)
+    server.sendHeader("Content-Encoding", "gzip");
+  server.setContentLength(size);
+  server.send(200, type, "");
+  // written straight from flash, no copy in RAM
+  size_t sent = server.client().write_P(data, size);
+  METRICS_SENT(sent);
+  LOG_DEBUG("http", "handleFileRead: sent %u bytes of %s from flash", (unsigned)sent, path.c_str());
+  return true;
+}
+
+size_t ServerHelper::streamFileRange(File &file, const String &contentType, size_t start, size_t end, bool gzip)
+{
+  // before the headers, a 206 must not go out with the wrong bytes
+  if (!file.seek(start, SeekSet))
+  {
+    server.send(500, "text/plain", "Seek failed");
+    return 0;
+  }
+
+  size_t len = end - start + 1;
+  if (gzip)
+    server.sendHeader("Content-Encoding", "gzip");
+  server.sendHeader("Content-Range", "bytes " + String((unsigned long)start) + "-" + String((unsigned long)end) + "/" +
+                                         String((unsigned long)file.size()));
+  if (canTransfer(len))
+    return startTransfer(file, 206, contentType, len);
+
+  server.setContentLength(len);
+  server.send(206, contentType, "");
+
+  WiFiClient client = server.client();
+  uint8_t buf[512];
+  size_t sent = 0;
+  while (sent < len)
+  {
+    size_t n = file.read(buf, min(sizeof(buf), len - sent));
+    if (n == 0 || client.write((const uint8_t *)buf, n) != n)
+      break;
+    sent += n;
+  }
+  METRICS_SENT(sent);
+  return sent;
 }
 
 void ServerHelper::handleFileUpload()
@@ -368,68 +1000,631 @@ void ServerHelper::handleFileUpload()
   if (server.uri() != "/upload")
     return;
   HTTPUpload &upload = server.upload();
+  String filename = upload.filename;
+  if (!filename.startsWith("/"))
+    filename = "/" + filename;
   if (upload.status == UPLOAD_FILE_START)
   {
-    String filename = upload.filename;
-    if (!filename.startsWith("/"))
-      filename = "/" + filename;
-    DBG_OUTPUT.print("handleFileUpload Name: ");
-    DBG_OUTPUT.println(filename);
-    fsUploadFile = SPIFFS.open(filename, "w");
-    filename = String();
+    LOG_INFO("fs", "handleFileUpload Name: %s", filename.c_str());
+    beginUpload(filename);
   }
   else if (upload.status == UPLOAD_FILE_WRITE)
   {
-    //DBG_OUTPUT.print("handleFileUpload Data: "); DBG_OUTPUT.println(upload.currentSize);
-    if (fsUploadFile)
-      fsUploadFile.write(upload.buf, upload.currentSize);
+    if (uploadStatus == 200)
+      writeUpload(upload.buf, upload.currentSize);
   }
   else if (upload.status == UPLOAD_FILE_END)
   {
-    if (fsUploadFile)
-      fsUploadFile.close();
-    DBG_OUTPUT.print("handleFileUpload Size: ");
-    DBG_OUTPUT.println(upload.totalSize);
+    if (uploadStatus == 200)
+      endUpload(filename, upload.totalSize);
+    else
+      discardUpload();
+    LOG_INFO("fs", "handleFileUpload Size: %u, status %d", (unsigned)upload.totalSize, uploadStatus);
+  }
+  else if (upload.status == UPLOAD_FILE_ABORTED)
+  {
+    failUpload(400, "Upload aborted");
+    discardUpload();
   }
 }
 
-void ServerHelper::handleFileDelete()
+void ServerHelper::failUpload(int status, const char *error)
 {
-  if (server.args() == 0)
-    return server.send(500, "text/plain", "BAD ARGS");
-  String path = server.arg(0);
-  DBG_OUTPUT.print("path = ");
-  DBG_OUTPUT.println(path);
-  DBG_OUTPUT.println("handleFileDelete: " + path);
-  if (path == "/")
-    return server.send(500, "text/plain", "BAD PATH");
-  if (!SPIFFS.exists(path))
-    return server.send(404, "text/plain", "FileNotFound");
-  SPIFFS.remove(path);
-  server.send(200, "text/plain", "");
-  path = String();
+  if (uploadStatus != 200)
+    return;
+  uploadStatus = status;
+  uploadError = error;
+  LOG_WARN("fs", "upload failed: %s", error);
 }
 
-void ServerHelper::createWebServer(int webtype)
+void ServerHelper::beginUpload(const String &path)
 {
+  discardUpload();
+  uploadStatus = 200;
+  uploadError = NULL;
+  uploadHash = FNV_OFFSET_BASIS;
+  uploadMD5.begin();
+
+  if (reservedPath(path))
+    return failUpload(403, "Reserved path");
+
+  // Content-Length covers the multipart framing too, so it errs on the
+  // safe side; the file being replaced gives its space back
+  FSInfo info;
+  String length = server.header("Content-Length");
+  if (length.length() > 0 && fileSystem->info(info))
+  {
+    size_t available = info.totalBytes > info.usedBytes ? info.totalBytes - info.usedBytes : 0;
+    if (fileSystem->exists(path))
+    {
+      File old = fileSystem->open(path, "r");
+      available += old.size();
+      old.close();
+    }
+    // SPIFFS needs some free blocks to garbage collect into
+    size_t reserve = 2 * info.blockSize;
+    if ((size_t)length.toInt() + reserve > available)
+      return failUpload(507, "Not enough space");
+  }
 
-  on("/networks", HTTP_GET, [&]() {
-    listNetworks();
-    server.send(200, "application/json", st);
-  });
+  uploadBufferSize = fileSystem->info(info) && info.pageSize > 0 ? info.pageSize : UPLOAD_BUFFER_SIZE;
+  uploadBuffer = new uint8_t[uploadBufferSize];
+  uploadFill = 0;
 
-  //delete file
-  on("/upload", HTTP_DELETE, [&]() {
-    handleFileDelete();
-    server.send(200, "text/plain", "Deleted\r\n");
-  });
+  fsUploadFile = fileSystem->open(UPLOAD_TEMP_PATH, "w");
+  if (!fsUploadFile)
+    failUpload(500, "Cannot create file");
+}
+
+bool ServerHelper::flushUpload(const uint8_t *data, size_t len)
+{
+  if (fsUploadFile.write(data, len) == len)
+    return true;
+  failUpload(507, "Write failed");
+  return false;
+}
+
+void ServerHelper::writeUpload(const uint8_t *data, size_t len)
+{
+  uploadHash = fnv1a(uploadHash, data, len);
+  uploadMD5.add(const_cast<uint8_t *>(data), len);
+
+  // top up a partial page first
+  if (uploadFill > 0)
+  {
+    size_t n = min(len, uploadBufferSize - uploadFill);
+    memcpy(uploadBuffer + uploadFill, data, n);
+    uploadFill += n;
+    data += n;
+    len -= n;
+    if (uploadFill < uploadBufferSize)
+      return;
+    if (!flushUpload(uploadBuffer, uploadFill))
+      return;
+    uploadFill = 0;
+  }
+
+  // whole pages go straight through, the remainder waits for more data
+  size_t direct = len - len % uploadBufferSize;
+  if (direct > 0 && !flushUpload(data, direct))
+    return;
+  memcpy(uploadBuffer, data + direct, len - direct);
+  uploadFill = len - direct;
+}
+
+void ServerHelper::endUpload(const String &path, size_t size)
+{
+  if (uploadFill > 0 && !flushUpload(uploadBuffer, uploadFill))
+    return discardUpload();
+  fsUploadFile.close();
+
+  String expected = server.header(UPLOAD_MD5_HEADER);
+  if (expected.length() > 0)
+  {
+    uploadMD5.calculate();
+    if (!expected.equalsIgnoreCase(uploadMD5.toString()))
+    {
+      failUpload(400, "MD5 mismatch");
+      return discardUpload();
+    }
+  }
+
+  // from here on a reset is finished by recoverUpload()
+  File target = fileSystem->open(UPLOAD_TARGET_PATH, "w");
+  bool recorded = target && target.print(path) == path.length();
+  target.close();
+  if (!recorded || !finishUpload(path))
+  {
+    failUpload(500, "Rename failed");
+    return discardUpload();
+  }
+
+  fileCache.remove(path);
+  updateFileTag(path, size, uploadHash);
+  saveFileTags();
+  discardUpload();
+}
+
+// Puts the verified upload in place of path. SPIFFS does not rename over
+// an existing file, so the old one is moved aside first and only removed
+// once the upload has its name; if that fails it is moved back.
+bool ServerHelper::finishUpload(const String &path)
+{
+  if (fileSystem->exists(UPLOAD_TEMP_PATH))
+  {
+    if (fileSystem->exists(path) && !fileSystem->exists(UPLOAD_BACKUP_PATH) && !fileSystem->rename(path, UPLOAD_BACKUP_PATH))
+      return false;
+    if (!fileSystem->rename(UPLOAD_TEMP_PATH, path))
+    {
+      if (fileSystem->exists(UPLOAD_BACKUP_PATH))
+        fileSystem->rename(UPLOAD_BACKUP_PATH, path);
+      return false;
+    }
+  }
+  else if (!fileSystem->exists(path) && fileSystem->exists(UPLOAD_BACKUP_PATH))
+  {
+    // the upload is gone, the old file is all there is
+    fileSystem->rename(UPLOAD_BACKUP_PATH, path);
+    return false;
+  }
+
+  fileSystem->remove(UPLOAD_BACKUP_PATH);
+  fileSystem->remove(UPLOAD_TARGET_PATH);
+  return true;
+}
+
+// Finishes an upload that was verified when the device reset, anything
+// else left behind is an incomplete upload and discarded.
+void ServerHelper::recoverUpload()
+{
+  File target = fileSystem->open(UPLOAD_TARGET_PATH, "r");
+  if (target)
+  {
+    String path = target.readString();
+    target.close();
+    if (path.startsWith("/") && !reservedPath(path))
+    {
+      if (finishUpload(path))
+        LOG_INFO("fs", "upload of %s finished after reset", path.c_str());
+      else
+        LOG_WARN("fs", "upload of %s lost in reset", path.c_str());
+      // hashed again when it is next requested
+      removeFileTag(path);
+      saveFileTags();
+    }
+  }
+  discardUpload();
+}
+
+void ServerHelper::discardUpload()
+{
+  if (fsUploadFile)
+    fsUploadFile.close();
+  if (fileSystem->exists(UPLOAD_TEMP_PATH))
+    fileSystem->remove(UPLOAD_TEMP_PATH);
+  if (fileSystem->exists(UPLOAD_TARGET_PATH))
+    fileSystem->remove(UPLOAD_TARGET_PATH);
+  delete[] uploadBuffer;
+  uploadBuffer = NULL;
+  uploadFill = 0;
+}
+
+void ServerHelper::listFiles()
+{
+  String dir = server.hasArg("dir") ? server.arg("dir") : String("/");
+  if (!dir.startsWith("/"))
+    dir = "/" + dir;
+  long offset = max(server.arg("offset").toInt(), 0L);
+  long limit = server.hasArg("limit") ? server.arg("limit").toInt() : LIST_DEFAULT_LIMIT;
+  limit = constrain(limit, 1L, (long)LIST_MAX_LIMIT);
+
+  // entries are written as they are read, nothing is collected in RAM
+  JsonWriter json(server);
+  json.begin();
+  json.beginObject();
+  json.member("dir", dir);
+  json.member("offset", offset);
+  json.key("files");
+  json.beginArray();
+
+  Dir entries = fileSystem->openDir(dir);
+  long index = 0;
+  bool more = false;
+  while (entries.next())
+  {
+    String name = entries.fileName();
+    if (reservedPath(name))
+      continue;
+    if (index++ < offset)
+      continue;
+    if (index > offset + limit)
+    {
+      more = true;
+      break;
+    }
+
+    json.beginObject();
+    json.member("name", name);
+    json.member("size", (unsigned long)entries.fileSize());
+    // only known tags, hashing every file would read the whole filesystem
+    FileTag *tag = findFileTag(name);
+    json.key("etag");
+    if (tag)
+      json.value(formatETag(*tag));
+    else
+      json.nullValue();
+    json.endObject();
+  }
+
+  json.endArray();
+  json.key("next");
+  if (more)
+    json.value(offset + limit);
+  else
+    json.nullValue();
+  json.endObject();
+  json.end();
+}
+
+void ServerHelper::handleFileRename()
+{
+  String from = server.arg("from");
+  String to = server.arg("to");
+  if (!from.startsWith("/") || !to.startsWith("/") || to == "/")
+    return server.send(400, "text/plain", "BAD ARGS");
+  if (reservedPath(from) || reservedPath(to))
+    return server.send(403, "text/plain", "Reserved path");
+  if (!fileSystem->exists(from))
+    return server.send(404, "text/plain", "FileNotFound");
+  if (fileSystem->exists(to))
+    return server.send(409, "text/plain", "File exists");
+  if (!fileSystem->rename(from, to))
+    return server.send(500, "text/plain", "Rename failed");
+  LOG_INFO("fs", "handleFileRename: %s -> %s", from.c_str(), to.c_str());
+
+  fileCache.remove(from);
+  fileCache.remove(to);
+  FileTag *tag = findFileTag(from);
+  if (tag)
+  {
+    tag->path = to;
+    saveFileTags();
+  }
+  server.send(200, "text/plain", "Renamed\r\n");
+}
+
+void ServerHelper::sendFileSystemInfo()
+{
+  FSInfo info;
+  if (!fileSystem->info(info))
+    return server.send(500, "text/plain", "No filesystem");
+
+  JsonWriter json(server);
+  json.begin();
+  json.beginObject();
+  json.member("total", (unsigned long)info.totalBytes);
+  json.member("used", (unsigned long)info.usedBytes);
+  json.member("free", (unsigned long)(info.totalBytes - info.usedBytes));
+  json.member("blockSize", (unsigned long)info.blockSize);
+  json.member("pageSize", (unsigned long)info.pageSize);
+  json.member("maxPathLength", (unsigned long)info.maxPathLength);
+  json.endObject();
+  json.end();
+}
+
+void ServerHelper::handleFileDelete()
+{
+  if (server.args() == 0)
+    return server.send(500, "text/plain", "BAD ARGS");
+  String path = server.arg(0);
+  LOG_INFO("fs", "handleFileDelete: %s", path.c_str());
+  if (path == "/")
+    return server.send(500, "text/plain", "BAD PATH");
+  if (!fileSystem->exists(path))
+    return server.send(404, "text/plain", "FileNotFound");
+  fileSystem->remove(path);
+  fileCache.remove(path);
+  if (findFileTag(path))
+  {
+    removeFileTag(path);
+    saveFileTags();
+  }
+  server.send(200, "text/plain", "");
+  path = String();
+}
+
+void ServerHelper::loadFileTags()
+{
+  fileTags.clear();
+  File file = fileSystem->open(ETAG_INDEX_PATH, "r");
+  if (!file)
+    return;
+
+  // one "<size> <hash> <path>" line per file, size and hash in hex
+  while (file.available())
+  {
+    String line = file.readStringUntil('\n');
+    int first = line.indexOf(' ');
+    int second = line.indexOf(' ', first + 1);
+    if (first <= 0 || second <= first)
+      continue;
+
+    FileTag tag;
+    tag.size = strtoul(line.substring(0, first).c_str(), NULL, 16);
+    tag.hash = strtoul(line.substring(first + 1, second).c_str(), NULL, 16);
+    tag.path = line.substring(second + 1);
+    fileTags.push_back(tag);
+  }
+  file.close();
+
+  LOG_INFO("fs", "ETag index: %u files", (unsigned)fileTags.size());
+}
+
+void ServerHelper::saveFileTags()
+{
+  File file = fileSystem->open(ETAG_INDEX_PATH, "w");
+  if (!file)
+    return;
+
+  for (size_t i = 0; i < fileTags.size(); ++i)
+  {
+    file.print(fileTags[i].size, HEX);
+    file.print(' ');
+    file.print(fileTags[i].hash, HEX);
+    file.print(' ');
+    file.print(fileTags[i].path);
+    file.print('\n');
+  }
+  file.close();
+}
+
+FileTag *ServerHelper::findFileTag(const String &path)
+{
+  for (size_t i = 0; i < fileTags.size(); ++i)
+  {
+    if (fileTags[i].path == path)
+      return &fileTags[i];
+  }
+  return NULL;
+}
+
+void ServerHelper::updateFileTag(const String &path, uint32_t size, uint32_t hash)
+{
+  FileTag *tag = findFileTag(path);
+  if (!tag)
+  {
+    fileTags.push_back(FileTag());
+    tag = &fileTags.back();
+    tag->path = path;
+  }
+  tag->size = size;
+  tag->hash = hash;
+}
+
+void ServerHelper::removeFileTag(const String &path)
+{
+  for (size_t i = 0; i < fileTags.size(); ++i)
+  {
+    if (fileTags[i].path == path)
+    {
+      fileTags.erase(fileTags.begin() + i);
+      return;
+    }
+  }
+}
+
+bool ServerHelper::fileExists(const String &path)
+{
+  // cached files are known to exist, no need to walk the filesystem; the
+  // index is not, a file can be removed behind the helper's back
+  if (fileCache.contains(path))
+    return true;
+  if (fileCache.isMissing(path))
+    return false;
+  bool exists = fileSystem->exists(path);
+  if (!exists)
+  {
+    fileCache.setMissing(path);
+    removeFileTag(path);
+  }
+  return exists;
+}
+
+String ServerHelper::fileETag(const String &path)
+{
+  File file = fileSystem->open(path, "r");
+  String etag = fileETag(path, file);
+  file.close();
+  return etag;
+}
+
+// hashes up to len bytes from the file's position
+static uint32_t hashFile(File &file, size_t len, uint32_t hash, size_t *read)
+{
+  uint8_t buf[128];
+  while (len > 0)
+  {
+    size_t n = file.read(buf, min(len, sizeof(buf)));
+    if (n == 0)
+      break;
+    hash = fnv1a(hash, buf, n);
+    *read += n;
+    len -= n;
+  }
+  return hash;
+}
+
+// The indexed tag is used while the file still has the indexed size,
+// otherwise the file was written by something else and is hashed again.
+// A large one is only sampled, a resumed download of a log must not read
+// it all from flash first. file may be closed when the contents are
+// cached. The index is kept in RAM here and saved with the next upload,
+// rename or delete, a GET does not write to the filesystem.
+String ServerHelper::fileETag(const String &path, File &file)
+{
+  FileTag *tag = findFileTag(path);
+  if (tag && (!file || tag->size == file.size()))
+    return formatETag(*tag);
+
+  File own;
+  File &source = file ? file : (own = fileSystem->open(path, "r"));
+  if (!source)
+    return String();
+
+  uint32_t hash = FNV_OFFSET_BASIS;
+  size_t size = 0;
+  size_t total = source.size();
+  if (total <= ETAG_HASH_MAX)
+  {
+    hash = hashFile(source, total, hash, &size);
+  }
+  else
+  {
+    size_t sampled = 0;
+    hash = hashFile(source, ETAG_SAMPLE, hash, &sampled);
+    if (source.seek(total - ETAG_SAMPLE, SeekSet))
+      hash = hashFile(source, ETAG_SAMPLE, hash, &sampled);
+    size = total;
+  }
+  if (own)
+    own.close();
+  else
+    file.seek(0);
+
+  updateFileTag(path, size, hash);
+  return formatETag(*findFileTag(path));
+}
+
+void ServerHelper::fileWritten(const String &path)
+{
+  fileCache.remove(path);
+  if (!findFileTag(path))
+    return;
+  // also from the saved index, or the next boot would bring it back
+  removeFileTag(path);
+  saveFileTags();
+}
+
+String ServerHelper::formatETag(const FileTag &tag)
+{
+  String etag = "\"";
+  etag += String(tag.size, HEX);
+  etag += "-";
+  etag += String(tag.hash, HEX);
+  etag += "\"";
+  return etag;
+}
+
+void ServerHelper::setCacheControl(const String &extension, uint32_t maxAge)
+{
+  for (size_t i = 0; i < cacheRules.size(); ++i)
+  {
+    if (cacheRules[i].extension == extension)
+    {
+      cacheRules[i].maxAge = maxAge;
+      return;
+    }
+  }
+  CacheRule rule;
+  rule.extension = extension;
+  rule.maxAge = maxAge;
+  cacheRules.push_back(rule);
+}
+
+void ServerHelper::setCacheControl(uint32_t maxAge)
+{
+  defaultMaxAge = maxAge;
+}
+
+String ServerHelper::getCacheControl(const String &path)
+{
+  String name = path;
+  if (name.endsWith(".gz"))
+    name = name.substring(0, name.length() - 3);
+
+  uint32_t maxAge = defaultMaxAge;
+  for (size_t i = 0; i < cacheRules.size(); ++i)
+  {
+    if (name.endsWith("." + cacheRules[i].extension))
+    {
+      maxAge = cacheRules[i].maxAge;
+      break;
+    }
+  }
+
+  // without a max-age the browser revalidates with If-None-Match
+  if (maxAge == 0)
+    return "no-cache";
+  return "max-age=" + String(maxAge);
+}
+
+void ServerHelper::createWebServer(int webtype)
+{
+  if (sessionMode)
+  {
+    // reachable without credentials, they are what /login checks
+    routes.add(new MyRequestHandler([]() { return true; }, [&]() { handleLogin(); }, []() {}, "/login", HTTP_POST));
+    routes.add(new MyRequestHandler([]() { return true; }, [&]() { handleLogout(); }, []() {}, "/logout", HTTP_POST));
+  }
+
+  on("/networks", HTTP_GET, [&]() {
+    listNetworks();
+  });
+
+  on("/events", HTTP_GET, [&]() {
+    subscribeEvents();
+  });
+
+#if SERVERHELPER_METRICS
+  on("/metrics", HTTP_GET, [&]() {
+    if (server.arg("format") == "json")
+    {
+      JsonWriter json(server);
+      json.begin();
+      ServerMetrics.printJson(json);
+      json.end();
+      return;
+    }
+    // JsonWriter doubles as a chunked writer for the text format
+    JsonWriter text(server);
+    text.begin(200, "text/plain; version=0.0.4");
+    ServerMetrics.printPrometheus(text);
+    text.end();
+  });
+#endif
+
+  on("/list", HTTP_GET, [&]() {
+    listFiles();
+  });
+
+  on("/rename", HTTP_POST, [&]() {
+    handleFileRename();
+  });
+
+  on("/fsinfo", HTTP_GET, [&]() {
+    sendFileSystemInfo();
+  });
+
+  //delete file
+  on("/upload", HTTP_DELETE, [&]() {
+    handleFileDelete();
+    server.send(200, "text/plain", "Deleted\r\n");
+  });
 
   //first callback is called after the request has ended with all parsed arguments
   //second callback handles file uploads at that location
-  on("/upload", HTTP_POST, [&]() { server.send(200, "text/plain", "Uploaded\r\n"); }, [&]() { handleFileUpload(); });
+  on("/upload", HTTP_POST, [&]() {
+    if (uploadStatus == 200)
+      server.send(200, "text/plain", "Uploaded\r\n");
+    else
+      server.send(uploadStatus, "text/plain", String(uploadError) + "\r\n");
+  }, [&]() { handleFileUpload(); });
 
   on("/cleareeprom", [&]() {
     clearEEPROM();
+    if (settings.isOpen())
+      settings.remove(CONFIG_KEY);
+    resetConfig();
     server.send(200, "text/plain", "EEPROM is cleared\r\n");
   });
 
@@ -451,6 +1646,9 @@ void ServerHelper::createWebServer(int webtype)
 
     String v_todo = server.arg("todo");
 
+    // stage every change and write the flash sector once
+    beginConfig();
+
     if (v_ssid.length() > 0 && v_pass.length() > 0)
     {
       write_ssid_and_pass(v_ssid, v_pass);
@@ -482,19 +1680,26 @@ void ServerHelper::createWebServer(int webtype)
       result |= ConfigMode::NAME;
     }
 
-    content = "{\"result\":";
-    content += result;
-    content += "}\r\n";
-    server.send(200, "application/json", content);
+    commitConfig();
 
-    if (v_todo.length() > 0)
-    {
-      if (v_todo.equals("reboot"))
-      {
-        delay(3000);
-        ESP.restart();
-      }
-    }
+    JsonWriter json(server);
+    json.begin();
+    json.beginObject();
+    json.member("result", result);
+    json.endObject();
+    json.end();
+
+    // restarted from loop() once the response is out
+    if (v_todo.equals("reboot"))
+      restartAt = millis() + CONFIG_RESTART_DELAY;
+  });
+
+  on("/config", HTTP_GET, [&]() {
+    sendConfig();
+  });
+
+  on("/config", HTTP_PATCH, [&]() {
+    patchConfig();
   });
 
   if (webtype == 1)
@@ -518,18 +1723,116 @@ bool ServerHelper::checkAuthentication()
   if (!authMode)
     return true;
 
-  if (!server.authenticate(www_username.c_str(), www_password.c_str()))
+  // a signed session stays valid while its address is locked out
+  if (sessionMode && auth.validateCookie(server.header("Cookie").c_str()))
+    return true;
+
+  // answered already, e.g. at the start of an upload
+  if (authRejected)
+    return false;
+
+  uint32_t ip = server.client().remoteIP();
+  if (lockedOut(ip))
   {
-    server.requestAuthentication();
+    authRejected = true;
     return false;
   }
 
+  // precomputed digest of the whole header, nothing is decoded
+  String authorization = server.header("Authorization");
+  if (authorization.length() > 0)
+  {
+    if (auth.checkBasic(authorization.c_str()))
+    {
+      auth.succeeded(ip);
+      return true;
+    }
+    auth.failed(ip);
+  }
+
+  authRejected = true;
+  server.requestAuthentication();
+  METRICS_RESPONSE(401);
+  return false;
+}
+
+void ServerHelper::subscribeEvents()
+{
+  if (events.clients() >= EVENT_MAX_CLIENTS)
+    return server.send(503, "text/plain", "Too many subscribers");
+
+  // the stream stays open, loop() writes to it from now on
+  WiFiClient client = server.detachClient();
+  if (!events.subscribe(client))
+  {
+    // no memory for the queue
+    METRICS_RESPONSE(503);
+    client.print("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    client.stop();
+    return;
+  }
+  METRICS_RESPONSE(200);
+  LOG_DEBUG("http", "events: %d subscribers", events.clients());
+}
+
+void ServerHelper::useSessionAuth(uint32_t lifetime)
+{
+  sessionMode = true;
+  auth.setLifetime(lifetime);
+  auth.begin();
+}
+
+void ServerHelper::setCredentials(const String &user, const String &pass)
+{
+  www_username = user;
+  www_password = pass;
+  auth.setCredentials(user.c_str(), pass.c_str());
+}
+
+bool ServerHelper::lockedOut(uint32_t ip)
+{
+  uint32_t wait = auth.lockedFor(ip);
+  if (!wait)
+    return false;
+  server.sendHeader("Retry-After", String(wait));
+  server.send(429, "text/plain", "Too many failed logins");
   return true;
 }
 
+void ServerHelper::handleLogin()
+{
+  uint32_t ip = server.client().remoteIP();
+  if (lockedOut(ip))
+    return;
+
+  if (!auth.checkLogin(server.arg("username").c_str(), server.arg("password").c_str()))
+  {
+    auth.failed(ip);
+    LOG_WARN("auth", "login failed from %s", server.client().remoteIP().toString().c_str());
+    return server.send(401, "text/plain", "Login failed");
+  }
+  auth.succeeded(ip);
+
+  char token[SESSION_TOKEN_SIZE + 1];
+  auth.issue(token);
+  String cookie = SESSION_COOKIE "=";
+  cookie += token;
+  cookie += "; Path=/; HttpOnly; SameSite=Strict; Max-Age=";
+  cookie += auth.lifetime();
+  server.sendHeader("Set-Cookie", cookie);
+  server.send(200, "text/plain", "OK\r\n");
+}
+
+void ServerHelper::handleLogout()
+{
+  // tokens are not stored, the browser is told to forget its own
+  server.sendHeader("Set-Cookie", SESSION_COOKIE "=; Path=/; HttpOnly; SameSite=Strict; Max-Age=0");
+  server.send(200, "text/plain", "OK\r\n");
+}
+
 void ServerHelper::on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn, ESP8266WebServer::THandlerFunction ufn)
 {
-  server.addHandler(new MyRequestHandler([&]() { return checkAuthentication(); }, fn, ufn, uri, method));
+  routes.add(new MyRequestHandler([&]() { return checkAuthentication(); }, fn, ufn, uri, method));
 }
 
 void ServerHelper::on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn)
@@ -542,112 +1845,483 @@ void ServerHelper::on(const String &uri, ESP8266WebServer::THandlerFunction hand
   on(uri, HTTP_ANY, handler);
 }
 
-bool ServerHelper::read_ssid_and_pass(String *essid, String *epass)
+int ServerHelper::pathArgs()
+{
+  return routes.pathArgs();
+}
+
+String ServerHelper::pathArg(int i)
+{
+  return routes.pathArg(i);
+}
+
+String ServerHelper::pathArg(const String &name)
+{
+  return routes.pathArg(name);
+}
+
+static void copyField(char *dst, size_t size, const String &src)
 {
-  // read eeprom for ssid and pass
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: READ");
-  DBG_OUTPUT.print("SSID:\t");
-  readEEPROM(E_SSID_ADDR, essid, E_SSID_SIZE);
-  DBG_OUTPUT.print("PASS:\t");
-  readEEPROM(E_PASS_ADDR, epass, E_PASS_SIZE);
-  DBG_OUTPUT.println();
+  memset(dst, 0, size);
+  strncpy(dst, src.c_str(), size - 1);
+}
 
-  if (essid->c_str()[0] != 0 && epass->c_str()[0] != 0)
+bool ServerHelper::useSettingsStore(uint32_t firstSector, uint16_t sectorCount)
+{
+  bool isOk = settings.begin(firstSector, sectorCount);
+  if (isOk)
+    LOG_INFO("cfg", "SETTINGS STORE OK");
+  else
+    LOG_ERROR("cfg", "SETTINGS STORE FAILED");
+  return isOk;
+}
+
+bool ServerHelper::loadConfig()
+{
+  if (settings.isOpen() && settings.get(CONFIG_KEY, &config, sizeof(config)) == sizeof(config) && configValid(config))
+    return true;
+
+  EEPROM.get(CONFIG_ADDR, config);
+  if (configValid(config))
   {
+    // first boot on the settings store, take the EEPROM record over
+    if (settings.isOpen())
+    {
+      configDirty = true;
+      commitConfig();
+    }
     return true;
   }
+
+  if (config.magic == CONFIG_MAGIC)
+  {
+    // our record, damaged; what is under it is no longer the old layout
+    LOG_WARN("cfg", "CONFIG CORRUPT, using defaults");
+    resetConfig();
+    saveConfig();
+    return false;
+  }
+
+  migrateConfig();
   return false;
 }
 
+static void readLegacyField(int addr, char *dst, int len)
+{
+  // unused records are zero filled, or 0xFF on a fresh sector
+  for (int i = 0; i < len; ++i)
+  {
+    uint8_t ch = EEPROM.read(addr + i);
+    if (ch == 0 || ch == 0xFF)
+      break;
+    dst[i] = ch;
+  }
+}
+
+static uint32_t readLegacyAddress(int addr)
+{
+  char str[E_IP_SIZE + 1] = {0};
+  IPAddress ip;
+  readLegacyField(addr, str, E_IP_SIZE);
+  if (!ip.fromString(str))
+    return 0;
+  return (uint32_t)ip;
+}
+
+void ServerHelper::migrateConfig()
+{
+  // anything that is not a valid record is the fixed-width ASCII layout
+  // of earlier versions, or an empty EEPROM
+  resetConfig();
+  readLegacyField(E_NAME_ADDR, config.name, E_NAME_SIZE);
+  readLegacyField(E_SSID_ADDR, config.ssid, E_SSID_SIZE);
+  readLegacyField(E_PASS_ADDR, config.pass, E_PASS_SIZE);
+  readLegacyField(E_AUSER_ADDR, config.user, E_AUSER_SIZE);
+  readLegacyField(E_APASS_ADDR, config.userPass, E_APASS_SIZE);
+
+  config.ip = readLegacyAddress(E_IP_ADDR);
+  config.gateway = readLegacyAddress(E_GATEWAY_ADDR);
+  config.subnet = readLegacyAddress(E_SUBNET_ADDR);
+  config.dns = readLegacyAddress(E_DNS_ADDR);
+  if (!config.ip || !config.gateway || !config.subnet || !config.dns)
+    config.ip = config.gateway = config.subnet = config.dns = 0;
+
+  for (int i = 0; i < E_BSSID_SIZE; ++i)
+    config.bssid[i] = EEPROM.read(E_BSSID_ADDR + i);
+  config.channel = EEPROM.read(E_CHANNEL_ADDR);
+  if (config.channel < 1 || config.channel > 14)
+  {
+    memset(config.bssid, 0, sizeof(config.bssid));
+    config.channel = 0;
+  }
+
+  // the record overlaps the legacy area, clear what it does not cover
+  for (int i = CONFIG_ADDR + sizeof(config); i < E_END_ADDR; ++i)
+    EEPROM.write(i, 0);
+  saveConfig();
+  LOG_INFO("cfg", "CONFIG MIGRATED");
+}
+
+void ServerHelper::resetConfig()
+{
+  memset(&config, 0, sizeof(config));
+  config.magic = CONFIG_MAGIC;
+  config.version = CONFIG_VERSION;
+  config.size = sizeof(config);
+}
+
+void ServerHelper::saveConfig()
+{
+  configDirty = true;
+  if (!configStaging)
+    commitConfig();
+}
+
+void ServerHelper::beginConfig()
+{
+  configStaging = true;
+}
+
+bool ServerHelper::commitConfig()
+{
+  configStaging = false;
+  if (!configDirty)
+    return true;
+
+  config.crc = SettingsStore::crc32(0, &config, offsetof(ConfigRecord, crc));
+  configDirty = false;
+
+  if (settings.isOpen())
+  {
+    bool isOk = settings.put(CONFIG_KEY, &config, sizeof(config));
+    if (isOk)
+      LOG_INFO("cfg", "FLASH: CONFIG SAVED");
+    else
+      LOG_ERROR("cfg", "FLASH: CONFIG SAVE FAILED");
+    return isOk;
+  }
+
+  EEPROM.put(CONFIG_ADDR, config);
+  bool isOk = EEPROM.commit();
+  if (isOk)
+    LOG_INFO("cfg", "EEPROM: CONFIG SAVED");
+  else
+    LOG_ERROR("cfg", "EEPROM: CONFIG SAVE FAILED");
+  return isOk;
+}
+
+static void ipMember(JsonWriter &json, const char *name, uint32_t ip)
+{
+  json.key(name);
+  if (ip)
+    json.value(IPAddress(ip).toString());
+  else
+    json.nullValue();
+}
+
+void ServerHelper::sendConfig()
+{
+  JsonWriter json(server);
+  json.begin();
+  json.beginObject();
+  json.member("name", (const char *)config.name);
+  json.member("ssid", (const char *)config.ssid);
+  // secrets are never sent, null in a PATCH keeps them as they are
+  json.key("pass");
+  json.nullValue();
+  json.member("user", (const char *)config.user);
+  json.key("userPass");
+  json.nullValue();
+  ipMember(json, "ip", config.ip);
+  ipMember(json, "gateway", config.gateway);
+  ipMember(json, "subnet", config.subnet);
+  ipMember(json, "dns", config.dns);
+  json.endObject();
+  json.end();
+}
+
+static bool setField(char *dst, size_t size, const String &key, const String &value, JsonType type, bool secret, String &error)
+{
+  if (type == JSON_NULL && secret)
+    return true;
+  if (type != JSON_STRING)
+    error = key + ": string expected";
+  else if (value.length() > size - 1)
+    error = key + ": longer than " + String(size - 1);
+  else
+    copyField(dst, size, value);
+  return error.length() == 0;
+}
+
+static bool setAddress(uint32_t *dst, const String &key, const String &value, JsonType type, String &error)
+{
+  IPAddress ip;
+  if (type == JSON_NULL || (type == JSON_STRING && value.length() == 0))
+    *dst = 0;
+  else if (type == JSON_STRING && ip.fromString(value))
+    *dst = ip;
+  else
+    error = key + ": address expected";
+  return error.length() == 0;
+}
+
+bool ServerHelper::parseConfig(const String &body, ConfigRecord &next, String &error)
+{
+  JsonReader json(body.c_str());
+  String key, value;
+  JsonType type;
+  bool isOk = true;
+  while (isOk && json.next(key, value, type))
+  {
+    if (key == "name")
+      isOk = setField(next.name, sizeof(next.name), key, value, type, false, error);
+    else if (key == "ssid")
+      isOk = setField(next.ssid, sizeof(next.ssid), key, value, type, false, error);
+    else if (key == "pass")
+      isOk = setField(next.pass, sizeof(next.pass), key, value, type, true, error);
+    else if (key == "user")
+      isOk = setField(next.user, sizeof(next.user), key, value, type, false, error);
+    else if (key == "userPass")
+      isOk = setField(next.userPass, sizeof(next.userPass), key, value, type, true, error);
+    else if (key == "ip")
+      isOk = setAddress(&next.ip, key, value, type, error);
+    else if (key == "gateway")
+      isOk = setAddress(&next.gateway, key, value, type, error);
+    else if (key == "subnet")
+      isOk = setAddress(&next.subnet, key, value, type, error);
+    else if (key == "dns")
+      isOk = setAddress(&next.dns, key, value, type, error);
+    else
+    {
+      error = key + ": unknown setting";
+      isOk = false;
+    }
+  }
+  if (json.failed())
+  {
+    error = json.error();
+    return false;
+  }
+  if (!isOk)
+    return false;
+
+  // the record as a whole, not only the members that were sent
+  if (next.ip && (!next.gateway || !next.subnet))
+    error = "a static ip needs gateway and subnet";
+  else if (!next.user[0] != !next.userPass[0])
+    error = "user and userPass are set together";
+  else if (!next.ssid[0] != !next.pass[0])
+    error = "ssid and pass are set together";
+  if (error.length() > 0)
+    return false;
+
+  // DHCP keeps no addresses of the static setup it replaced
+  if (!next.ip)
+    next.gateway = next.subnet = next.dns = 0;
+  else if (!next.dns)
+    next.dns = next.gateway;
+  return true;
+}
+
+int ServerHelper::configChanges(const ConfigRecord &next)
+{
+  int changes = 0;
+  if (strcmp(next.name, config.name) != 0)
+    changes |= ConfigMode::NAME;
+  if (strcmp(next.ssid, config.ssid) != 0 || strcmp(next.pass, config.pass) != 0)
+    changes |= ConfigMode::SSID_PASS;
+  if (strcmp(next.user, config.user) != 0 || strcmp(next.userPass, config.userPass) != 0)
+    changes |= ConfigMode::USER_PASS;
+  if (next.ip != config.ip || next.gateway != config.gateway || next.subnet != config.subnet || next.dns != config.dns)
+    changes |= ConfigMode::IPV4;
+  return changes;
+}
+
+void ServerHelper::patchConfig()
+{
+  // checked as a whole on a copy, nothing changes unless all of it is valid
+  ConfigRecord next = config;
+  String error;
+  if (!parseConfig(server.arg("plain"), next, error))
+    return server.send(400, "text/plain", error + "\r\n");
+
+  int changes = configChanges(next);
+  if (changes & ConfigMode::SSID_PASS)
+  {
+    // the remembered access point belongs to the old network
+    memset(next.bssid, 0, sizeof(next.bssid));
+    next.channel = 0;
+  }
+  if (changes)
+  {
+    config = next;
+    saveConfig();
+  }
+
+  if (changes & ConfigMode::USER_PASS)
+  {
+    if (config.user[0])
+      setCredentials(config.user, config.userPass);
+    else
+      setCredentials("admin", "admin");
+  }
+
+  // the OTA and mDNS hostname is only taken at start, as is a first
+  // network joined from the access point
+  bool stationMode = wifiState == WIFI_STATE_CONNECTED || wifiState == WIFI_STATE_RECONNECTING;
+  bool restart = (changes & ConfigMode::NAME) || ((changes & ConfigMode::SSID_PASS) && !stationMode);
+  if (restart)
+  {
+    restartAt = millis() + CONFIG_RESTART_DELAY;
+  }
+  else if (changes & (ConfigMode::SSID_PASS | ConfigMode::IPV4))
+  {
+    // after the response, the client may lose the connection
+    configPending |= changes & (ConfigMode::SSID_PASS | ConfigMode::IPV4);
+    configApplyAt = millis() + CONFIG_APPLY_DELAY;
+  }
+
+  JsonWriter json(server);
+  json.begin();
+  json.beginObject();
+  json.member("result", changes);
+  json.member("restart", restart);
+  json.endObject();
+  json.end();
+}
+
+void ServerHelper::applyConfig()
+{
+  int changes = configPending;
+  configPending = 0;
+
+  if (changes & ConfigMode::IPV4)
+  {
+    // the 2.4.2 core starts DHCP again only when ip, gateway and subnet are
+    // all zero, an ip of zero alone is taken as a static address
+    if (config.ip)
+      WiFi.config(IPAddress(config.ip), IPAddress(config.gateway), IPAddress(config.subnet), IPAddress(config.dns));
+    else
+      WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    LOG_INFO("cfg", "IP applied: %s", IPAddress(config.ip).toString().c_str());
+  }
+
+  if (changes & ConfigMode::SSID_PASS)
+  {
+    // handled like a join at boot: a network that cannot be joined
+    // within wifiConnectTimeout opens the AP instead of retrying forever
+    LOG_INFO("cfg", "joining %s", config.ssid);
+    WiFi.begin(config.ssid, config.pass);
+    wifiConnectStart = millis();
+    wifiFastConnect = false;
+    setWifiState(WIFI_STATE_CONNECTING);
+  }
+}
+
+bool ServerHelper::read_ssid_and_pass(String *essid, String *epass)
+{
+  *essid = config.ssid;
+  *epass = config.pass;
+
+  LOG_DEBUG("cfg", "SSID: %s", config.ssid);
+
+  return config.ssid[0] != 0 && config.pass[0] != 0;
+}
+
 void ServerHelper::write_ssid_and_pass(String ssid, String pass)
 {
-  clearEEPROM(E_AP_ADDR, E_AP_SIZE);
+  copyField(config.ssid, sizeof(config.ssid), ssid);
+  copyField(config.pass, sizeof(config.pass), pass);
+  // the remembered access point belongs to the old network
+  memset(config.bssid, 0, sizeof(config.bssid));
+  config.channel = 0;
 
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: WRITE");
-  DBG_OUTPUT.print("SSID:\t");
-  writeEEPROM(E_SSID_ADDR, ssid, E_SSID_SIZE);
-  DBG_OUTPUT.print("PASS:\t");
-  writeEEPROM(E_PASS_ADDR, pass, E_PASS_SIZE);
-  DBG_OUTPUT.println();
+  LOG_INFO("cfg", "SSID: %s", config.ssid);
 
-  EEPROM.commit();
+  saveConfig();
+}
+
+bool ServerHelper::read_bssid_and_channel(uint8_t *bssid, int32_t *channel)
+{
+  bool isSet = false;
+  for (int i = 0; i < E_BSSID_SIZE; ++i)
+  {
+    bssid[i] = config.bssid[i];
+    if (bssid[i])
+      isSet = true;
+  }
+  *channel = config.channel;
+
+  return isSet && *channel >= 1 && *channel <= 14;
+}
+
+void ServerHelper::write_bssid_and_channel(const uint8_t *bssid, int32_t channel)
+{
+  if (!bssid)
+    return;
+
+  // an unchanged access point costs no flash write
+  if (memcmp(config.bssid, bssid, E_BSSID_SIZE) == 0 && config.channel == channel)
+    return;
+
+  memcpy(config.bssid, bssid, E_BSSID_SIZE);
+  config.channel = channel;
+  saveConfig();
 }
 
 bool ServerHelper::read_ipv4(IPAddress *ip, IPAddress *gateway, IPAddress *subnet, IPAddress *dns)
 {
-  String s_ip, s_gateway, s_subnet, s_dns;
-
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: READ");
-  DBG_OUTPUT.print("IP:\t\t");
-  readEEPROM(E_IP_ADDR, &s_ip, E_IP_SIZE);
-  DBG_OUTPUT.print("GATEWAY:\t\t");
-  readEEPROM(E_GATEWAY_ADDR, &s_gateway, E_IP_SIZE);
-  DBG_OUTPUT.print("SUBNET:\t\t");
-  readEEPROM(E_SUBNET_ADDR, &s_subnet, E_IP_SIZE);
-  DBG_OUTPUT.print("DNS:\t\t");
-  readEEPROM(E_DNS_ADDR, &s_dns, E_IP_SIZE);
-  DBG_OUTPUT.println();
-
-  bool isOk = ip->fromString(s_ip) && gateway->fromString(s_gateway) && subnet->fromString(s_subnet) && dns->fromString(s_dns);
-  return isOk;
+  *ip = config.ip;
+  *gateway = config.gateway;
+  *subnet = config.subnet;
+  *dns = config.dns;
+
+  LOG_DEBUG("cfg", "IP: %s", ip->toString().c_str());
+
+  return config.ip != 0;
 }
 
 void ServerHelper::write_ipv4(String ip, String gateway, String subnet, String dns)
 {
-  clearEEPROM(E_IPV4_ADDR, E_IPV4_SIZE);
+  IPAddress v_ip, v_gateway, v_subnet, v_dns;
+
+  if (v_ip.fromString(ip) && v_gateway.fromString(gateway) && v_subnet.fromString(subnet) && v_dns.fromString(dns))
+  {
+    config.ip = v_ip;
+    config.gateway = v_gateway;
+    config.subnet = v_subnet;
+    config.dns = v_dns;
+  }
+  else
+  {
+    config.ip = config.gateway = config.subnet = config.dns = 0;
+  }
 
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: WRITE");
-  DBG_OUTPUT.print("IP:\t\t");
-  writeEEPROM(E_IP_ADDR, ip, E_IP_SIZE);
-  DBG_OUTPUT.print("GATEWAY:\t");
-  writeEEPROM(E_GATEWAY_ADDR, gateway, E_IP_SIZE);
-  DBG_OUTPUT.print("SUBNET:\t\t");
-  writeEEPROM(E_SUBNET_ADDR, subnet, E_IP_SIZE);
-  DBG_OUTPUT.print("DNS:\t\t");
-  writeEEPROM(E_DNS_ADDR, dns, E_IP_SIZE);
-  DBG_OUTPUT.println();
+  LOG_INFO("cfg", "IP: %s", ip.c_str());
 
-  EEPROM.commit();
+  saveConfig();
 }
 
 bool ServerHelper::read_user_and_pass()
 {
-  String user, pass;
-
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: READ");
-  DBG_OUTPUT.print("USER:\t");
-  readEEPROM(E_AUSER_ADDR, &user, E_AUSER_SIZE);
-  DBG_OUTPUT.print("PASS:\t");
-  readEEPROM(E_APASS_ADDR, &pass, E_APASS_SIZE);
-  DBG_OUTPUT.println();
+  LOG_DEBUG("cfg", "USER: %s", config.user);
 
-  bool isOk = (user.c_str()[0] && pass.c_str()[0]);
+  bool isOk = (config.user[0] && config.userPass[0]);
   if (isOk)
   {
-    www_username = user;
-    www_password = pass;
+    setCredentials(config.user, config.userPass);
   }
   return isOk;
 }
 
 void ServerHelper::write_user_and_pass(String user, String pass)
 {
-  clearEEPROM(E_AUTH_ADDR, E_AUTH_SIZE);
+  copyField(config.user, sizeof(config.user), user);
+  copyField(config.userPass, sizeof(config.userPass), pass);
 
-  DBG_OUTPUT.println();
-  DBG_OUTPUT.println("> EEPROM: WRITE");
-  DBG_OUTPUT.print("USER:\t");
-  writeEEPROM(E_AUSER_ADDR, user, E_AUSER_SIZE);
-  DBG_OUTPUT.print("PASS:\t");
-  writeEEPROM(E_APASS_ADDR, pass, E_APASS_SIZE);
-  DBG_OUTPUT.println();
+  LOG_INFO("cfg", "USER: %s", config.user);
 
-  EEPROM.commit();
+  saveConfig();
 }
 
 void ServerHelper::set_ap_ssid_and_pass(String ssid, String pass)
@@ -658,17 +2332,18 @@ void ServerHelper::set_ap_ssid_and_pass(String ssid, String pass)
 
 void ServerHelper::read_device_name()
 {
-  readEEPROM(E_NAME_ADDR, &deviceName, E_NAME_SIZE);
+  deviceName = config.name;
 }
 
 void ServerHelper::write_device_name(String name)
 {
   deviceName = name;
-  clearEEPROM(E_NAME_ADDR, E_NAME_SIZE);
-  if (name.length() > 0 && name.length() <= E_NAME_SIZE)
-    writeEEPROM(E_NAME_ADDR, name, E_NAME_SIZE);
+  if (name.length() <= E_NAME_SIZE)
+    copyField(config.name, sizeof(config.name), name);
+  else
+    config.name[0] = 0;
 
-  EEPROM.commit();
+  saveConfig();
 }
 
 void ServerHelper::active_auth_mode()
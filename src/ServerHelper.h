@@ -11,6 +11,22 @@
 #include <EEPROM.h>
 #include <FS.h>
 #include <ArduinoOTA.h>
+#include <MD5Builder.h>
+#include <vector>
+
+#include "AssetBundle.h"
+#include "EventStream.h"
+#include "FileCache.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include "LoopProfiler.h"
+#include "Metrics.h"
+#include "RouteDispatcher.h"
+#include "SessionAuth.h"
+#include "SettingsStore.h"
+#include "TelnetConsole.h"
+#include "TransferPool.h"
 
 
 #define E_SSID_SIZE       32
@@ -19,7 +35,13 @@
 #define E_APASS_SIZE      32
 #define E_IP_SIZE         16
 #define E_NAME_SIZE       32
+#define E_BSSID_SIZE      6
+#define E_CHANNEL_SIZE    1
 
+#define E_EEPROM_SIZE     512
+
+// Legacy layout: fixed-width ASCII records at the E_*_ADDR offsets.
+// It is only read to migrate into ConfigRecord, see loadConfig().
 #define E_START_ADDR      0
 #define E_START_SIZE      32
 
@@ -33,7 +55,10 @@
 #define E_SUBNET_ADDR     E_GATEWAY_ADDR +   E_IP_SIZE
 #define E_DNS_ADDR        E_SUBNET_ADDR  +   E_IP_SIZE
 
-#define E_END_ADDR        E_DNS_ADDR     +   E_IP_SIZE 
+#define E_BSSID_ADDR      E_DNS_ADDR     +   E_IP_SIZE
+#define E_CHANNEL_ADDR    E_BSSID_ADDR   +   E_BSSID_SIZE
+
+#define E_END_ADDR        E_CHANNEL_ADDR +   E_CHANNEL_SIZE
 
 #define E_IPV4_ADDR       E_IP_ADDR
 #define E_IPV4_SIZE       (E_IP_SIZE * 4)
@@ -44,6 +69,117 @@
 #define E_AP_ADDR         E_SSID_ADDR
 #define E_AP_SIZE         (E_SSID_SIZE + E_PASS_SIZE)
 
+#define CONFIG_ADDR       0
+#define CONFIG_MAGIC      0x46434853UL    // "SHCF"
+#define CONFIG_VERSION    1
+// key of the ConfigRecord when the settings store is used
+#define CONFIG_KEY        "cfg"
+// ms after a PATCH /config response before network changes are applied
+#define CONFIG_APPLY_DELAY   500
+// ms after the response before a restart that a change needs
+#define CONFIG_RESTART_DELAY 1000
+
+// Settings kept in EEPROM or the settings store, read and written as one block.
+// Strings are zero terminated, an address of 0 means DHCP.
+struct ConfigRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    char name[E_NAME_SIZE + 1];
+    char ssid[E_SSID_SIZE + 1];
+    char pass[E_PASS_SIZE + 1];
+    char user[E_AUSER_SIZE + 1];
+    char userPass[E_APASS_SIZE + 1];
+    uint8_t bssid[E_BSSID_SIZE];
+    uint8_t channel;
+    uint32_t crc;
+};
+
+// sidecar index of file sizes and content hashes used for ETags
+#define ETAG_INDEX_PATH   "/.etags"
+// a file not indexed at upload is hashed whole up to this size; above it
+// only its first and last ETAG_SAMPLE bytes are, with the size
+#define ETAG_HASH_MAX     8192
+#define ETAG_SAMPLE       256
+
+// uploads are written here and renamed once complete and verified
+#define UPLOAD_TEMP_PATH  "/.upload"
+// the file being replaced, until the upload is in its place
+#define UPLOAD_BACKUP_PATH "/.upload.old"
+// target path of a verified upload, lets the next boot finish the rename
+#define UPLOAD_TARGET_PATH "/.upload.to"
+// optional request header with the hex MD5 of the uploaded file
+#define UPLOAD_MD5_HEADER "X-Content-MD5"
+// page size of /list, default and upper bound
+#define LIST_DEFAULT_LIMIT 50
+#define LIST_MAX_LIMIT     200
+
+// write size when the filesystem does not report its page size
+#define UPLOAD_BUFFER_SIZE 256
+
+enum RangeResult
+{
+    RANGE_NONE,
+    RANGE_OK,
+    RANGE_UNSATISFIABLE
+};
+
+struct FileTag
+{
+    String path;
+    uint32_t size;
+    uint32_t hash;
+};
+
+// file extension (lower case, without the dot) to MIME type
+struct MimeType
+{
+    const char *extension;
+    const char *type;
+};
+
+// version of the /networks JSON document
+#define NETWORKS_SCHEMA_VERSION   2
+// a cached scan older than this is refreshed in the background (ms)
+#define NETWORKS_MAX_AGE          60000
+
+// station connection is given up after this long (ms)
+#define WIFI_CONNECT_TIMEOUT      10000
+// a direct connect to the remembered BSSID and channel gets this long (ms)
+#define WIFI_FAST_CONNECT_TIMEOUT 3000
+// reconnect attempts after a drop back off from min to max (ms)
+#define WIFI_RETRY_MIN            1000
+#define WIFI_RETRY_MAX            60000
+
+enum WifiState
+{
+    WIFI_STATE_IDLE,
+    WIFI_STATE_CONNECTING,
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_RECONNECTING,
+    WIFI_STATE_FAILED,
+    WIFI_STATE_AP
+};
+
+struct NetworkInfo
+{
+    String ssid;
+    int32_t rssi;
+    int32_t channel;
+    bool encrypted;
+};
+
+struct CacheRule
+{
+    String extension;
+    uint32_t maxAge;
+};
+
 class ServerHelper
 {
   public:
@@ -54,43 +190,185 @@ class ServerHelper
 
     // Create an instance of the server
     // specify the port to listen on as an argument
-    ESP8266WebServer server;
+    MeteredWebServer server;
 
-    WiFiServer TelnetServer;
-    WiFiClient Telnet;
+    // routes registered through on()
+    RouteDispatcher routes;
 
+    // telnet sessions on port 23, see setupConsole() for the commands
+    TelnetConsole Telnet;
+    // times the stages of loop()
+    LoopProfiler profiler;
+
+    // millis() at which loop() restarts the device, 0 for none
+    unsigned long restartAt;
+
+    // where ServerLog is drained to
     Stream *dbg_out;
 
     String www_username;
     String www_password;
+    // digests of the credentials and session tokens
+    SessionAuth auth;
+    // cookie sessions through /login, see useSessionAuth()
+    bool sessionMode;
+    // the request in handleClient() was refused, its failure is counted;
+    // the check runs again for every chunk of an upload
+    bool authRejected;
 
     String apSSID;
     String apPASS;
 
     String deviceName;
 
-    //holds the current upload
+    // flash key/value store, only used after useSettingsStore()
+    SettingsStore settings;
+
+    // settings as stored in EEPROM or settings, see loadConfig()
+    ConfigRecord config;
+    bool configStaging;
+    bool configDirty;
+    // ConfigMode bits saved but not applied yet, see applyConfig()
+    int configPending;
+    unsigned long configApplyAt;
+
+    // results of the last background scan
+    std::vector<NetworkInfo> networks;
+    unsigned long networksScannedAt;
+    bool networksScanned;
+    bool networksScanning;
+
+    // files are served from and uploaded to this, SPIFFS by default
+    fs::FS *fileSystem;
+
+    //holds the current upload, see beginUpload()
     File fsUploadFile;
+    uint32_t uploadHash;
+    MD5Builder uploadMD5;
+    // coalesces writes to whole filesystem pages
+    uint8_t *uploadBuffer;
+    size_t uploadBufferSize;
+    size_t uploadFill;
+    int uploadStatus;
+    const char *uploadError;
+
+    // small files served from RAM, off until enableFileCache()
+    FileCache fileCache;
+    // files packed into the firmware, see setAssets()
+    AssetBundle assets;
+    // file bodies sent from loop(), off until useBackgroundTransfers()
+    TransferPool transfers;
+    // subscribers of /events
+    EventStream events;
+
+    // ETags of known files, loaded from ETAG_INDEX_PATH
+    std::vector<FileTag> fileTags;
+
+    // Cache-Control max-age per file extension, in seconds
+    std::vector<CacheRule> cacheRules;
+    uint32_t defaultMaxAge;
+
+    // application MIME types, checked before the built-in table
+    const MimeType *extraMimeTypes;
+    size_t extraMimeTypesCount;
 
     void (*stHandler)(void);
     void (*apHandler)(void);
     void (*onStartUpdateHandler)(void);
-
-    ServerHelper() : server(80), TelnetServer(23)
+    void (*wifiStateHandler)(WifiState from, WifiState to);
+
+    // connection state machine driven by loop()
+    WifiState wifiState;
+    unsigned long wifiStateSince;
+    unsigned long wifiConnectTimeout;
+    unsigned long wifiRetryMin;
+    unsigned long wifiRetryMax;
+    unsigned long wifiRetryDelay;
+
+    // time from WiFi.begin() to the connection of this boot, in ms
+    unsigned long wifiConnectStart;
+    unsigned long wifiConnectTime;
+    bool wifiFastConnect;
+
+    // launchWeb() and OTA_setup() ran, they only run once per boot
+    bool webStarted;
+    bool otaStarted;
+
+    ServerHelper() : ServerHelper((Stream *)NULL)
     {
         dbg_out = &Telnet;
     }
-    ServerHelper(Stream *s) : server(80), TelnetServer(23)
+    ServerHelper(Stream *s) : server(80), Telnet(23)
     {
         dbg_out = s;
+        authMode = false;
+        sessionMode = false;
+        authRejected = false;
+        restartAt = 0;
+        fileSystem = &SPIFFS;
+
+        memset(&config, 0, sizeof(config));
+        configStaging = false;
+        configDirty = false;
+        configPending = 0;
+        configApplyAt = 0;
+
+        networksScannedAt = 0;
+        networksScanned = false;
+        networksScanning = false;
+
+        uploadHash = 0;
+        uploadBuffer = NULL;
+        uploadBufferSize = 0;
+        uploadFill = 0;
+        uploadStatus = 200;
+        uploadError = NULL;
+        defaultMaxAge = 0;
+        extraMimeTypes = NULL;
+        extraMimeTypesCount = 0;
+
+        stHandler = NULL;
+        apHandler = NULL;
+        onStartUpdateHandler = NULL;
+        wifiStateHandler = NULL;
+
+        wifiState = WIFI_STATE_IDLE;
+        wifiStateSince = 0;
+        wifiConnectTimeout = WIFI_CONNECT_TIMEOUT;
+        wifiRetryMin = WIFI_RETRY_MIN;
+        wifiRetryMax = WIFI_RETRY_MAX;
+        wifiRetryDelay = WIFI_RETRY_MIN;
+
+        wifiConnectStart = 0;
+        wifiConnectTime = 0;
+        wifiFastConnect = false;
+
+        webStarted = false;
+        otaStarted = false;
     }
 
     void setup(void (*handler)(void) = NULL);
     void loop();
     void handleTelnet();
+    void setupConsole();
     void OTA_setup();
     void setupAP();
 
+    // Keeps the settings in a wear-leveled log on the given flash sectors
+    // instead of EEPROM. Call before setup(), the sectors must be reserved.
+    bool useSettingsStore(uint32_t firstSector, uint16_t sectorCount);
+    bool loadConfig();
+    void migrateConfig();
+    void resetConfig();
+    void saveConfig();
+    void beginConfig();
+    void sendConfig();
+    void patchConfig();
+    bool parseConfig(const String &body, ConfigRecord &next, String &error);
+    int configChanges(const ConfigRecord &next);
+    void applyConfig();
+    bool commitConfig();
+
     bool read_ssid_and_pass(String *essid, String *epass);
     void write_ssid_and_pass(String essid, String epass);
     
@@ -102,21 +380,95 @@ class ServerHelper
     
     void set_ap_ssid_and_pass(String ssid, String pass);
 
+    bool read_bssid_and_channel(uint8_t *bssid, int32_t *channel);
+    void write_bssid_and_channel(const uint8_t *bssid, int32_t channel);
+
     bool read_ipv4(IPAddress *ip, IPAddress *gateway, IPAddress *subnet, IPAddress *dns);
     void write_ipv4(String ip, String gateway, String subnet, String dns);
    
     bool testWifi(void);
+    void beginWifi(void);
+    void handleWifi(void);
+    void setWifiState(WifiState state);
+    void onWifiState(void (*handler)(WifiState from, WifiState to));
+    void setWifiTimeout(unsigned long timeout);
+    void setWifiBackoff(unsigned long retryMin, unsigned long retryMax);
     void launchWeb(int webtype);
 
     void listNetworks(void);
+    void startNetworkScan(void);
+    void updateNetworkScan(void);
 
     void active_auth_mode();
     void deactive_auth_mode();
 
-    String getContentType(String filename);
+    // types must outlive the helper, e.g. a static const array
+    template <size_t N>
+    void setMimeTypes(const MimeType (&types)[N])
+    {
+        extraMimeTypes = types;
+        extraMimeTypesCount = N;
+    }
+
+    // call before setup(), e.g. with an FS backed by another medium
+    void setFileSystem(fs::FS &fs) { fileSystem = &fs; }
+
+    String getContentType(const String &filename);
+    bool acceptsGzip();
     bool handleFileRead(String path);
+    RangeResult parseRange(const String &header, size_t size, size_t *start, size_t *end);
+    // 500 when the file cannot seek to start
+    size_t streamFileRange(File &file, const String &contentType, size_t start, size_t end, bool gzip = false);
+    void sendCachedFile(const CachedFile *cached, const String &contentType, bool gzip = false);
+    bool sendAsset(const String &path);
+    bool canTransfer(size_t len) { return transfers.enabled() && len >= TRANSFER_MIN_SIZE && transfers.available(); }
+    // sends the headers and hands the body and the connection to transfers
+    size_t startTransfer(File &file, int code, const String &contentType, size_t len);
+
+    // Sends file bodies from loop() a send buffer at a time, up to slots
+    // at once, so a slow client no longer holds up the others.
+    void useBackgroundTransfers(size_t slots = TRANSFER_SLOTS) { transfers.begin(slots); }
+
+    // Serves the table generated by tools/pack_assets.py from flash,
+    // before looking at the filesystem.
+    template <size_t N>
+    void setAssets(const AssetEntry (&entries)[N])
+    {
+        assets.begin(entries, N);
+    }
+
+    // keeps up to capacity bytes of files no larger than maxFileSize in RAM
+    void enableFileCache(size_t capacity, size_t maxFileSize = FILE_CACHE_MAX_FILE) { fileCache.setCapacity(capacity, maxFileSize); }
     void handleFileUpload();
+    void beginUpload(const String &path);
+    void writeUpload(const uint8_t *data, size_t len);
+    bool flushUpload(const uint8_t *data, size_t len);
+    void endUpload(const String &path, size_t size);
+    void failUpload(int status, const char *error);
+    bool finishUpload(const String &path);
+    void recoverUpload();
+    void discardUpload();
     void handleFileDelete();
+    void handleFileRename();
+    void listFiles();
+    void sendFileSystemInfo();
+
+    void loadFileTags();
+    void saveFileTags();
+    FileTag *findFileTag(const String &path);
+    void updateFileTag(const String &path, uint32_t size, uint32_t hash);
+    void removeFileTag(const String &path);
+    bool fileExists(const String &path);
+    String fileETag(const String &path);
+    // call after writing a file from the sketch, drops its cached copy and
+    // its ETag; by itself the helper only notices a change of size
+    void fileWritten(const String &path);
+    String fileETag(const String &path, File &file);
+    static String formatETag(const FileTag &tag);
+
+    void setCacheControl(const String &extension, uint32_t maxAge);
+    void setCacheControl(uint32_t maxAge);
+    String getCacheControl(const String &path);
 
     void printMyTime();
 
@@ -125,6 +477,19 @@ class ServerHelper
 
     bool checkAuthentication();
 
+    // Pushes a Server-Sent Event to every client of /events, e.g.
+    // broadcast("temp", "21.5"). The message is formatted once.
+    void broadcast(const char *event, const String &data) { events.broadcast(event, data); }
+    void subscribeEvents();
+    // Lets clients trade the credentials for a session cookie at
+    // POST /login, valid for lifetime seconds. Basic auth keeps working.
+    // Call before setup().
+    void useSessionAuth(uint32_t lifetime = SESSION_LIFETIME);
+    void setCredentials(const String &user, const String &pass);
+    bool lockedOut(uint32_t ip);
+    void handleLogin();
+    void handleLogout();
+
     void clearEEPROM(int addr = 0, int len = 512);
     
     int writeEEPROM(int addr, String str, int len = 0);
@@ -135,6 +500,18 @@ class ServerHelper
     void on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn, ESP8266WebServer::THandlerFunction ufn);
     void on(const String &uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn);
     void on(const String &uri, ESP8266WebServer::THandlerFunction fn);
+
+    // Fixed route table, see StaticRoute. Replaces any previous table and
+    // is searched before the routes added with the other on() overloads.
+    template <size_t N>
+    void on(const StaticRoute (&table)[N])
+    {
+        routes.setStatic(table, N);
+    }
+
+    int pathArgs();
+    String pathArg(int i);
+    String pathArg(const String &name);
 };
 
 class MyRequestHandler : public RequestHandler
@@ -148,9 +525,36 @@ class MyRequestHandler : public RequestHandler
     {
     }
 
+    const String &uri() const
+    {
+        return _uri;
+    }
+
+    bool allows(HTTPMethod requestMethod) const
+    {
+        return _method == HTTP_ANY || _method == requestMethod;
+    }
+
+    bool hasUpload() const
+    {
+        return (bool)_ufn;
+    }
+
+    void invoke()
+    {
+        if (_auth())
+            _fn();
+    }
+
+    void invokeUpload()
+    {
+        if (_ufn && _auth())
+            _ufn();
+    }
+
     bool canHandle(HTTPMethod requestMethod, String requestUri) override
     {
-        if (_method != HTTP_ANY && _method != requestMethod)
+        if (!allows(requestMethod))
             return false;
 
         if (requestUri != _uri)
@@ -172,8 +576,7 @@ class MyRequestHandler : public RequestHandler
         (void)server;
         if (!canHandle(requestMethod, requestUri))
             return false;
-        if (_auth())
-            _fn();
+        invoke();
         return true;
     }
 
@@ -182,10 +585,7 @@ class MyRequestHandler : public RequestHandler
         (void)server;
         (void)upload;
         if (canUpload(requestUri))
-        {
-            if (_auth())
-                _ufn();
-        }
+            invokeUpload();
     }
 
   protected:
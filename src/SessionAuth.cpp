@@ -0,0 +1,246 @@
+#include "SessionAuth.h"
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char hexChars[] = "0123456789abcdef";
+
+// base64 of data straight into the hash, the encoded text is never kept
+static void addBase64(br_sha256_context *sha, const uint8_t *data, size_t len)
+{
+  for (size_t i = 0; i < len; i += 3)
+  {
+    uint32_t n = (uint32_t)data[i] << 16;
+    if (i + 1 < len)
+      n |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < len)
+      n |= data[i + 2];
+    uint8_t out[4];
+    out[0] = base64Chars[(n >> 18) & 63];
+    out[1] = base64Chars[(n >> 12) & 63];
+    out[2] = i + 1 < len ? base64Chars[(n >> 6) & 63] : '=';
+    out[3] = i + 2 < len ? base64Chars[n & 63] : '=';
+    br_sha256_update(sha, out, 4);
+  }
+}
+
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+SessionAuth::SessionAuth() : _keyed(false), _lifetime(SESSION_LIFETIME), _elapsed(0), _lastMillis(0)
+{
+  memset(_basic, 0, sizeof(_basic));
+  memset(_login, 0, sizeof(_login));
+  memset(_failures, 0, sizeof(_failures));
+}
+
+void SessionAuth::begin()
+{
+  uint8_t key[SESSION_KEY_SIZE];
+  // hardware random number generator
+  for (int i = 0; i < SESSION_KEY_SIZE; i += 4)
+  {
+    uint32_t r = RANDOM_REG32;
+    memcpy(key + i, &r, 4);
+  }
+  br_hmac_key_init(&_key, &br_sha256_vtable, key, sizeof(key));
+  memset(key, 0, sizeof(key));
+  _keyed = true;
+}
+
+void SessionAuth::setCredentials(const char *user, const char *password)
+{
+  br_sha256_context sha;
+  br_sha256_init(&sha);
+  br_sha256_update(&sha, user, strlen(user));
+  br_sha256_update(&sha, ":", 1);
+  br_sha256_update(&sha, password, strlen(password));
+  br_sha256_out(&sha, _login);
+
+  // the header as a client sends it, "Basic " + base64(user:password)
+  size_t userLen = strlen(user);
+  size_t passLen = strlen(password);
+  uint8_t *plain = (uint8_t *)malloc(userLen + 1 + passLen);
+  if (!plain)
+    return;
+  memcpy(plain, user, userLen);
+  plain[userLen] = ':';
+  memcpy(plain + userLen + 1, password, passLen);
+
+  br_sha256_init(&sha);
+  br_sha256_update(&sha, "Basic ", 6);
+  addBase64(&sha, plain, userLen + 1 + passLen);
+  br_sha256_out(&sha, _basic);
+
+  memset(plain, 0, userLen + 1 + passLen);
+  free(plain);
+}
+
+bool SessionAuth::equals(const uint8_t *a, const uint8_t *b, size_t len)
+{
+  // no early exit, the time taken does not tell how much matched
+  uint8_t diff = 0;
+  for (size_t i = 0; i < len; ++i)
+    diff |= a[i] ^ b[i];
+  return diff == 0;
+}
+
+bool SessionAuth::checkBasic(const char *header)
+{
+  uint8_t digest[br_sha256_SIZE];
+  br_sha256_context sha;
+  br_sha256_init(&sha);
+  br_sha256_update(&sha, header, strlen(header));
+  br_sha256_out(&sha, digest);
+  return equals(digest, _basic, sizeof(digest));
+}
+
+bool SessionAuth::checkLogin(const char *user, const char *password)
+{
+  uint8_t digest[br_sha256_SIZE];
+  br_sha256_context sha;
+  br_sha256_init(&sha);
+  br_sha256_update(&sha, user, strlen(user));
+  br_sha256_update(&sha, ":", 1);
+  br_sha256_update(&sha, password, strlen(password));
+  br_sha256_out(&sha, digest);
+  return equals(digest, _login, sizeof(digest));
+}
+
+uint32_t SessionAuth::now()
+{
+  uint32_t ms = millis();
+  _elapsed += (uint32_t)(ms - _lastMillis);
+  _lastMillis = ms;
+  return _elapsed / 1000;
+}
+
+void SessionAuth::sign(const char *payload, uint8_t mac[br_sha256_SIZE])
+{
+  br_hmac_context hmac;
+  br_hmac_init(&hmac, &_key, 0);
+  br_hmac_update(&hmac, payload, SESSION_PAYLOAD_SIZE);
+  br_hmac_out(&hmac, mac);
+}
+
+void SessionAuth::issue(char *token)
+{
+  uint32_t expiry = now() + _lifetime;
+  uint32_t nonce = RANDOM_REG32;
+  for (int i = 0; i < 8; ++i)
+  {
+    token[i] = hexChars[(expiry >> (28 - i * 4)) & 15];
+    token[8 + i] = hexChars[(nonce >> (28 - i * 4)) & 15];
+  }
+
+  uint8_t mac[br_sha256_SIZE];
+  sign(token, mac);
+  char *p = token + SESSION_PAYLOAD_SIZE;
+  *p++ = '.';
+  for (int i = 0; i < SESSION_MAC_SIZE; ++i)
+  {
+    *p++ = hexChars[mac[i] >> 4];
+    *p++ = hexChars[mac[i] & 15];
+  }
+  *p = 0;
+}
+
+bool SessionAuth::validate(const char *token, size_t len)
+{
+  if (!_keyed || len != SESSION_TOKEN_SIZE || token[SESSION_PAYLOAD_SIZE] != '.')
+    return false;
+
+  uint8_t given[SESSION_MAC_SIZE];
+  const char *p = token + SESSION_PAYLOAD_SIZE + 1;
+  for (int i = 0; i < SESSION_MAC_SIZE; ++i)
+  {
+    int hi = hexValue(p[i * 2]);
+    int lo = hexValue(p[i * 2 + 1]);
+    if (hi < 0 || lo < 0)
+      return false;
+    given[i] = hi << 4 | lo;
+  }
+
+  uint8_t mac[br_sha256_SIZE];
+  sign(token, mac);
+  if (!equals(mac, given, SESSION_MAC_SIZE))
+    return false;
+
+  // the signature holds, the payload is ours
+  uint32_t expiry = 0;
+  for (int i = 0; i < 8; ++i)
+    expiry = expiry << 4 | hexValue(token[i]);
+  return now() < expiry;
+}
+
+bool SessionAuth::validateCookie(const char *header)
+{
+  static const char name[] = SESSION_COOKIE "=";
+  const char *p = header;
+  while ((p = strstr(p, name)) != NULL)
+  {
+    // a whole cookie name, not the tail of another one
+    if (p == header || p[-1] == ' ' || p[-1] == ';')
+    {
+      const char *value = p + sizeof(name) - 1;
+      const char *end = strchr(value, ';');
+      size_t len = end ? (size_t)(end - value) : strlen(value);
+      if (validate(value, len))
+        return true;
+    }
+    p += sizeof(name) - 1;
+  }
+  return false;
+}
+
+AuthFailure *SessionAuth::findFailure(uint32_t ip, bool create)
+{
+  AuthFailure *oldest = &_failures[0];
+  for (int i = 0; i < AUTH_LOCKOUT_SLOTS; ++i)
+  {
+    if (_failures[i].ip == ip && _failures[i].last)
+      return &_failures[i];
+    if (_failures[i].last < oldest->last)
+      oldest = &_failures[i];
+  }
+  if (!create)
+    return NULL;
+  memset(oldest, 0, sizeof(*oldest));
+  oldest->ip = ip;
+  return oldest;
+}
+
+uint32_t SessionAuth::lockedFor(uint32_t ip)
+{
+  AuthFailure *failure = findFailure(ip, false);
+  uint32_t t = now();
+  if (!failure || failure->lockedUntil <= t)
+    return 0;
+  return failure->lockedUntil - t;
+}
+
+void SessionAuth::failed(uint32_t ip)
+{
+  AuthFailure *failure = findFailure(ip, true);
+  uint32_t t = now();
+  // slots with last == 0 are free, so count from 1
+  failure->last = t + 1;
+  if (++failure->count >= AUTH_MAX_FAILURES)
+  {
+    failure->count = 0;
+    failure->lockedUntil = t + AUTH_LOCKOUT_SECONDS;
+  }
+}
+
+void SessionAuth::succeeded(uint32_t ip)
+{
+  AuthFailure *failure = findFailure(ip, false);
+  if (failure)
+    memset(failure, 0, sizeof(*failure));
+}
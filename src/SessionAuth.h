@@ -0,0 +1,103 @@
+#ifndef SessionAuth_h
+#define SessionAuth_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// SHA-256 and HMAC of the BearSSL copy that comes with the core
+#include <bearssl/bearssl_hash.h>
+#include <bearssl/bearssl_hmac.h>
+
+// bytes of the session signing key
+#define SESSION_KEY_SIZE        32
+
+// name of the cookie holding the session token
+#define SESSION_COOKIE          "SHSESSION"
+// seconds a session token stays valid, by default
+#ifndef SESSION_LIFETIME
+#define SESSION_LIFETIME        3600
+#endif
+// "<expiry 8 hex><nonce 8 hex>.<mac 32 hex>"
+#define SESSION_PAYLOAD_SIZE    16
+#define SESSION_MAC_SIZE        16
+#define SESSION_TOKEN_SIZE      (SESSION_PAYLOAD_SIZE + 1 + SESSION_MAC_SIZE * 2)
+
+// failed logins from one address before it is locked out
+#ifndef AUTH_MAX_FAILURES
+#define AUTH_MAX_FAILURES       5
+#endif
+#ifndef AUTH_LOCKOUT_SECONDS
+#define AUTH_LOCKOUT_SECONDS    60
+#endif
+// addresses whose failures are tracked, the oldest is forgotten first
+#define AUTH_LOCKOUT_SLOTS      8
+
+// failed logins of one address, times in SessionAuth::now() seconds
+struct AuthFailure
+{
+    uint32_t ip;
+    uint8_t count;
+    uint32_t lockedUntil;
+    // one past the time of the last failure, 0 for a free slot
+    uint32_t last;
+};
+
+// Credential checks for ServerHelper::checkAuthentication().
+//
+// Only SHA-256 digests of the credentials are kept, computed once when
+// they are set: a request costs one hash and a constant time compare
+// instead of decoding and comparing Strings.
+//
+// A login is exchanged for a token signed with HMAC-SHA256 under a key
+// drawn at boot, so a reset ends all sessions. Tokens hold their expiry
+// and are not stored on the device; validating one allocates nothing.
+class SessionAuth
+{
+  public:
+    SessionAuth();
+
+    // draws a new signing key
+    void begin();
+    void setCredentials(const char *user, const char *password);
+    void setLifetime(uint32_t seconds) { _lifetime = seconds; }
+    uint32_t lifetime() { return _lifetime; }
+
+    // value of an Authorization header, "Basic ..."
+    bool checkBasic(const char *header);
+    bool checkLogin(const char *user, const char *password);
+
+    // token is SESSION_TOKEN_SIZE + 1 chars
+    void issue(char *token);
+    bool validate(const char *token, size_t len);
+    // finds SESSION_COOKIE in a Cookie header
+    bool validateCookie(const char *header);
+
+    // seconds left of a lockout, 0 if the address may try
+    uint32_t lockedFor(uint32_t ip);
+    void failed(uint32_t ip);
+    void succeeded(uint32_t ip);
+
+    // seconds since boot, does not wrap with millis()
+    uint32_t now();
+
+    static bool equals(const uint8_t *a, const uint8_t *b, size_t len);
+
+  protected:
+    void sign(const char *payload, uint8_t mac[br_sha256_SIZE]);
+    AuthFailure *findFailure(uint32_t ip, bool create);
+
+    // the signing key, with the inner and outer key blocks hashed once
+    br_hmac_key_context _key;
+    uint8_t _basic[br_sha256_SIZE];
+    uint8_t _login[br_sha256_SIZE];
+    bool _keyed;
+    uint32_t _lifetime;
+    uint64_t _elapsed;
+    uint32_t _lastMillis;
+    AuthFailure _failures[AUTH_LOCKOUT_SLOTS];
+};
+
+#endif
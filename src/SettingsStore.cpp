@@ -0,0 +1,417 @@
+#include "SettingsStore.h"
+
+#define SETTINGS_RECORD_VALUE    0x01
+#define SETTINGS_RECORD_DELETED  0x02
+
+// bytes staged per flash access, a multiple of 4
+#define SETTINGS_CHUNK 64
+
+struct SettingsSectorHeader
+{
+    uint32_t magic;
+    uint32_t sequence;
+};
+
+static_assert(sizeof(SettingsRecordHeader) == 8, "SettingsRecordHeader must be two words");
+static_assert(sizeof(SettingsSectorHeader) == 8, "SettingsSectorHeader must be two words");
+
+static EspSettingsFlash espFlash;
+
+static uint32_t align4(uint32_t n)
+{
+  return (n + 3) & ~3UL;
+}
+
+static uint32_t recordSize(const SettingsRecordHeader &hdr)
+{
+  return sizeof(SettingsRecordHeader) + align4(hdr.keyLen + hdr.valueLen);
+}
+
+bool EspSettingsFlash::read(uint32_t addr, uint32_t *data, size_t size)
+{
+  return ESP.flashRead(addr, data, size);
+}
+
+bool EspSettingsFlash::write(uint32_t addr, const uint32_t *data, size_t size)
+{
+  return ESP.flashWrite(addr, const_cast<uint32_t *>(data), size);
+}
+
+bool EspSettingsFlash::erase(uint32_t sector)
+{
+  return ESP.flashEraseSector(sector);
+}
+
+uint32_t SettingsStore::crc32(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  crc = ~crc;
+  while (len--)
+  {
+    crc ^= *p++;
+    for (int i = 0; i < 8; ++i)
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+SettingsStore::SettingsStore()
+    : _flash(&espFlash), _first(0), _count(0), _active(0), _sequence(0), _end(0), _erases(0), _torn(false)
+{
+}
+
+bool SettingsStore::begin(uint32_t firstSector, uint16_t sectorCount)
+{
+  _count = 0;
+  if (sectorCount < 2)
+    return false;
+  _first = firstSector;
+  _count = sectorCount;
+  _erases = 0;
+  _torn = false;
+
+  // the active sector is the valid one with the highest sequence
+  bool found = false;
+  for (uint16_t i = 0; i < _count; ++i)
+  {
+    SettingsSectorHeader sh;
+    if (!_flash->read(sectorAddr(i), (uint32_t *)&sh, sizeof(sh)))
+      continue;
+    if (sh.magic != SETTINGS_MAGIC || sh.sequence == 0xFFFFFFFFUL)
+      continue;
+    if (!found || (int32_t)(sh.sequence - _sequence) > 0)
+    {
+      _active = i;
+      _sequence = sh.sequence;
+      found = true;
+    }
+  }
+
+  if (!found)
+  {
+    _active = 0;
+    _sequence = 1;
+    _end = sizeof(SettingsSectorHeader);
+    SettingsSectorHeader sh = {SETTINGS_MAGIC, _sequence};
+    if (!eraseSector(_active) || !_flash->write(sectorAddr(_active), (const uint32_t *)&sh, sizeof(sh)))
+    {
+      _count = 0;
+      return false;
+    }
+    return true;
+  }
+
+  // walk the log up to the first record that is not valid
+  SettingsRecordHeader hdr;
+  _end = sizeof(SettingsSectorHeader);
+  while (_end + sizeof(hdr) <= SETTINGS_SECTOR_SIZE && readRecord(sectorAddr(_active) + _end, &hdr))
+    _end += recordSize(hdr);
+
+  // anything but erased flash after the log is a torn write, move the
+  // live records to a clean sector before appending again
+  uint32_t tail = 0xFFFFFFFFUL;
+  if (_end + sizeof(tail) <= SETTINGS_SECTOR_SIZE)
+    _flash->read(sectorAddr(_active) + _end, &tail, sizeof(tail));
+  if (tail != 0xFFFFFFFFUL)
+    return compact(NULL, NULL, 0, 0);
+  return true;
+}
+
+bool SettingsStore::eraseSector(uint16_t index)
+{
+  ++_erases;
+  return _flash->erase(_first + index);
+}
+
+bool SettingsStore::readBytes(uint32_t addr, void *data, size_t len)
+{
+  uint8_t *out = (uint8_t *)data;
+  uint32_t buf[SETTINGS_CHUNK / 4];
+  while (len > 0)
+  {
+    uint32_t base = addr & ~3UL;
+    size_t skip = addr - base;
+    size_t n = sizeof(buf) - skip;
+    if (n > len)
+      n = len;
+    if (!_flash->read(base, buf, align4(skip + n)))
+      return false;
+    memcpy(out, (uint8_t *)buf + skip, n);
+    out += n;
+    addr += n;
+    len -= n;
+  }
+  return true;
+}
+
+bool SettingsStore::readRecord(uint32_t addr, SettingsRecordHeader *hdr)
+{
+  if (!_flash->read(addr, (uint32_t *)hdr, sizeof(*hdr)))
+    return false;
+  if (hdr->flags != SETTINGS_RECORD_VALUE && hdr->flags != SETTINGS_RECORD_DELETED)
+    return false;
+  if (hdr->keyLen == 0 || hdr->keyLen > SETTINGS_KEY_MAX || hdr->valueLen > SETTINGS_VALUE_MAX)
+    return false;
+  if ((addr % SETTINGS_SECTOR_SIZE) + recordSize(*hdr) > SETTINGS_SECTOR_SIZE)
+    return false;
+
+  uint32_t crc = crc32(0, hdr, 4);
+  uint8_t buf[SETTINGS_CHUNK];
+  uint32_t pos = addr + sizeof(*hdr);
+  size_t left = hdr->keyLen + hdr->valueLen;
+  while (left > 0)
+  {
+    size_t n = left < sizeof(buf) ? left : sizeof(buf);
+    if (!readBytes(pos, buf, n))
+      return false;
+    crc = crc32(crc, buf, n);
+    pos += n;
+    left -= n;
+  }
+  return crc == hdr->crc;
+}
+
+bool SettingsStore::recordKeyEquals(uint32_t addr, const SettingsRecordHeader &hdr, const char *key, size_t keyLen)
+{
+  char buf[SETTINGS_KEY_MAX];
+  if (hdr.keyLen != keyLen || !readBytes(addr + sizeof(hdr), buf, keyLen))
+    return false;
+  return memcmp(buf, key, keyLen) == 0;
+}
+
+bool SettingsStore::recordValueEquals(uint32_t addr, const SettingsRecordHeader &hdr, const void *value, size_t len)
+{
+  if (hdr.flags != SETTINGS_RECORD_VALUE || hdr.valueLen != len)
+    return false;
+  const uint8_t *p = (const uint8_t *)value;
+  uint8_t buf[SETTINGS_CHUNK];
+  uint32_t pos = addr + sizeof(hdr) + hdr.keyLen;
+  while (len > 0)
+  {
+    size_t n = len < sizeof(buf) ? len : sizeof(buf);
+    if (!readBytes(pos, buf, n) || memcmp(buf, p, n) != 0)
+      return false;
+    p += n;
+    pos += n;
+    len -= n;
+  }
+  return true;
+}
+
+// address of the newest record of key in the active sector, 0 if none
+uint32_t SettingsStore::find(const char *key, SettingsRecordHeader *hdr)
+{
+  size_t keyLen = strlen(key);
+  uint32_t base = sectorAddr(_active);
+  uint32_t found = 0;
+  SettingsRecordHeader cur;
+  for (uint32_t off = sizeof(SettingsSectorHeader); off < _end; off += recordSize(cur))
+  {
+    // records before _end were validated by begin() or written by us
+    if (!_flash->read(base + off, (uint32_t *)&cur, sizeof(cur)))
+      return 0;
+    if (recordKeyEquals(base + off, cur, key, keyLen))
+    {
+      found = base + off;
+      *hdr = cur;
+    }
+  }
+  return found;
+}
+
+int SettingsStore::get(const char *key, void *value, size_t size)
+{
+  if (!isOpen())
+    return -1;
+  SettingsRecordHeader hdr;
+  uint32_t addr = find(key, &hdr);
+  if (!addr || hdr.flags != SETTINGS_RECORD_VALUE)
+    return -1;
+  size_t n = hdr.valueLen < size ? hdr.valueLen : size;
+  if (!readBytes(addr + sizeof(hdr) + hdr.keyLen, value, n))
+    return -1;
+  return hdr.valueLen;
+}
+
+bool SettingsStore::put(const char *key, const void *value, size_t len)
+{
+  if (!isOpen() || len > SETTINGS_VALUE_MAX)
+    return false;
+  // rewriting the same value would only wear the flash
+  SettingsRecordHeader hdr;
+  uint32_t addr = find(key, &hdr);
+  if (addr && recordValueEquals(addr, hdr, value, len))
+    return true;
+  return append(key, value, len, SETTINGS_RECORD_VALUE);
+}
+
+bool SettingsStore::remove(const char *key)
+{
+  if (!isOpen())
+    return false;
+  SettingsRecordHeader hdr;
+  uint32_t addr = find(key, &hdr);
+  if (!addr || hdr.flags == SETTINGS_RECORD_DELETED)
+    return true;
+  return append(key, NULL, 0, SETTINGS_RECORD_DELETED);
+}
+
+String SettingsStore::getString(const char *key)
+{
+  char buf[SETTINGS_CHUNK + 1];
+  int len = get(key, buf, SETTINGS_CHUNK);
+  if (len < 0)
+    return String();
+  if (len <= SETTINGS_CHUNK)
+  {
+    buf[len] = 0;
+    return String(buf);
+  }
+
+  String str;
+  char *big = (char *)malloc(len + 1);
+  if (big && get(key, big, len) == len)
+  {
+    big[len] = 0;
+    str = big;
+  }
+  free(big);
+  return str;
+}
+
+bool SettingsStore::putString(const char *key, const String &value)
+{
+  return put(key, value.c_str(), value.length());
+}
+
+bool SettingsStore::writeRecord(uint32_t addr, const char *key, const void *value, size_t len, uint8_t flags)
+{
+  size_t keyLen = strlen(key);
+  SettingsRecordHeader hdr;
+  hdr.valueLen = len;
+  hdr.keyLen = keyLen;
+  hdr.flags = flags;
+  hdr.crc = crc32(0, &hdr, 4);
+  hdr.crc = crc32(hdr.crc, key, keyLen);
+  hdr.crc = crc32(hdr.crc, value, len);
+
+  // stream header, key, value and padding through one aligned buffer
+  const uint8_t *parts[3] = {(const uint8_t *)&hdr, (const uint8_t *)key, (const uint8_t *)value};
+  size_t sizes[3] = {sizeof(hdr), keyLen, len};
+  uint32_t buf[SETTINGS_CHUNK / 4];
+  uint8_t *bytes = (uint8_t *)buf;
+  size_t fill = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < sizes[i]; ++j)
+    {
+      bytes[fill++] = parts[i][j];
+      if (fill == sizeof(buf))
+      {
+        if (!_flash->write(addr, buf, fill))
+          return false;
+        addr += fill;
+        fill = 0;
+      }
+    }
+  }
+  if (fill > 0)
+  {
+    while (fill % 4)
+      bytes[fill++] = 0;
+    if (!_flash->write(addr, buf, fill))
+      return false;
+  }
+  return true;
+}
+
+bool SettingsStore::append(const char *key, const void *value, size_t len, uint8_t flags)
+{
+  size_t keyLen = strlen(key);
+  if (keyLen == 0 || keyLen > SETTINGS_KEY_MAX)
+    return false;
+
+  SettingsRecordHeader hdr;
+  hdr.keyLen = keyLen;
+  hdr.valueLen = len;
+  uint32_t size = recordSize(hdr);
+  if (_torn || _end + size > SETTINGS_SECTOR_SIZE)
+    return compact(key, value, len, flags);
+
+  if (!writeRecord(sectorAddr(_active) + _end, key, value, len, flags))
+  {
+    // the bytes after _end are no longer erased and a record written
+    // over them would not read back, carry on in a clean sector
+    _torn = true;
+    return compact(key, value, len, flags);
+  }
+  _end += size;
+  return true;
+}
+
+// Copies the newest record of every key into the next sector, followed by
+// the pending record if key is set. The new sector only becomes active
+// when its header is written last.
+bool SettingsStore::compact(const char *key, const void *value, size_t len, uint8_t flags)
+{
+  uint16_t next = (_active + 1) % _count;
+  uint32_t from = sectorAddr(_active);
+  uint32_t to = sectorAddr(next);
+  uint32_t out = sizeof(SettingsSectorHeader);
+  size_t keyLen = key ? strlen(key) : 0;
+
+  if (!eraseSector(next))
+    return false;
+
+  SettingsRecordHeader cur;
+  for (uint32_t off = sizeof(SettingsSectorHeader); off < _end; off += recordSize(cur))
+  {
+    if (!_flash->read(from + off, (uint32_t *)&cur, sizeof(cur)))
+      return false;
+    if (cur.flags != SETTINGS_RECORD_VALUE)
+      continue;
+
+    char name[SETTINGS_KEY_MAX + 1];
+    if (!readBytes(from + off + sizeof(cur), name, cur.keyLen))
+      return false;
+    name[cur.keyLen] = 0;
+    if (key && recordKeyEquals(from + off, cur, key, keyLen))
+      continue;
+    SettingsRecordHeader newest;
+    if (find(name, &newest) != from + off)
+      continue;
+
+    uint32_t size = recordSize(cur);
+    if (out + size > SETTINGS_SECTOR_SIZE)
+      return false;
+    uint32_t buf[SETTINGS_CHUNK / 4];
+    for (uint32_t done = 0; done < size; done += sizeof(buf))
+    {
+      uint32_t n = size - done < sizeof(buf) ? size - done : sizeof(buf);
+      if (!_flash->read(from + off + done, buf, n) || !_flash->write(to + out + done, buf, n))
+        return false;
+    }
+    out += size;
+  }
+
+  if (key && flags == SETTINGS_RECORD_VALUE)
+  {
+    SettingsRecordHeader hdr;
+    hdr.keyLen = keyLen;
+    hdr.valueLen = len;
+    uint32_t size = recordSize(hdr);
+    if (out + size > SETTINGS_SECTOR_SIZE || !writeRecord(to + out, key, value, len, flags))
+      return false;
+    out += size;
+  }
+
+  SettingsSectorHeader sh = {SETTINGS_MAGIC, _sequence + 1};
+  if (!_flash->write(to, (const uint32_t *)&sh, sizeof(sh)))
+    return false;
+
+  _active = next;
+  _sequence = sh.sequence;
+  _end = out;
+  _torn = false;
+  return true;
+}
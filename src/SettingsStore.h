@@ -0,0 +1,101 @@
+#ifndef SettingsStore_h
+#define SettingsStore_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#define SETTINGS_SECTOR_SIZE  4096
+#define SETTINGS_KEY_MAX      32
+#define SETTINGS_VALUE_MAX    1024
+#define SETTINGS_MAGIC        0x53485353UL    // "SSHS"
+
+// Raw access to flash sectors. Addresses are in bytes from the start of
+// the flash chip, reads and writes are 4-byte aligned in address and size.
+class SettingsFlash
+{
+  public:
+    virtual ~SettingsFlash() {}
+    virtual bool read(uint32_t addr, uint32_t *data, size_t size) = 0;
+    virtual bool write(uint32_t addr, const uint32_t *data, size_t size) = 0;
+    virtual bool erase(uint32_t sector) = 0;
+};
+
+// SettingsFlash on the ESP8266 SPI flash
+class EspSettingsFlash : public SettingsFlash
+{
+  public:
+    bool read(uint32_t addr, uint32_t *data, size_t size) override;
+    bool write(uint32_t addr, const uint32_t *data, size_t size) override;
+    bool erase(uint32_t sector) override;
+};
+
+struct SettingsRecordHeader
+{
+    uint16_t valueLen;
+    uint8_t keyLen;
+    uint8_t flags;
+    uint32_t crc;
+};
+
+// Log-structured key/value store over a ring of flash sectors.
+//
+// Records are appended to the active sector, the newest record of a key
+// wins. When the active sector is full, the live records are copied into
+// the next sector of the ring, which becomes active once its header is
+// written. Every sector is therefore erased once per trip around the
+// ring instead of on every save, and a power loss during a write or a
+// compaction leaves the previous state readable.
+//
+// The sectors must not be used by anything else, e.g. leave them out of
+// SPIFFS by building with a smaller filesystem.
+class SettingsStore
+{
+  public:
+    SettingsStore();
+
+    bool begin(uint32_t firstSector, uint16_t sectorCount);
+    bool isOpen() { return _count > 0; }
+    void setFlash(SettingsFlash *flash) { _flash = flash; }
+
+    // length of the stored value, copies up to size bytes, -1 if missing
+    int get(const char *key, void *value, size_t size);
+    bool put(const char *key, const void *value, size_t len);
+    bool remove(const char *key);
+
+    String getString(const char *key);
+    bool putString(const char *key, const String &value);
+
+    // sector erases since begin()
+    uint32_t eraseCount() { return _erases; }
+    uint16_t activeSector() { return _first + _active; }
+    size_t used() { return _end; }
+
+    static uint32_t crc32(uint32_t crc, const void *data, size_t len);
+
+  protected:
+    uint32_t sectorAddr(uint16_t index) { return (uint32_t)(_first + index) * SETTINGS_SECTOR_SIZE; }
+    bool readBytes(uint32_t addr, void *data, size_t len);
+    bool readRecord(uint32_t addr, SettingsRecordHeader *hdr);
+    bool recordKeyEquals(uint32_t addr, const SettingsRecordHeader &hdr, const char *key, size_t keyLen);
+    bool recordValueEquals(uint32_t addr, const SettingsRecordHeader &hdr, const void *value, size_t len);
+    uint32_t find(const char *key, SettingsRecordHeader *hdr);
+    bool writeRecord(uint32_t addr, const char *key, const void *value, size_t len, uint8_t flags);
+    bool append(const char *key, const void *value, size_t len, uint8_t flags);
+    bool compact(const char *key, const void *value, size_t len, uint8_t flags);
+    bool eraseSector(uint16_t index);
+
+    SettingsFlash *_flash;
+    uint32_t _first;
+    uint16_t _count;
+    uint16_t _active;
+    uint32_t _sequence;
+    uint32_t _end;
+    uint32_t _erases;
+    // a write after _end failed, the next record goes to a fresh sector
+    bool _torn;
+};
+
+#endif
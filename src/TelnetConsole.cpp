@@ -0,0 +1,266 @@
+#include "TelnetConsole.h"
+
+#define TELNET_SE   240
+#define TELNET_SB   250
+#define TELNET_WILL 251
+#define TELNET_DONT 254
+#define TELNET_IAC  255
+
+// input states of a session
+enum TelnetState
+{
+  TELNET_DATA,
+  TELNET_COMMAND,  // after IAC
+  TELNET_OPTION,   // after WILL, WONT, DO or DONT
+  TELNET_SUB,      // inside SB ... IAC SE
+  TELNET_SUB_IAC   // IAC inside a subnegotiation
+};
+
+size_t TelnetSession::write(uint8_t ch)
+{
+  return write(&ch, 1);
+}
+
+size_t TelnetSession::write(const uint8_t *buf, size_t size)
+{
+  if (!client || _overflow)
+    return 0;
+  // a reply longer than the queue, e.g. profile, fits once the start of
+  // it is in the socket
+  if (size > TELNET_QUEUE_SIZE - _used)
+    send();
+  if (size > TELNET_QUEUE_SIZE - _used)
+  {
+    // a partial line would garble the output, handle() drops the client
+    _overflow = true;
+    return 0;
+  }
+
+  size_t tail = (_head + _used) % TELNET_QUEUE_SIZE;
+  size_t first = min(size, TELNET_QUEUE_SIZE - tail);
+  memcpy(_queue + tail, buf, first);
+  memcpy(_queue, buf + first, size - first);
+  _used += size;
+  return size;
+}
+
+void TelnetSession::reset()
+{
+  _head = 0;
+  _used = 0;
+  _lineLen = 0;
+  _state = TELNET_DATA;
+  _overflow = false;
+}
+
+void TelnetSession::send()
+{
+  while (_used > 0)
+  {
+    size_t room = client.availableForWrite();
+    size_t len = min(min(_used, TELNET_QUEUE_SIZE - _head), room);
+    if (len == 0)
+      return;
+    size_t n = client.write((const uint8_t *)_queue + _head, len);
+    _head = (_head + n) % TELNET_QUEUE_SIZE;
+    _used -= n;
+    if (n < len)
+      return;
+  }
+  _head = 0;
+}
+
+void TelnetConsole::begin()
+{
+  _server.begin();
+  _server.setNoDelay(true);
+
+  addCommand("help", [this](Print &out, const String &args) {
+    (void)args;
+    for (size_t i = 0; i < _commands.size(); ++i)
+    {
+      out.print(_commands[i].name);
+      out.print('\t');
+      out.println(_commands[i].help);
+    }
+  }, "list commands");
+}
+
+void TelnetConsole::addCommand(const char *name, CommandFunction fn, const char *help)
+{
+  Command command;
+  command.name = name;
+  command.help = help;
+  command.fn = fn;
+  _commands.push_back(command);
+}
+
+int TelnetConsole::clients()
+{
+  int n = 0;
+  for (int i = 0; i < TELNET_MAX_CLIENTS; ++i)
+  {
+    if (_sessions[i].client.connected())
+      ++n;
+  }
+  return n;
+}
+
+void TelnetConsole::accept()
+{
+  while (_server.hasClient())
+  {
+    WiFiClient client = _server.available();
+    int slot = -1;
+    for (int i = 0; i < TELNET_MAX_CLIENTS && slot < 0; ++i)
+    {
+      if (!_sessions[i].client.connected())
+        slot = i;
+    }
+
+    if (slot < 0)
+    {
+      client.println("busy");
+      client.stop();
+      continue;
+    }
+
+    TelnetSession &session = _sessions[slot];
+    session.client.stop();
+    session.client = client;
+    session.client.setNoDelay(true);
+    session.reset();
+    session.println("type help for commands");
+  }
+}
+
+void TelnetConsole::handle()
+{
+  accept();
+
+  for (int i = 0; i < TELNET_MAX_CLIENTS; ++i)
+  {
+    TelnetSession &session = _sessions[i];
+    if (!session.client)
+      continue;
+    if (!session.client.connected())
+    {
+      session.client.stop();
+      continue;
+    }
+
+    receive(session);
+    if (session._overflow)
+    {
+      ++_dropped;
+      session.client.stop();
+      continue;
+    }
+    session.send();
+  }
+}
+
+void TelnetConsole::receive(TelnetSession &session)
+{
+  while (session.client.available() > 0)
+  {
+    int ch = session.client.read();
+    if (ch < 0)
+      return;
+
+    // commands are skipped: IAC verb option, IAC SB ... IAC SE and the
+    // two byte ones; IAC IAC is a 255 data byte
+    switch (session._state)
+    {
+    case TELNET_COMMAND:
+      if (ch == TELNET_SB)
+        session._state = TELNET_SUB;
+      else if (ch >= TELNET_WILL && ch <= TELNET_DONT)
+        session._state = TELNET_OPTION;
+      else
+        session._state = TELNET_DATA;
+      if (ch != TELNET_IAC)
+        continue;
+      break;
+    case TELNET_OPTION:
+      session._state = TELNET_DATA;
+      continue;
+    case TELNET_SUB:
+      if (ch == TELNET_IAC)
+        session._state = TELNET_SUB_IAC;
+      continue;
+    case TELNET_SUB_IAC:
+      session._state = ch == TELNET_SE ? TELNET_DATA : TELNET_SUB;
+      continue;
+    default:
+      if (ch == TELNET_IAC)
+      {
+        session._state = TELNET_COMMAND;
+        continue;
+      }
+      break;
+    }
+
+    if (ch == '\n' || ch == '\r')
+    {
+      if (session._lineLen > 0)
+        dispatch(session);
+      session._lineLen = 0;
+    }
+    else if (session._lineLen < TELNET_LINE_MAX - 1)
+    {
+      session._line[session._lineLen++] = ch;
+    }
+  }
+}
+
+void TelnetConsole::dispatch(TelnetSession &session)
+{
+  session._line[session._lineLen] = 0;
+  String line = session._line;
+  line.trim();
+
+  int space = line.indexOf(' ');
+  String name = space < 0 ? line : line.substring(0, space);
+  String args = space < 0 ? String() : line.substring(space + 1);
+  args.trim();
+
+  for (size_t i = 0; i < _commands.size(); ++i)
+  {
+    if (name == _commands[i].name)
+    {
+      _commands[i].fn(session, args);
+      return;
+    }
+  }
+  if (name.length() > 0)
+  {
+    session.print("unknown command: ");
+    session.println(name);
+  }
+}
+
+int TelnetConsole::availableForWrite()
+{
+  size_t room = TELNET_QUEUE_SIZE;
+  for (int i = 0; i < TELNET_MAX_CLIENTS; ++i)
+  {
+    TelnetSession &session = _sessions[i];
+    if (session.client && !session._overflow)
+      room = min(room, TELNET_QUEUE_SIZE - session._used);
+  }
+  return room;
+}
+
+size_t TelnetConsole::write(uint8_t ch)
+{
+  return write(&ch, 1);
+}
+
+size_t TelnetConsole::write(const uint8_t *buf, size_t size)
+{
+  for (int i = 0; i < TELNET_MAX_CLIENTS; ++i)
+    _sessions[i].write(buf, size);
+  // nobody is held up by a slow client, it is dropped instead
+  return size;
+}
@@ -0,0 +1,109 @@
+#ifndef TelnetConsole_h
+#define TelnetConsole_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WiFi.h>
+#include <functional>
+#include <vector>
+
+#ifndef TELNET_MAX_CLIENTS
+#define TELNET_MAX_CLIENTS  2
+#endif
+// output queued per client, a client that falls this far behind is dropped
+#ifndef TELNET_QUEUE_SIZE
+#define TELNET_QUEUE_SIZE   512
+#endif
+#ifndef TELNET_LINE_MAX
+#define TELNET_LINE_MAX     64
+#endif
+
+// One telnet connection. Printing to it queues output for that client
+// only, e.g. the reply to a command.
+class TelnetSession : public Print
+{
+  public:
+    TelnetSession() : _head(0), _used(0), _lineLen(0), _state(0), _overflow(false)
+    {
+    }
+
+    size_t write(uint8_t ch) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+
+    WiFiClient client;
+
+  protected:
+    friend class TelnetConsole;
+
+    void reset();
+    // sends what the socket takes without blocking
+    void send();
+
+    char _queue[TELNET_QUEUE_SIZE];
+    size_t _head;
+    size_t _used;
+    char _line[TELNET_LINE_MAX];
+    size_t _lineLen;
+    // where the input is in a telnet command, see receive()
+    uint8_t _state;
+    bool _overflow;
+};
+
+// Telnet server for up to TELNET_MAX_CLIENTS sessions.
+//
+// Writing to the console queues the output for every session; handle()
+// sends the queues as far as each socket accepts and drops a client
+// whose queue overflows. Input is read by lines and dispatched to the
+// commands added with addCommand(), "help" lists them.
+class TelnetConsole : public Stream
+{
+  public:
+    typedef std::function<void(Print &out, const String &args)> CommandFunction;
+
+    TelnetConsole(uint16_t port = 23) : _server(port), _dropped(0)
+    {
+    }
+
+    void begin();
+    void handle();
+
+    void addCommand(const char *name, CommandFunction fn, const char *help = "");
+
+    int clients();
+    // clients dropped for not keeping up with their output
+    uint32_t dropped() { return _dropped; }
+
+    size_t write(uint8_t ch) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    // room in the fullest session queue
+    int availableForWrite() override;
+
+    // input is consumed by the command dispatcher
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+
+  protected:
+    struct Command
+    {
+        const char *name;
+        const char *help;
+        CommandFunction fn;
+    };
+
+    void accept();
+    void receive(TelnetSession &session);
+    void dispatch(TelnetSession &session);
+
+    WiFiServer _server;
+    TelnetSession _sessions[TELNET_MAX_CLIENTS];
+    std::vector<Command> _commands;
+    uint32_t _dropped;
+};
+
+#endif
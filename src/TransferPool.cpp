@@ -0,0 +1,137 @@
+#include "TransferPool.h"
+
+void TransferPool::begin(size_t slots)
+{
+  _transfers.resize(slots);
+  for (size_t i = 0; i < _transfers.size(); ++i)
+    _transfers[i].state = TRANSFER_FREE;
+}
+
+bool TransferPool::available()
+{
+  return count(TRANSFER_FREE) > 0;
+}
+
+size_t TransferPool::count(TransferState state)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < _transfers.size(); ++i)
+  {
+    if (_transfers[i].state == state)
+      ++n;
+  }
+  return n;
+}
+
+size_t TransferPool::active()
+{
+  return count(TRANSFER_SENDING);
+}
+
+size_t TransferPool::idle()
+{
+  return count(TRANSFER_IDLE);
+}
+
+bool TransferPool::add(WiFiClient &client, File &file, size_t len, bool keepAlive)
+{
+  for (size_t i = 0; i < _transfers.size(); ++i)
+  {
+    Transfer &transfer = _transfers[i];
+    if (transfer.state != TRANSFER_FREE)
+      continue;
+
+    transfer.client = client;
+    // the chunks are what the send buffer takes, waiting for the ACK of
+    // the previous one before sending a short one only stalls the body
+    transfer.client.setNoDelay(true);
+    transfer.file = file;
+    transfer.left = len;
+    transfer.lastProgress = millis();
+    transfer.state = TRANSFER_SENDING;
+    transfer.keepAlive = keepAlive;
+    client = WiFiClient();
+    file = File();
+    return true;
+  }
+  return false;
+}
+
+void TransferPool::release(Transfer &transfer)
+{
+  // dropping the last reference closes without waiting for the client to
+  // acknowledge; queued data still goes out before the FIN
+  transfer.client = WiFiClient();
+  transfer.state = TRANSFER_FREE;
+}
+
+void TransferPool::finish(Transfer &transfer, bool complete)
+{
+  transfer.file.close();
+  transfer.file = File();
+  if (complete)
+    ++_completed;
+  else
+    ++_aborted;
+
+  if (complete && transfer.keepAlive)
+  {
+    transfer.state = TRANSFER_IDLE;
+    transfer.lastProgress = millis();
+    return;
+  }
+  release(transfer);
+}
+
+void TransferPool::handleIdle(Transfer &transfer)
+{
+  if (transfer.client.available())
+  {
+    // the server may be busy with another client, ask again next time
+    if (_onRequest && _onRequest(transfer.client))
+    {
+      ++_reused;
+      release(transfer);
+    }
+    return;
+  }
+  if (!transfer.client.connected() || millis() - transfer.lastProgress > TRANSFER_IDLE_TIMEOUT)
+    release(transfer);
+}
+
+void TransferPool::handle()
+{
+  uint8_t buf[TRANSFER_CHUNK];
+  for (size_t i = 0; i < _transfers.size(); ++i)
+  {
+    Transfer &transfer = _transfers[i];
+    if (transfer.state == TRANSFER_IDLE)
+      handleIdle(transfer);
+    if (transfer.state != TRANSFER_SENDING)
+      continue;
+    if (!transfer.client.connected())
+    {
+      finish(transfer, false);
+      continue;
+    }
+
+    size_t room = transfer.client.availableForWrite();
+    if (room == 0)
+    {
+      if (millis() - transfer.lastProgress > TRANSFER_TIMEOUT)
+        finish(transfer, false);
+      continue;
+    }
+
+    size_t n = transfer.file.read(buf, min(min(room, sizeof(buf)), transfer.left));
+    if (n == 0 || transfer.client.write((const uint8_t *)buf, n) != n)
+    {
+      finish(transfer, false);
+      continue;
+    }
+    transfer.left -= n;
+    transfer.lastProgress = millis();
+    if (transfer.left == 0)
+      finish(transfer, true);
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef TransferPool_h
+#define TransferPool_h
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ESP8266WiFi.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+// transfers in flight at once, by default
+#ifndef TRANSFER_SLOTS
+#define TRANSFER_SLOTS      4
+#endif
+// bytes written to one client per handle()
+#define TRANSFER_CHUNK      1024
+// smaller bodies fit the send buffer and are written in the request
+#define TRANSFER_MIN_SIZE   1460
+// ms a client may take no data before it is dropped
+#define TRANSFER_TIMEOUT    10000
+// ms a kept-alive connection may wait for its next request
+#define TRANSFER_IDLE_TIMEOUT 5000
+
+enum TransferState
+{
+    TRANSFER_FREE,
+    TRANSFER_SENDING,
+    // body sent, waiting for the next request on the connection
+    TRANSFER_IDLE
+};
+
+struct Transfer
+{
+    WiFiClient client;
+    File file;
+    size_t left;
+    unsigned long lastProgress;
+    TransferState state;
+    bool keepAlive;
+};
+
+// takes over a connection with a request waiting, false to be asked again
+typedef std::function<bool(WiFiClient &client)> TransferClientFunction;
+
+// File bodies sent in the background, so a slow client holds a slot here
+// instead of the whole loop. The handler sends the headers and hands over
+// the connection and the file; handle() then writes only what each send
+// buffer takes and never waits. A client gets the slot until its body is
+// out. Then the connection is closed, or, when kept alive, held until the
+// client sends its next request, which is passed to onRequest().
+class TransferPool
+{
+  public:
+    TransferPool() : _completed(0), _aborted(0), _reused(0)
+    {
+    }
+
+    void begin(size_t slots);
+    bool enabled() { return !_transfers.empty(); }
+    // a slot is free; idle connections keep theirs until they close
+    bool available();
+
+    // file is read from its position; the caller's file and client are
+    // left empty, closing them afterwards does not end the transfer
+    bool add(WiFiClient &client, File &file, size_t len, bool keepAlive = false);
+    void handle();
+    void onRequest(TransferClientFunction fn) { _onRequest = fn; }
+
+    size_t active();
+    size_t idle();
+    uint32_t completed() { return _completed; }
+    uint32_t aborted() { return _aborted; }
+    // kept-alive connections handed back with a new request
+    uint32_t reused() { return _reused; }
+
+  protected:
+    void finish(Transfer &transfer, bool complete);
+    void release(Transfer &transfer);
+    void handleIdle(Transfer &transfer);
+    size_t count(TransferState state);
+
+    std::vector<Transfer> _transfers;
+    TransferClientFunction _onRequest;
+    uint32_t _completed;
+    uint32_t _aborted;
+    uint32_t _reused;
+};
+
+#endif
@@ -0,0 +1,367 @@
+#include "HostTest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace hosttest
+{
+
+static int checks = 0;
+static int failures = 0;
+
+bool check(bool ok, const char *expr, const char *file, int line)
+{
+  ++checks;
+  if (!ok)
+  {
+    ++failures;
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+  }
+  return ok;
+}
+
+int report()
+{
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
+
+Sandbox::Sandbox()
+{
+  _dir = host::makeTempDir("serverhelper").c_str();
+  host::setFsRoot(path("spiffs").c_str());
+  host::setEepromFile(path("eeprom.bin").c_str());
+  host::setPortOffset(host::PORT_EPHEMERAL);
+  host::resetFlash();
+  host::clearNetworks();
+  SPIFFS.begin();
+}
+
+Sandbox::~Sandbox()
+{
+  host::removeTree(_dir.c_str());
+}
+
+std::string Sandbox::path(const char *name) const
+{
+  return _dir + "/" + name;
+}
+
+void Sandbox::writeFile(const char *name, const std::string &content)
+{
+  File f = SPIFFS.open(name, "w");
+  f.write((const uint8_t *)content.data(), content.size());
+  f.close();
+}
+
+std::string Sandbox::readFile(const char *name)
+{
+  File f = SPIFFS.open(name, "r");
+  std::string content;
+  if (!f)
+    return content;
+  content.resize(f.size());
+  content.resize(f.read((uint8_t *)&content[0], content.size()));
+  return content;
+}
+
+std::string Response::header(const char *name) const
+{
+  std::string key = name;
+  for (size_t i = 0; i < key.size(); ++i)
+    key[i] = tolower((unsigned char)key[i]);
+  std::map<std::string, std::string>::const_iterator it = headers.find(key);
+  return it == headers.end() ? std::string() : it->second;
+}
+
+Response parse(const std::string &raw)
+{
+  Response r;
+  r.status = 0;
+  r.raw = raw;
+  size_t end = raw.find("\r\n\r\n");
+  if (raw.compare(0, 5, "HTTP/") != 0 || end == std::string::npos)
+    return r;
+  r.status = atoi(raw.c_str() + raw.find(' ') + 1);
+
+  size_t line = raw.find("\r\n") + 2;
+  while (line < end)
+  {
+    size_t next = raw.find("\r\n", line);
+    size_t colon = raw.find(':', line);
+    if (colon < next)
+    {
+      std::string name = raw.substr(line, colon - line);
+      for (size_t i = 0; i < name.size(); ++i)
+        name[i] = tolower((unsigned char)name[i]);
+      size_t value = raw.find_first_not_of(' ', colon + 1);
+      r.headers[name] = raw.substr(value, next - value);
+    }
+    line = next + 2;
+  }
+
+  std::string body = raw.substr(end + 4);
+  if (r.header("transfer-encoding") != "chunked")
+  {
+    r.body = body;
+    return r;
+  }
+  size_t pos = 0;
+  while (pos < body.size())
+  {
+    size_t eol = body.find("\r\n", pos);
+    if (eol == std::string::npos)
+      break;
+    size_t len = strtoul(body.c_str() + pos, NULL, 16);
+    if (len == 0)
+      break;
+    r.body += body.substr(eol + 2, len);
+    pos = eol + 2 + len + 2;
+  }
+  return r;
+}
+
+// a response is complete once its Content-Length or the last chunk
+// arrived, the server keeps the connection until the client closes it
+bool complete(const std::string &raw)
+{
+  size_t end = raw.find("\r\n\r\n");
+  if (end == std::string::npos)
+    return false;
+  Response r = parse(raw);
+  if (r.status == 304 || r.status == 204)
+    return true;
+  if (r.header("transfer-encoding") == "chunked")
+    return raw.find("\r\n0\r\n\r\n", end) != std::string::npos;
+  std::string length = r.header("content-length");
+  if (length.empty())
+    return false;
+  return raw.size() - end - 4 >= strtoul(length.c_str(), NULL, 10);
+}
+
+int connectTo(uint16_t port)
+{
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    close(fd);
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+void sendAll(int fd, const std::string &data)
+{
+  size_t sent = 0;
+  while (sent < data.size())
+  {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      break;
+    sent += n;
+  }
+}
+
+std::string receive(int fd, unsigned long timeoutMs)
+{
+  std::string data;
+  char buf[4096];
+  struct pollfd p = {fd, POLLIN, 0};
+  if (poll(&p, 1, timeoutMs) <= 0)
+    return data;
+  for (;;)
+  {
+    ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n <= 0)
+      break;
+    data.append(buf, n);
+  }
+  return data;
+}
+
+std::string readResponse(int fd, unsigned long timeoutMs)
+{
+  std::string response;
+  uint64_t deadline = nowMicros() + timeoutMs * 1000ULL;
+  char buf[4096];
+  while (nowMicros() < deadline)
+  {
+    struct pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, 50) <= 0)
+      continue;
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    response.append(buf, n);
+    if (complete(response))
+      break;
+  }
+  return response;
+}
+
+std::string exchange(uint16_t port, const std::string &request, unsigned long timeoutMs)
+{
+  int fd = connectTo(port);
+  if (fd < 0)
+    return std::string();
+  sendAll(fd, request);
+  std::string response = readResponse(fd, timeoutMs);
+  close(fd);
+  return response;
+}
+
+bool pump(ServerHelper &helper, std::function<bool()> done, unsigned long timeoutMs)
+{
+  uint64_t deadline = nowMicros() + timeoutMs * 1000ULL;
+  while (!done())
+  {
+    if (nowMicros() > deadline)
+      return false;
+    helper.loop();
+    // the device sleeps in delay(0) between loops, do not spin a core
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  return true;
+}
+
+Response request(ServerHelper &helper, const std::string &request)
+{
+  uint16_t port = httpPort();
+  std::future<std::string> raw = std::async(std::launch::async, [=]() { return exchange(port, request); });
+  pump(helper, [&]() { return raw.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }, 15000);
+  return parse(raw.get());
+}
+
+Response get(ServerHelper &helper, const std::string &uri, const std::string &headers)
+{
+  return request(helper, "GET " + uri + " HTTP/1.1\r\nHost: device\r\n" + headers + "\r\n");
+}
+
+Response upload(ServerHelper &helper, const std::string &name, const std::string &content, const std::string &headers,
+                const std::string &uri)
+{
+  const std::string boundary = "----hosttestboundary";
+  std::string body = "--" + boundary + "\r\n";
+  body += "Content-Disposition: form-data; name=\"data\"; filename=\"" + name + "\"\r\n";
+  body += "Content-Type: application/octet-stream\r\n\r\n";
+  body += content;
+  body += "\r\n--" + boundary + "--\r\n";
+  return request(helper, "POST " + uri + " HTTP/1.1\r\nHost: device\r\n"
+                         "Content-Type: multipart/form-data; boundary=" +
+                             boundary + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n" + headers + "\r\n" + body);
+}
+
+static void noHandler()
+{
+}
+
+void boot(ServerHelper &helper, void (*handler)(void))
+{
+  helper.setHandlers(handler ? handler : noHandler, handler ? handler : noHandler);
+  helper.setup();
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_AP; }, 5000);
+}
+
+LoadResult load(ServerHelper &helper, int clients, int count, const std::string &uri, size_t size)
+{
+  uint16_t port = httpPort();
+  std::vector<std::future<std::vector<uint64_t>>> threads;
+  uint64_t start = nowMicros();
+  for (int c = 0; c < clients; ++c)
+  {
+    threads.push_back(std::async(std::launch::async, [=]() {
+      std::vector<uint64_t> latencies;
+      int fd = -1;
+      for (int i = 0; i < count; ++i)
+      {
+        uint64_t t = nowMicros();
+        if (fd < 0)
+          fd = connectTo(port);
+        sendAll(fd, "GET " + uri + " HTTP/1.1\r\nHost: device\r\n\r\n");
+        Response r = parse(readResponse(fd));
+        bool ok = r.status == 200 && r.body.size() == size;
+        latencies.push_back(ok ? nowMicros() - t : 0);
+        // a closed connection is opened again, as a browser does
+        if (!ok || r.header("connection") != "keep-alive")
+        {
+          close(fd);
+          fd = -1;
+        }
+      }
+      if (fd >= 0)
+        close(fd);
+      return latencies;
+    }));
+  }
+
+  size_t done = 0;
+  pump(helper, [&]() {
+    while (done < threads.size() && threads[done].wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      ++done;
+    return done == threads.size();
+  }, 60000);
+
+  LoadResult result;
+  result.elapsed = nowMicros() - start;
+  result.failed = 0;
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    std::vector<uint64_t> latencies = threads[i].get();
+    for (size_t j = 0; j < latencies.size(); ++j)
+    {
+      if (latencies[j])
+        result.latencies.push_back(latencies[j]);
+      else
+        ++result.failed;
+    }
+  }
+  std::sort(result.latencies.begin(), result.latencies.end());
+  result.bytes = result.latencies.size() * size;
+  return result;
+}
+
+uint64_t LoadResult::percentile(double p) const
+{
+  if (latencies.empty())
+    return 0;
+  size_t i = (size_t)(p / 100 * latencies.size());
+  return latencies[min(i, latencies.size() - 1)];
+}
+
+uint16_t httpPort()
+{
+  return host::boundPort(80);
+}
+
+uint64_t threadCpuMicros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+uint64_t nowMicros()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace hosttest
@@ -0,0 +1,111 @@
+#ifndef HostTest_h
+#define HostTest_h
+
+#include "ServerHelper.h"
+#include "HostSim.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Small harness for the host tests: checks, a sandbox for the simulated
+// filesystem, EEPROM and flash, and a raw HTTP client. The server runs in
+// the calling thread, requests are made from a second one while loop()
+// is pumped, as on the device.
+namespace hosttest
+{
+
+bool check(bool ok, const char *expr, const char *file, int line);
+// exit code of a test, prints the summary
+int report();
+
+#define CHECK(cond) hosttest::check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b) hosttest::check((a) == (b), #a " == " #b, __FILE__, __LINE__)
+
+// a fresh directory for SPIFFS and the EEPROM file, the server on an
+// ephemeral port and an erased flash; removed again on destruction
+class Sandbox
+{
+  public:
+    Sandbox();
+    ~Sandbox();
+
+    std::string path(const char *name) const;
+    // writes a file into the simulated SPIFFS
+    void writeFile(const char *name, const std::string &content);
+    std::string readFile(const char *name);
+
+  private:
+    std::string _dir;
+};
+
+struct Response
+{
+    int status;
+    // names in lower case
+    std::map<std::string, std::string> headers;
+    // with the chunked framing removed
+    std::string body;
+    std::string raw;
+
+    std::string header(const char *name) const;
+};
+
+// parses a complete response, status 0 when it is not one
+Response parse(const std::string &raw);
+
+// a connection the test keeps open itself, e.g. to /events; -1 on failure
+int connectTo(uint16_t port);
+void sendAll(int fd, const std::string &data);
+// what arrives on fd within timeoutMs, returns early once something came
+std::string receive(int fd, unsigned long timeoutMs = 1000);
+
+// true once raw holds a whole response, by its length or last chunk
+bool complete(const std::string &raw);
+// reads one response from fd, the connection is left open
+std::string readResponse(int fd, unsigned long timeoutMs = 10000);
+
+// sends the request to 127.0.0.1:port and reads the response, until
+// the server closes when it has no length
+std::string exchange(uint16_t port, const std::string &request, unsigned long timeoutMs = 10000);
+
+// calls helper.loop() until done() or the timeout, false on the timeout
+bool pump(ServerHelper &helper, std::function<bool()> done, unsigned long timeoutMs = 10000);
+
+// runs the request against the helper's web server
+Response request(ServerHelper &helper, const std::string &request);
+Response get(ServerHelper &helper, const std::string &uri, const std::string &headers = "");
+
+// POST of one file as multipart/form-data, to /upload by default
+Response upload(ServerHelper &helper, const std::string &name, const std::string &content, const std::string &headers = "",
+                const std::string &uri = "/upload");
+
+struct LoadResult
+{
+    // of the requests that got the whole body, sorted, in microseconds
+    std::vector<uint64_t> latencies;
+    int failed;
+    size_t bytes;
+    uint64_t elapsed;
+
+    uint64_t percentile(double p) const;
+};
+
+// clients threads each GET uri count times, keeping the connection while
+// the server allows it; a response counts when it is 200 with size bytes
+LoadResult load(ServerHelper &helper, int clients, int count, const std::string &uri, size_t size);
+
+// boots the helper without stored WiFi credentials, so it opens the AP
+// and its web server; handler is installed for both modes
+void boot(ServerHelper &helper, void (*handler)(void) = NULL);
+uint16_t httpPort();
+
+// monotonic time for measurements, in microseconds
+uint64_t nowMicros();
+// CPU time of the calling thread, in microseconds
+uint64_t threadCpuMicros();
+
+} // namespace hosttest
+
+#endif
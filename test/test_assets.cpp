@@ -0,0 +1,115 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// The asset bundle: compressed entries, their plain copies and ?download.
+// A hand-written table in the layout tools/pack_assets.py generates.
+
+static const char page0Path[] PROGMEM = "/app.js";
+static const char page0Type[] PROGMEM = "application/javascript";
+static const char page0ETag[] PROGMEM = "\"a-1\"";
+static const uint8_t page0Data[] PROGMEM = {'c', 'o', 'm', 'p', 'r', 'e', 's', 's', 'e', 'd'};
+static const char page0PlainETag[] PROGMEM = "\"5-2\"";
+static const uint8_t page0Plain[] PROGMEM = {'p', 'l', 'a', 'i', 'n'};
+
+static const char page1Path[] PROGMEM = "/index.html";
+static const char page1Type[] PROGMEM = "text/html";
+static const char page1ETag[] PROGMEM = "\"a-3\"";
+static const uint8_t page1Data[] PROGMEM = {'c', 'o', 'm', 'p', 'r', 'e', 's', 's', 'e', 'd'};
+
+static const char page2Path[] PROGMEM = "/logo.png";
+static const char page2Type[] PROGMEM = "image/png";
+static const char page2ETag[] PROGMEM = "\"3-4\"";
+static const uint8_t page2Data[] PROGMEM = {'p', 'n', 'g'};
+
+static const char page3Path[] PROGMEM = "/style.css";
+static const char page3Type[] PROGMEM = "text/css";
+static const char page3ETag[] PROGMEM = "\"a-5\"";
+static const uint8_t page3Data[] PROGMEM = {'c', 'o', 'm', 'p', 'r', 'e', 's', 's', 'e', 'd'};
+
+static const AssetEntry pages[] PROGMEM = {
+  {page0Path, page0Type, page0ETag, page0Data, 10, ASSET_GZIP, page0PlainETag, page0Plain, 5},
+  {page1Path, page1Type, page1ETag, page1Data, 10, ASSET_GZIP, NULL, NULL, 0},
+  {page2Path, page2Type, page2ETag, page2Data, 3, 0, NULL, NULL, 0},
+  {page3Path, page3Type, page3ETag, page3Data, 10, ASSET_GZIP, NULL, NULL, 0},
+};
+
+static const std::string gzip = "Accept-Encoding: gzip\r\n";
+
+static void testGzip(ServerHelper &helper)
+{
+  Response r = get(helper, "/app.js", gzip);
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("compressed"));
+  CHECK_EQ(r.header("content-encoding"), std::string("gzip"));
+  CHECK_EQ(r.header("content-type"), std::string("application/javascript"));
+  CHECK_EQ(r.header("vary"), std::string("Accept-Encoding"));
+  CHECK_EQ(r.header("etag"), std::string("\"a-1\""));
+
+  r = get(helper, "/app.js", gzip + "If-None-Match: \"a-1\"\r\n");
+  CHECK_EQ(r.status, 304);
+
+  r = get(helper, "/logo.png");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("png"));
+  CHECK_EQ(r.header("content-encoding"), std::string());
+  CHECK_EQ(r.header("vary"), std::string());
+}
+
+static void testPlain(ServerHelper &helper)
+{
+  // the bundle's plain copy, with an ETag of its own
+  Response r = get(helper, "/app.js");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("plain"));
+  CHECK_EQ(r.header("content-encoding"), std::string());
+  CHECK_EQ(r.header("vary"), std::string("Accept-Encoding"));
+  CHECK_EQ(r.header("etag"), std::string("\"5-2\""));
+  r = get(helper, "/app.js", "Accept-Encoding: gzip;q=0\r\nIf-None-Match: \"5-2\"\r\n");
+  CHECK_EQ(r.status, 304);
+  r = get(helper, "/app.js", "If-None-Match: \"a-1\"\r\n");
+  CHECK_EQ(r.status, 200);
+
+  // none in the bundle, the filesystem's
+  r = get(helper, "/style.css");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("body{}"));
+  CHECK_EQ(r.header("content-encoding"), std::string());
+
+  // none anywhere, the compressed bytes rather than a 404
+  r = get(helper, "/index.html", "Accept-Encoding: identity\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("compressed"));
+  CHECK_EQ(r.header("content-encoding"), std::string("gzip"));
+}
+
+static void testDownload(ServerHelper &helper)
+{
+  Response r = get(helper, "/app.js?download=1", gzip);
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("plain"));
+  CHECK_EQ(r.header("content-type"), std::string("application/octet-stream"));
+  CHECK_EQ(r.header("content-encoding"), std::string());
+
+  r = get(helper, "/style.css?download=1", gzip);
+  CHECK_EQ(r.body, std::string("body{}"));
+  CHECK_EQ(r.header("content-type"), std::string("application/octet-stream"));
+
+  r = get(helper, "/logo.png?download=1");
+  CHECK_EQ(r.body, std::string("png"));
+  CHECK_EQ(r.header("content-type"), std::string("application/octet-stream"));
+}
+
+int main()
+{
+  Sandbox box;
+  box.writeFile("/style.css", "body{}");
+  ServerHelper helper(NULL);
+  helper.setAssets(pages);
+  boot(helper);
+  CHECK_EQ(helper.assets.count(), (size_t)4);
+  testGzip(helper);
+  testPlain(helper);
+  testDownload(helper);
+  return report();
+}
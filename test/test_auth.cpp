@@ -0,0 +1,113 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// Basic auth, session cookies and the lockout after failed attempts.
+
+// admin:admin
+static const char *goodBasic = "Authorization: Basic YWRtaW46YWRtaW4=\r\n";
+// admin:wrong
+static const char *badBasic = "Authorization: Basic YWRtaW46d3Jvbmc=\r\n";
+
+static std::string hex(const uint8_t *data, size_t len)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string s;
+  for (size_t i = 0; i < len; ++i)
+  {
+    s += digits[data[i] >> 4];
+    s += digits[data[i] & 15];
+  }
+  return s;
+}
+
+static void testDigests()
+{
+  uint8_t digest[br_sha256_SIZE];
+  br_sha256_context sha;
+  br_sha256_init(&sha);
+  br_sha256_update(&sha, "abc", 3);
+  br_sha256_out(&sha, digest);
+  CHECK_EQ(hex(digest, sizeof(digest)), std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+  // RFC 4231, test case 2
+  br_hmac_key_context key;
+  br_hmac_key_init(&key, &br_sha256_vtable, "Jefe", 4);
+  br_hmac_context hmac;
+  br_hmac_init(&hmac, &key, 0);
+  br_hmac_update(&hmac, "what do ya want ", 16);
+  br_hmac_update(&hmac, "for nothing?", 12);
+  CHECK_EQ(br_hmac_out(&hmac, digest), (size_t)br_sha256_SIZE);
+  CHECK_EQ(hex(digest, sizeof(digest)), std::string("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+}
+
+static void testTokens()
+{
+  SessionAuth auth;
+  auth.begin();
+  char token[SESSION_TOKEN_SIZE + 1];
+  auth.issue(token);
+  CHECK(auth.validate(token, strlen(token)));
+  token[SESSION_TOKEN_SIZE - 1] ^= 1;
+  CHECK(!auth.validate(token, strlen(token)));
+}
+
+static std::string login(ServerHelper &helper)
+{
+  std::string body = "username=admin&password=admin";
+  Response r = request(helper, "POST /login HTTP/1.1\r\nHost: device\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+  CHECK_EQ(r.status, 200);
+  std::string cookie = r.header("set-cookie");
+  return "Cookie: " + cookie.substr(0, cookie.find(';')) + "\r\n";
+}
+
+static void lockOut(ServerHelper &helper)
+{
+  for (int i = 0; i < AUTH_MAX_FAILURES; ++i)
+    CHECK_EQ(get(helper, "/config", badBasic).status, 401);
+  CHECK_EQ(get(helper, "/config", badBasic).status, 429);
+}
+
+static void testCookieDuringLockout(ServerHelper &helper)
+{
+  std::string cookie = login(helper);
+  lockOut(helper);
+  CHECK_EQ(get(helper, "/config", goodBasic).status, 429);
+  // a session from before the lockout goes on working
+  CHECK_EQ(get(helper, "/config", cookie).status, 200);
+}
+
+static void testUploadCountsOnce(ServerHelper &helper)
+{
+  // several chunks, each one checked
+  Response r = upload(helper, "big.bin", std::string(20000, 'x'), badBasic);
+  CHECK_EQ(r.status, 401);
+  CHECK(!SPIFFS.exists("/big.bin"));
+  for (int i = 1; i < AUTH_MAX_FAILURES; ++i)
+    CHECK_EQ(get(helper, "/config", badBasic).status, 401);
+  CHECK_EQ(get(helper, "/config", badBasic).status, 429);
+}
+
+int main()
+{
+  testDigests();
+  testTokens();
+
+  {
+    Sandbox box;
+    ServerHelper helper(NULL);
+    helper.useSessionAuth(3600);
+    helper.active_auth_mode();
+    boot(helper);
+    testCookieDuringLockout(helper);
+  }
+  {
+    Sandbox box;
+    ServerHelper helper(NULL);
+    helper.active_auth_mode();
+    boot(helper);
+    testUploadCountsOnce(helper);
+  }
+  return report();
+}
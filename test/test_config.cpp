@@ -0,0 +1,286 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// PATCH /config with a new network while connected: the helper joins it
+// like at boot, and falls back to the access point when it cannot. The
+// EEPROM commits of both /config handlers, and the record read from the
+// layout of earlier versions.
+
+static int launches = 0;
+
+static void countLaunch()
+{
+  ++launches;
+}
+
+static void addNetwork(const char *ssid, const char *pass)
+{
+  host::Network net;
+  net.ssid = ssid;
+  net.pass = pass;
+  net.rssi = -50;
+  net.channel = 6;
+  memset(net.bssid, 0, sizeof(net.bssid));
+  net.bssid[5] = (uint8_t)strlen(ssid);
+  net.encrypted = true;
+  net.connectDelay = 100;
+  host::addNetwork(net);
+}
+
+static Response patchConfig(ServerHelper &helper, const std::string &json)
+{
+  return request(helper, "PATCH /config HTTP/1.1\r\nHost: device\r\nContent-Type: application/json\r\n"
+                         "Content-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json);
+}
+
+// boots with "home" stored, as after a first join from the access point
+static void bootConnected(ServerHelper &helper)
+{
+  EEPROM.begin(E_EEPROM_SIZE);
+  helper.resetConfig();
+  strcpy(helper.config.ssid, "home");
+  strcpy(helper.config.pass, "homepass");
+  helper.saveConfig();
+
+  launches = 0;
+  helper.setHandlers(countLaunch, countLaunch);
+  helper.setup();
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_CONNECTED; }, 5000);
+}
+
+static void testJoin()
+{
+  Sandbox box;
+  addNetwork("home", "homepass");
+  addNetwork("office", "officepass");
+  ServerHelper helper;
+  bootConnected(helper);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(launches, 1);
+
+  Response r = patchConfig(helper, "{\"ssid\":\"office\",\"pass\":\"officepass\"}");
+  CHECK_EQ(r.status, 200);
+  CHECK(r.body.find("\"restart\":false") != std::string::npos);
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_CONNECTING; }, 5000);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_CONNECTING);
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_CONNECTED; }, 5000);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(WiFi.SSID(), String("office"));
+
+  // the routes are not registered a second time
+  CHECK_EQ(launches, 1);
+  CHECK_EQ(get(helper, "/config").status, 200);
+}
+
+static void testFallback()
+{
+  Sandbox box;
+  addNetwork("home", "homepass");
+  ServerHelper helper;
+  bootConnected(helper);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_CONNECTED);
+  helper.setWifiTimeout(500);
+
+  Response r = patchConfig(helper, "{\"ssid\":\"nowhere\",\"pass\":\"wrongpass\"}");
+  CHECK_EQ(r.status, 200);
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_CONNECTING; }, 5000);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_CONNECTING);
+
+  // no endless reconnecting, the access point opens after the timeout
+  uint32_t begins = host::wifiBegins();
+  pump(helper, [&]() { return helper.wifiState == WIFI_STATE_AP; }, 5000);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_AP);
+  CHECK(host::wifiBegins() - begins <= 1);
+  CHECK_EQ(launches, 1);
+  CHECK_EQ(get(helper, "/config").status, 200);
+}
+
+// one EEPROM commit per accepted document, none for one that changes nothing
+static void testCommitCount()
+{
+  Sandbox box;
+  addNetwork("home", "homepass");
+  ServerHelper helper;
+  bootConnected(helper);
+
+  uint32_t commits = host::eepromCommits();
+  Response r = patchConfig(helper, "{\"name\":\"kitchen\",\"user\":\"root\",\"userPass\":\"secret\","
+                                   "\"ip\":\"192.168.1.50\",\"gateway\":\"192.168.1.1\",\"subnet\":\"255.255.255.0\"}");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(host::eepromCommits(), commits + 1);
+
+  r = patchConfig(helper, "{\"name\":\"kitchen\"}");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(host::eepromCommits(), commits + 1);
+
+  // refused as a whole, nothing written
+  r = patchConfig(helper, "{\"name\":\"hall\",\"ip\":\"300.1.1.1\"}");
+  CHECK_EQ(r.status, 400);
+  CHECK_EQ(host::eepromCommits(), commits + 1);
+  CHECK_EQ(String(helper.config.name), String("kitchen"));
+}
+
+// a static address and back: null clears the whole address set, and the
+// station's DHCP client runs again
+static void testDhcp()
+{
+  Sandbox box;
+  addNetwork("home", "homepass");
+  ServerHelper helper;
+  bootConnected(helper);
+
+  Response r = patchConfig(helper, "{\"ip\":\"192.168.1.50\",\"gateway\":\"192.168.1.1\","
+                                   "\"subnet\":\"255.255.255.0\",\"dns\":\"1.1.1.1\"}");
+  CHECK_EQ(r.status, 200);
+  pump(helper, [&]() { return !host::wifiDhcp(); }, 5000);
+  CHECK(!host::wifiDhcp());
+  CHECK(WiFi.localIP() == IPAddress(192, 168, 1, 50));
+
+  r = patchConfig(helper, "{\"ip\":null}");
+  CHECK_EQ(r.status, 200);
+  pump(helper, [&]() { return host::wifiDhcp(); }, 5000);
+  CHECK(host::wifiDhcp());
+  CHECK(WiFi.localIP() != IPAddress(192, 168, 1, 50));
+
+  ServerHelper next;
+  CHECK(next.loadConfig());
+  CHECK_EQ(next.config.ip, (uint32_t)0);
+  CHECK_EQ(next.config.gateway, (uint32_t)0);
+  CHECK_EQ(next.config.subnet, (uint32_t)0);
+  CHECK_EQ(next.config.dns, (uint32_t)0);
+}
+
+// the form handler stages every field and commits once
+static void testPostCommitCount()
+{
+  Sandbox box;
+  addNetwork("home", "homepass");
+  ServerHelper helper;
+  bootConnected(helper);
+
+  uint32_t commits = host::eepromCommits();
+  std::string form = "ssid=office&pass=officepass&username=root&userpass=secret&ip=192.168.1.50"
+                     "&gateway=192.168.1.1&subnet=255.255.255.0&dns=1.1.1.1&name=kitchen";
+  Response r = request(helper, "POST /config HTTP/1.1\r\nHost: device\r\n"
+                               "Content-Type: application/x-www-form-urlencoded\r\n"
+                               "Content-Length: " + std::to_string(form.size()) + "\r\n\r\n" + form);
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(host::eepromCommits(), commits + 1);
+
+  // all of it in the one commit
+  ServerHelper next;
+  CHECK(next.loadConfig());
+  CHECK_EQ(String(next.config.ssid), String("office"));
+  CHECK_EQ(String(next.config.pass), String("officepass"));
+  CHECK_EQ(String(next.config.user), String("root"));
+  CHECK_EQ(String(next.config.userPass), String("secret"));
+  CHECK_EQ(String(next.config.name), String("kitchen"));
+  CHECK_EQ(next.config.ip, (uint32_t)IPAddress(192, 168, 1, 50));
+  CHECK_EQ(next.config.dns, (uint32_t)IPAddress(1, 1, 1, 1));
+}
+
+// fixed-width ASCII fields of earlier versions, unused bytes left 0xFF
+static void writeLegacy(int addr, const char *value)
+{
+  for (size_t i = 0; i < strlen(value); ++i)
+    EEPROM.write(addr + i, value[i]);
+}
+
+static void seedLegacy(const char *gateway)
+{
+  EEPROM.begin(E_EEPROM_SIZE);
+  for (int i = 0; i < E_EEPROM_SIZE; ++i)
+    EEPROM.write(i, 0xFF);
+  writeLegacy(E_NAME_ADDR, "kitchen");
+  writeLegacy(E_SSID_ADDR, "home");
+  // as long as the field, no terminator
+  writeLegacy(E_PASS_ADDR, "0123456789abcdef0123456789abcdef");
+  writeLegacy(E_AUSER_ADDR, "admin");
+  writeLegacy(E_APASS_ADDR, "secret");
+  writeLegacy(E_IP_ADDR, "192.168.1.50");
+  writeLegacy(E_GATEWAY_ADDR, gateway);
+  writeLegacy(E_SUBNET_ADDR, "255.255.255.0");
+  writeLegacy(E_DNS_ADDR, "8.8.8.8");
+  const uint8_t bssid[E_BSSID_SIZE] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc};
+  for (int i = 0; i < E_BSSID_SIZE; ++i)
+    EEPROM.write(E_BSSID_ADDR + i, bssid[i]);
+  EEPROM.write(E_CHANNEL_ADDR, 6);
+  EEPROM.commit();
+}
+
+static void testMigrate()
+{
+  Sandbox box;
+  seedLegacy("192.168.1.1");
+  {
+    ServerHelper helper;
+    CHECK(!helper.loadConfig());
+  }
+
+  // migrated once, read as a record from then on
+  ServerHelper helper;
+  uint32_t commits = host::eepromCommits();
+  CHECK(helper.loadConfig());
+  CHECK_EQ(host::eepromCommits(), commits);
+  CHECK_EQ(String(helper.config.name), String("kitchen"));
+  CHECK_EQ(String(helper.config.ssid), String("home"));
+  CHECK_EQ(String(helper.config.pass), String("0123456789abcdef0123456789abcdef"));
+  CHECK_EQ(String(helper.config.user), String("admin"));
+  CHECK_EQ(String(helper.config.userPass), String("secret"));
+  CHECK_EQ(helper.config.ip, (uint32_t)IPAddress(192, 168, 1, 50));
+  CHECK_EQ(helper.config.gateway, (uint32_t)IPAddress(192, 168, 1, 1));
+  CHECK_EQ(helper.config.subnet, (uint32_t)IPAddress(255, 255, 255, 0));
+  CHECK_EQ(helper.config.dns, (uint32_t)IPAddress(8, 8, 8, 8));
+  CHECK_EQ(helper.config.bssid[0], 0x12);
+  CHECK_EQ(helper.config.bssid[5], 0xbc);
+  CHECK_EQ(helper.config.channel, 6);
+
+  // a set of addresses with one missing is DHCP, not half an address
+  seedLegacy("");
+  ServerHelper partial;
+  CHECK(!partial.loadConfig());
+  CHECK_EQ(String(partial.config.ssid), String("home"));
+  CHECK_EQ(partial.config.ip, (uint32_t)0);
+  CHECK_EQ(partial.config.gateway, (uint32_t)0);
+}
+
+// a record of ours with a bad CRC is not read as the legacy layout
+static void testCorruptRecord()
+{
+  Sandbox box;
+  {
+    ServerHelper helper;
+    EEPROM.begin(E_EEPROM_SIZE);
+    helper.resetConfig();
+    strcpy(helper.config.name, "kitchen-and-living");
+    strcpy(helper.config.ssid, "home");
+    strcpy(helper.config.pass, "homepass");
+    helper.saveConfig();
+  }
+  EEPROM.write(CONFIG_ADDR + offsetof(ConfigRecord, ssid), 'H');
+  EEPROM.commit();
+
+  ServerHelper helper;
+  CHECK(!helper.loadConfig());
+  CHECK_EQ(helper.config.magic, (uint32_t)CONFIG_MAGIC);
+  CHECK_EQ(helper.config.ssid[0], 0);
+  CHECK_EQ(helper.config.name[0], 0);
+
+  // the defaults were saved, the next boot reads them as they are
+  ServerHelper next;
+  CHECK(next.loadConfig());
+  CHECK_EQ(next.config.ssid[0], 0);
+}
+
+int main()
+{
+  testJoin();
+  testFallback();
+  testCommitCount();
+  testDhcp();
+  testPostCommitCount();
+  testMigrate();
+  testCorruptRecord();
+  return report();
+}
@@ -0,0 +1,92 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// ETags and the index behind them when files change without the helper,
+// and what working them out reads.
+
+// a large file from the sketch is sampled, not read whole, for its tag
+static void testLargeFile(Sandbox &box, ServerHelper &helper)
+{
+  std::string log(300000, 'x');
+  for (size_t i = 0; i < log.size(); ++i)
+    log[i] = 'a' + i % 23;
+  box.writeFile("/big.log", log);
+
+  size_t read = host::fsBytesRead();
+  Response r = get(helper, "/big.log", "Range: bytes=-100\r\n");
+  CHECK_EQ(r.status, 206);
+  CHECK(r.body == log.substr(log.size() - 100));
+  CHECK(host::fsBytesRead() - read <= 2 * ETAG_SAMPLE + 100);
+  std::string etag = r.header("etag");
+  CHECK(!etag.empty());
+
+  r = get(helper, "/big.log", "Range: bytes=299000-\r\nIf-Range: " + etag + "\r\n");
+  CHECK_EQ(r.status, 206);
+  CHECK_EQ(r.header("etag"), etag);
+
+  // the log grows, a resume against the old tag gets the whole file
+  log += "more lines\n";
+  box.writeFile("/big.log", log);
+  read = host::fsBytesRead();
+  r = get(helper, "/big.log", "Range: bytes=299000-\r\nIf-Range: " + etag + "\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK(r.header("etag") != etag);
+  CHECK(r.body == log);
+  // the body, and no more than the samples besides
+  CHECK(host::fsBytesRead() - read <= log.size() + 2 * ETAG_SAMPLE);
+}
+
+// rewritten with the same size, the sketch tells the helper
+static void testFileWritten(Sandbox &box, ServerHelper &helper)
+{
+  CHECK(upload(helper, "same.txt", "version one").status == 200);
+  std::string etag = get(helper, "/same.txt").header("etag");
+  box.writeFile("/same.txt", "version two");
+  helper.fileWritten("/same.txt");
+  CHECK(helper.findFileTag("/same.txt") == NULL);
+  // gone from the saved index as well
+  CHECK(box.readFile(ETAG_INDEX_PATH).find("/same.txt") == std::string::npos);
+
+  Response r = get(helper, "/same.txt", "If-None-Match: " + etag + "\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("version two"));
+  CHECK(r.header("etag") != etag);
+  CHECK_EQ(r.header("etag"), std::string(helper.fileETag("/same.txt").c_str()));
+}
+
+int main()
+{
+  Sandbox box;
+  box.writeFile("/a.txt", "first");
+  ServerHelper helper(NULL);
+  boot(helper);
+
+  Response r = get(helper, "/a.txt");
+  CHECK_EQ(r.status, 200);
+  std::string etag = r.header("ETag");
+  CHECK(!etag.empty());
+  CHECK_EQ(get(helper, "/a.txt", "If-None-Match: " + etag + "\r\n").status, 304);
+  // a GET does not write the index
+  CHECK(!SPIFFS.exists(ETAG_INDEX_PATH));
+
+  // replaced by the sketch, the size no longer matches the index
+  box.writeFile("/a.txt", "second version");
+  r = get(helper, "/a.txt");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("second version"));
+  CHECK(r.header("ETag") != etag);
+  CHECK(r.header("ETag") == helper.fileETag("/a.txt").c_str());
+
+  // indexed, then removed behind the helper's back
+  CHECK(upload(helper, "b.txt", "uploaded").status == 200);
+  CHECK(SPIFFS.exists(ETAG_INDEX_PATH));
+  CHECK(helper.findFileTag("/b.txt") != NULL);
+  SPIFFS.remove("/b.txt");
+  CHECK_EQ(get(helper, "/b.txt").status, 404);
+  CHECK(helper.findFileTag("/b.txt") == NULL);
+
+  testLargeFile(box, helper);
+  testFileWritten(box, helper);
+  return report();
+}
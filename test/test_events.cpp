@@ -0,0 +1,88 @@
+#include "HostTest.h"
+
+#include <unistd.h>
+
+using namespace hosttest;
+
+// /events subscribers: the slots, the queues they allocate and the
+// format of what broadcast() sends.
+
+static int subscribe(ServerHelper &helper)
+{
+  int fd = connectTo(httpPort());
+  sendAll(fd, "GET /events HTTP/1.1\r\nHost: device\r\n\r\n");
+  int before = helper.events.clients();
+  pump(helper, [&]() { return helper.events.clients() > before; }, 2000);
+  return fd;
+}
+
+// reads until the stream has sent at least want bytes more
+static std::string drain(ServerHelper &helper, int fd, size_t want)
+{
+  std::string data;
+  pump(helper, [&]() {
+    data += receive(fd, 0);
+    return data.size() >= want;
+  }, 2000);
+  return data;
+}
+
+static void testFormat(ServerHelper &helper)
+{
+  int fd = subscribe(helper);
+  std::string headers = drain(helper, fd, 1);
+  CHECK(headers.find("Content-Type: text/event-stream") != std::string::npos);
+
+  helper.broadcast("temp", "21.5");
+  CHECK_EQ(drain(helper, fd, 23), std::string("event: temp\ndata: 21.5\n\n"));
+
+  // no event name, and one that is NULL, send only data
+  helper.broadcast("", "x");
+  CHECK_EQ(drain(helper, fd, 9), std::string("data: x\n\n"));
+  helper.broadcast(NULL, "a\nb");
+  CHECK_EQ(drain(helper, fd, 17), std::string("data: a\ndata: b\n\n"));
+
+  close(fd);
+  pump(helper, [&]() { return helper.events.clients() == 0; }, 2000);
+}
+
+static void testSlots(ServerHelper &helper)
+{
+  size_t heap = host::heapUsed();
+  CHECK_EQ(EVENT_MAX_CLIENTS, 8);
+
+  std::vector<int> fds;
+  for (int i = 0; i < EVENT_MAX_CLIENTS; ++i)
+    fds.push_back(subscribe(helper));
+  CHECK_EQ(helper.events.clients(), EVENT_MAX_CLIENTS);
+  // each subscriber has its queue now
+  CHECK(host::heapUsed() >= heap + EVENT_MAX_CLIENTS * EVENT_QUEUE_SIZE);
+
+  Response r = get(helper, "/events");
+  CHECK_EQ(r.status, 503);
+
+  heap = host::heapUsed();
+  for (size_t i = 0; i < fds.size(); ++i)
+    close(fds[i]);
+  pump(helper, [&]() { return helper.events.clients() == 0; }, 2000);
+  CHECK_EQ(helper.events.clients(), 0);
+  // and gives it back when it leaves
+  CHECK(host::heapUsed() + EVENT_MAX_CLIENTS * EVENT_QUEUE_SIZE <= heap);
+}
+
+int main()
+{
+  Sandbox box;
+  // the queues are allocated on subscribe, an idle stream has none
+  size_t heap = host::heapUsed();
+  {
+    EventStream idle;
+    CHECK(host::heapUsed() == heap);
+  }
+
+  ServerHelper helper(NULL);
+  boot(helper);
+  testFormat(helper);
+  testSlots(helper);
+  return report();
+}
@@ -0,0 +1,100 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// FileCache: paths remembered as missing and reads that come up short.
+
+static void testMissingExpires(Sandbox &box, ServerHelper &helper)
+{
+  CHECK_EQ(get(helper, "/late.txt").status, 404);
+
+  // written behind the helper's back, still remembered as missing
+  box.writeFile("/late.txt", "late");
+  CHECK_EQ(get(helper, "/late.txt").status, 404);
+
+  host::useManualClock(true);
+  host::advance(FILE_CACHE_MISSING_TTL);
+  Response r = get(helper, "/late.txt");
+  host::useManualClock(false);
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("late"));
+}
+
+static void testUploadClearsMissing(ServerHelper &helper)
+{
+  CHECK_EQ(get(helper, "/up.txt").status, 404);
+  CHECK_EQ(upload(helper, "up.txt", "uploaded").status, 200);
+  Response r = get(helper, "/up.txt");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("uploaded"));
+}
+
+// a .gz asked for by name is the file itself, cached or not
+static void testGzByName(Sandbox &box, ServerHelper &helper)
+{
+  box.writeFile("/logs.gz", "compressed");
+  box.writeFile("/app.js", "plain");
+  box.writeFile("/app.js.gz", "zipped");
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    Response r = get(helper, "/logs.gz", "Accept-Encoding: gzip\r\n");
+    CHECK_EQ(r.status, 200);
+    CHECK_EQ(r.body, std::string("compressed"));
+    CHECK_EQ(r.header("content-type"), std::string("application/x-gzip"));
+    CHECK_EQ(r.header("content-encoding"), std::string());
+
+    r = get(helper, "/logs.gz?download=1", "Accept-Encoding: gzip\r\n");
+    CHECK_EQ(r.header("content-type"), std::string("application/octet-stream"));
+    CHECK_EQ(r.header("content-encoding"), std::string());
+
+    // the variant swapped in for /app.js is
+    r = get(helper, "/app.js", "Accept-Encoding: gzip\r\n");
+    CHECK_EQ(r.body, std::string("zipped"));
+    CHECK_EQ(r.header("content-encoding"), std::string("gzip"));
+  }
+  CHECK(helper.fileCache.contains("/logs.gz"));
+  CHECK(helper.fileCache.contains("/app.js.gz"));
+}
+
+static void testMissingLimit()
+{
+  FileCache cache;
+  cache.setCapacity(1024);
+  for (int i = 0; i < FILE_CACHE_MISSING + 2; ++i)
+    cache.setMissing("/m" + String(i));
+  CHECK(!cache.isMissing("/m0"));
+  CHECK(cache.isMissing("/m" + String(FILE_CACHE_MISSING + 1)));
+  cache.remove("/m" + String(FILE_CACHE_MISSING + 1));
+  CHECK(!cache.isMissing("/m" + String(FILE_CACHE_MISSING + 1)));
+}
+
+static void testShortRead(Sandbox &box)
+{
+  FileCache cache;
+  cache.setCapacity(1024);
+  box.writeFile("/shrink.txt", std::string(100, 'a'));
+  File file = SPIFFS.open("/shrink.txt", "r");
+  file.seek(10);
+  // truncated after it was opened, the read comes up short
+  box.writeFile("/shrink.txt", std::string(40, 'b'));
+  CHECK(cache.add("/shrink.txt", file) == NULL);
+  CHECK_EQ(file.position(), (size_t)0);
+  CHECK_EQ(cache.count(), (size_t)0);
+  CHECK_EQ(cache.size(), (size_t)0);
+  file.close();
+}
+
+int main()
+{
+  Sandbox box;
+  ServerHelper helper(NULL);
+  helper.enableFileCache(8192);
+  boot(helper);
+
+  testMissingExpires(box, helper);
+  testUploadClearsMissing(helper);
+  testGzByName(box, helper);
+  testMissingLimit();
+  testShortRead(box);
+  return report();
+}
@@ -0,0 +1,58 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// Precompressed .gz variants and the Accept-Encoding header with q-values.
+
+static bool gzipped(ServerHelper &helper, const std::string &acceptEncoding)
+{
+  std::string headers = acceptEncoding.empty() ? "" : "Accept-Encoding: " + acceptEncoding + "\r\n";
+  Response r = get(helper, "/page.htm", headers);
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.header("vary"), std::string("Accept-Encoding"));
+  bool gz = r.header("content-encoding") == "gzip";
+  CHECK_EQ(r.body, std::string(gz ? "compressed" : "plain"));
+  return gz;
+}
+
+static void testQValues(ServerHelper &helper)
+{
+  CHECK(gzipped(helper, "gzip"));
+  CHECK(gzipped(helper, "gzip, deflate, br"));
+  CHECK(gzipped(helper, "GZIP;Q=0.001"));
+  CHECK(gzipped(helper, "br;q=1.0, gzip;q=0.8"));
+  CHECK(gzipped(helper, "x-gzip"));
+  CHECK(gzipped(helper, "*;q=0.5"));
+  CHECK(gzipped(helper, "deflate ; q=0.5 , gzip ; q=1"));
+
+  CHECK(!gzipped(helper, ""));
+  CHECK(!gzipped(helper, "deflate, br"));
+  CHECK(!gzipped(helper, "gzip;q=0"));
+  CHECK(!gzipped(helper, "gzip;q=0.000"));
+  CHECK(!gzipped(helper, "gzip;q=0, *"));
+  CHECK(!gzipped(helper, "identity;q=1, *;q=0"));
+  CHECK(!gzipped(helper, "gzipped, xgzip"));
+  CHECK(!gzipped(helper, "gzip;q=bad"));
+}
+
+static void testOnlyGz(Sandbox &box, ServerHelper &helper)
+{
+  // no plain copy, the compressed one is sent whatever the client says
+  box.writeFile("/only.js.gz", "compressed");
+  Response r = get(helper, "/only.js", "Accept-Encoding: gzip;q=0\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.header("content-encoding"), std::string("gzip"));
+}
+
+int main()
+{
+  Sandbox box;
+  box.writeFile("/page.htm", "plain");
+  box.writeFile("/page.htm.gz", "compressed");
+  ServerHelper helper(NULL);
+  boot(helper);
+
+  testQValues(helper);
+  testOnlyGz(box, helper);
+  return report();
+}
@@ -0,0 +1,87 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// The backend itself: files through SPIFFS, the EEPROM file, scripted
+// WiFi and a request over a real socket.
+
+static void testFileSystem(Sandbox &box)
+{
+  box.writeFile("/a.txt", "hello");
+  CHECK(SPIFFS.exists("/a.txt"));
+  CHECK_EQ(box.readFile("/a.txt"), std::string("hello"));
+  CHECK(!SPIFFS.open("/this-name-is-far-too-long-for-spiffs.txt", "w"));
+  box.writeFile("/b.txt", "x");
+  CHECK(!SPIFFS.rename("/a.txt", "/b.txt"));
+  CHECK(SPIFFS.remove("/b.txt"));
+  CHECK(SPIFFS.rename("/a.txt", "/b.txt"));
+  CHECK(!SPIFFS.exists("/a.txt"));
+  SPIFFS.remove("/b.txt");
+}
+
+static void testEeprom(Sandbox &box)
+{
+  EEPROM.begin(64);
+  EEPROM.write(3, 42);
+  CHECK(EEPROM.commit());
+  uint32_t commits = host::eepromCommits();
+  // nothing changed, nothing written
+  EEPROM.write(3, 42);
+  EEPROM.commit();
+  CHECK_EQ(host::eepromCommits(), commits);
+  EEPROM.end();
+  EEPROM.begin(64);
+  CHECK_EQ(EEPROM.read(3), 42);
+  EEPROM.end();
+  FILE *f = fopen(box.path("eeprom.bin").c_str(), "rb");
+  CHECK(f != NULL);
+  if (f)
+    fclose(f);
+}
+
+static void testWifi()
+{
+  host::Network net = {"home", "secret123", -60, 6, {1, 2, 3, 4, 5, 6}, true, 200};
+  host::addNetwork(net);
+  host::useManualClock(true);
+  WiFi.begin("home", "wrong");
+  host::advance(500);
+  CHECK(WiFi.status() != WL_CONNECTED);
+  WiFi.begin("home", "secret123");
+  host::advance(100);
+  CHECK(WiFi.status() != WL_CONNECTED);
+  host::advance(200);
+  CHECK_EQ(WiFi.status(), WL_CONNECTED);
+  host::dropWifi();
+  CHECK(WiFi.status() != WL_CONNECTED);
+  host::useManualClock(false);
+  WiFi.disconnect();
+  host::clearNetworks();
+}
+
+static void testServer(Sandbox &box)
+{
+  ServerHelper helper(NULL);
+  box.writeFile("/index.htm", "<p>hi</p>");
+  boot(helper);
+  CHECK_EQ(helper.wifiState, WIFI_STATE_AP);
+  CHECK(httpPort() != 0);
+
+  Response r = get(helper, "/index.htm");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.body, std::string("<p>hi</p>"));
+  CHECK_EQ(r.header("Content-Type"), std::string("text/html"));
+
+  r = get(helper, "/missing.txt");
+  CHECK_EQ(r.status, 404);
+}
+
+int main()
+{
+  Sandbox box;
+  testFileSystem(box);
+  testEeprom(box);
+  testWifi();
+  testServer(box);
+  return report();
+}
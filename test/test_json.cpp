@@ -0,0 +1,138 @@
+#include "HostTest.h"
+
+#include <unistd.h>
+
+using namespace hosttest;
+
+// /networks through JsonWriter against the String += it replaced, with
+// 50 networks: the output, and the peak heap while the handler runs.
+
+static const int count = 50;
+
+// the handler before JsonWriter, kept here for the comparison
+static void appendJsonString(String &out, const String &value)
+{
+  out += '"';
+  for (unsigned int i = 0; i < value.length(); ++i)
+  {
+    char ch = value[i];
+    if (ch == '"' || ch == '\\')
+    {
+      out += '\\';
+      out += ch;
+    }
+    else if ((uint8_t)ch < 0x20)
+    {
+      char buf[7];
+      snprintf(buf, sizeof(buf), "\\u%04x", ch);
+      out += buf;
+    }
+    else
+    {
+      out += ch;
+    }
+  }
+  out += '"';
+}
+
+static void listNetworksString(ServerHelper &helper)
+{
+  String &st = helper.st;
+  st = "{\"version\":";
+  st += NETWORKS_SCHEMA_VERSION;
+  st += ",\"scanning\":";
+  st += helper.networksScanning ? "true" : "false";
+  st += ",\"age\":";
+  st += millis() - helper.networksScannedAt;
+  st += ",\"networks\":[";
+  for (size_t i = 0; i < helper.networks.size(); ++i)
+  {
+    if (i > 0)
+      st += ",";
+    st += "{\"ssid\":";
+    appendJsonString(st, helper.networks[i].ssid);
+    st += ",\"rssi\":";
+    st += helper.networks[i].rssi;
+    st += ",\"channel\":";
+    st += helper.networks[i].channel;
+    st += ",\"encryption\":";
+    st += helper.networks[i].encrypted ? "true" : "false";
+    st += "}";
+  }
+  st += "]}";
+  helper.server.send(200, "application/json", st);
+}
+
+static bool handled = false;
+
+// heap taken at the peak of one request, the client only sends before
+// and reads after, so the count is the server's alone
+static size_t peakHeap(ServerHelper &helper, const char *uri, Response *r)
+{
+  int fd = connectTo(httpPort());
+  sendAll(fd, std::string("GET ") + uri + " HTTP/1.1\r\nHost: device\r\n\r\n");
+  size_t base = host::heapUsed();
+  host::resetHeapPeak();
+  handled = false;
+  pump(helper, [&]() { return handled; }, 2000);
+  size_t peak = host::heapPeak() - base;
+  *r = parse(readResponse(fd));
+  close(fd);
+  return peak;
+}
+
+int main()
+{
+  Sandbox box;
+  for (int i = 0; i < count; ++i)
+  {
+    host::Network net;
+    // the longest an SSID can be, one with a quote to escape
+    net.ssid = String(i == 7 ? "quote\"" : "network") + String(i + 100);
+    while (net.ssid.length() < 32)
+      net.ssid += '-';
+    net.rssi = -40 - i;
+    net.channel = 1 + i % 13;
+    memset(net.bssid, 0, sizeof(net.bssid));
+    net.bssid[5] = i;
+    net.encrypted = i % 2;
+    net.connectDelay = 100;
+    host::addNetwork(net);
+  }
+  host::setScanTime(10);
+
+  ServerHelper helper(NULL);
+  boot(helper);
+  helper.on("/networks-string", HTTP_GET, [&]() {
+    listNetworksString(helper);
+    handled = true;
+  });
+  helper.on("/networks-json", HTTP_GET, [&]() {
+    helper.listNetworks();
+    handled = true;
+  });
+
+  // the first request starts the scan
+  get(helper, "/networks");
+  pump(helper, [&]() { return helper.networksScanned; }, 2000);
+  CHECK_EQ(helper.networks.size(), (size_t)count);
+
+  Response string, json;
+  size_t stringPeak = peakHeap(helper, "/networks-string", &string);
+  size_t jsonPeak = peakHeap(helper, "/networks-json", &json);
+  printf("peak heap for %d networks: String %u bytes, JsonWriter %u bytes\n", count, (unsigned)stringPeak,
+         (unsigned)jsonPeak);
+
+  CHECK_EQ(string.status, 200);
+  CHECK_EQ(json.status, 200);
+  CHECK_EQ(json.header("transfer-encoding"), std::string("chunked"));
+  CHECK_EQ(json.header("content-type"), std::string("application/json"));
+  CHECK(json.body.size() > (size_t)count * 70);
+  CHECK(json.body.find("\"ssid\":\"quote\\\"107") != std::string::npos);
+  CHECK_EQ(json.body.substr(json.body.find("\"networks\"")), string.body.substr(string.body.find("\"networks\"")));
+
+  // the String holds the whole document, the writer one buffer of it
+  CHECK(stringPeak >= json.body.size());
+  CHECK(jsonPeak < json.body.size() / 4);
+  return report();
+}
@@ -0,0 +1,158 @@
+// as in a sketch built with -DSERVERHELPER_LOG_LEVEL=2, the INFO and
+// DEBUG calls in this file are compiled out
+#define SERVERHELPER_LOG_LEVEL LOG_LEVEL_WARN
+
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// Logger::drain() against an output that takes a few bytes at a time,
+// and the levels that keep messages out of the ring.
+
+class SlowOutput : public Print
+{
+  public:
+    SlowOutput() : room(0), largest(0), overrun(false) {}
+
+    size_t write(uint8_t ch) override { return write(&ch, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        overrun |= size > room;
+        largest = std::max(largest, size);
+        data.append((const char *)buf, size);
+        room -= std::min(room, size);
+        return size;
+    }
+    int availableForWrite() override { return room; }
+
+    std::string data;
+    size_t room;
+    size_t largest;
+    bool overrun;
+};
+
+static void testCapped()
+{
+  Logger log;
+  SlowOutput out;
+  log.setOutput(&out);
+  for (int i = 0; i < 10; ++i)
+    log.log(LOG_LEVEL_INFO, "test", PSTR("message %d with some padding"), i);
+  size_t pending = log.pending();
+
+  // a full output gets nothing
+  CHECK(!log.drain());
+  CHECK(out.data.empty());
+
+  // a UART FIFO's worth at a time
+  for (int i = 0; i < 1000 && log.pending() > 0; ++i)
+  {
+    out.room = 16;
+    log.drain();
+  }
+  CHECK_EQ(log.pending(), (size_t)0);
+  CHECK_EQ(out.data.size(), pending);
+  CHECK(!out.overrun);
+  CHECK(out.largest <= 16);
+  CHECK(out.data.find("message 9 with some padding\r\n") != std::string::npos);
+}
+
+static void testDroppedReport()
+{
+  Logger log;
+  SlowOutput out;
+  log.setOutput(&out);
+  for (int i = 0; i < 100; ++i)
+    log.log(LOG_LEVEL_INFO, "test", PSTR("message %d with some padding to fill the ring"), i);
+  CHECK(log.dropped() > 0);
+
+  // too little room for the report line, it waits instead of being cut
+  out.room = 10;
+  CHECK(!log.drain());
+  CHECK(out.data.empty());
+
+  out.room = 64;
+  log.drain();
+  CHECK(out.data.find("messages dropped\r\n") != std::string::npos);
+  CHECK(!out.overrun);
+}
+
+static void testFlushGivesUp()
+{
+  Logger log;
+  SlowOutput out;
+  log.setOutput(&out);
+  log.log(LOG_LEVEL_INFO, "test", PSTR("stuck"));
+  uint64_t start = nowMicros();
+  log.flush();
+  uint64_t elapsed = nowMicros() - start;
+  CHECK(log.pending() > 0);
+  CHECK(elapsed >= LOG_FLUSH_TIMEOUT * 900ULL);
+  CHECK(elapsed < LOG_FLUSH_TIMEOUT * 4000ULL);
+}
+
+static void testRuntimeLevel()
+{
+  Logger log;
+  SlowOutput out;
+  out.room = 4096;
+  log.setOutput(&out);
+  log.setLevel(LOG_LEVEL_WARN);
+  log.log(LOG_LEVEL_INFO, "test", PSTR("info"));
+  log.log(LOG_LEVEL_DEBUG, "test", PSTR("debug"));
+  CHECK_EQ(log.pending(), (size_t)0);
+  log.log(LOG_LEVEL_WARN, "test", PSTR("warn"));
+  log.log(LOG_LEVEL_ERROR, "test", PSTR("error"));
+  while (log.drain())
+    ;
+  CHECK(out.data.find("[W][test] warn\r\n") != std::string::npos);
+  CHECK(out.data.find("[E][test] error\r\n") != std::string::npos);
+  CHECK(out.data.find("info") == std::string::npos);
+  CHECK(out.data.find("debug") == std::string::npos);
+
+  // NONE keeps even errors out, and is never a level of its own
+  log.setLevel(LOG_LEVEL_NONE);
+  log.log(LOG_LEVEL_ERROR, "test", PSTR("error"));
+  log.log(LOG_LEVEL_NONE, "test", PSTR("none"));
+  CHECK_EQ(log.pending(), (size_t)0);
+}
+
+static int evaluated = 0;
+
+static int sideEffect()
+{
+  return ++evaluated;
+}
+
+static void testCompiledOut()
+{
+  SlowOutput out;
+  out.room = 4096;
+  ServerLog.setOutput(&out);
+  // the runtime level would take everything, the build level does not
+  ServerLog.setLevel(LOG_LEVEL_DEBUG);
+  size_t pending = ServerLog.pending();
+  LOG_DEBUG("test", "debug %d", sideEffect());
+  LOG_INFO("test", "info %d", sideEffect());
+  CHECK_EQ(ServerLog.pending(), pending);
+  CHECK_EQ(evaluated, 0);
+
+  LOG_WARN("test", "warn %d", sideEffect());
+  CHECK_EQ(evaluated, 1);
+  while (ServerLog.drain())
+    ;
+  CHECK(out.data.find("[W][test] warn 1\r\n") != std::string::npos);
+  CHECK(out.data.find("info") == std::string::npos);
+  ServerLog.setOutput(NULL);
+  ServerLog.setLevel(LOG_LEVEL_INFO);
+}
+
+int main()
+{
+  testCapped();
+  testDroppedReport();
+  testFlushGivesUp();
+  testRuntimeLevel();
+  testCompiledOut();
+  return report();
+}
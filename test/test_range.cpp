@@ -0,0 +1,154 @@
+#include "HostTest.h"
+
+#include <future>
+#include <unistd.h>
+
+using namespace hosttest;
+
+// Range requests: an interrupted download of a large log file resumed
+// from where it stopped, and the requests that get the whole file or 416.
+
+static std::string pattern(size_t size, int seed)
+{
+  std::string s(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    s[i] = (char)(i * seed + i / 89);
+  return s;
+}
+
+// reads the headers and at least want bytes of the body, then hangs up
+static std::string interrupted(ServerHelper &helper, const std::string &uri, size_t want)
+{
+  uint16_t port = httpPort();
+  std::future<std::string> client = std::async(std::launch::async, [=]() {
+    int fd = connectTo(port);
+    sendAll(fd, "GET " + uri + " HTTP/1.1\r\nHost: device\r\n\r\n");
+    std::string raw;
+    size_t end = std::string::npos;
+    while (end == std::string::npos || raw.size() < end + 4 + want)
+    {
+      std::string data = receive(fd, 2000);
+      if (data.empty())
+        break;
+      raw += data;
+      end = raw.find("\r\n\r\n");
+    }
+    close(fd);
+    return raw;
+  });
+  pump(helper, [&]() { return client.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }, 15000);
+  return client.get();
+}
+
+static void testResume(ServerHelper &helper, const std::string &content)
+{
+  std::string raw = interrupted(helper, "/log.txt", 100000);
+  Response first = parse(raw);
+  CHECK_EQ(first.status, 200);
+  CHECK_EQ(first.header("accept-ranges"), std::string("bytes"));
+  std::string etag = first.header("etag");
+  CHECK(!etag.empty());
+  // what arrived before the hang-up, the client resumes after it
+  std::string got = first.body.substr(0, 100000);
+  CHECK(got == content.substr(0, got.size()));
+
+  Response rest = get(helper, "/log.txt", "Range: bytes=" + std::to_string(got.size()) + "-\r\nIf-Range: " + etag + "\r\n");
+  CHECK_EQ(rest.status, 206);
+  CHECK_EQ(rest.header("content-range"),
+           "bytes " + std::to_string(got.size()) + "-" + std::to_string(content.size() - 1) + "/" + std::to_string(content.size()));
+  CHECK_EQ(rest.header("content-length"), std::to_string(content.size() - got.size()));
+  CHECK(got + rest.body == content);
+
+  // a resume in several pieces, as download managers do
+  std::string pieces;
+  for (size_t start = 0; start < content.size(); start += 65536)
+  {
+    size_t end = min(start + 65536, content.size()) - 1;
+    Response r = get(helper, "/log.txt", "Range: bytes=" + std::to_string(start) + "-" + std::to_string(end) + "\r\n");
+    CHECK_EQ(r.status, 206);
+    pieces += r.body;
+  }
+  CHECK(pieces == content);
+}
+
+static void testChanged(Sandbox &box, ServerHelper &helper, const std::string &content)
+{
+  std::string etag = get(helper, "/log.txt", "Range: bytes=0-0\r\n").header("etag");
+
+  // replaced since the download started, the resume gets the new file
+  std::string changed = pattern(content.size() + 1000, 31);
+  CHECK_EQ(upload(helper, "log.txt", changed).status, 200);
+  Response r = get(helper, "/log.txt", "Range: bytes=100000-\r\nIf-Range: " + etag + "\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK(r.header("etag") != etag);
+  CHECK(r.body == changed);
+
+  box.writeFile("/log.txt", content);
+}
+
+static void testOther(ServerHelper &helper, const std::string &content)
+{
+  std::string size = std::to_string(content.size());
+
+  Response r = get(helper, "/log.txt", "Range: bytes=-1000\r\n");
+  CHECK_EQ(r.status, 206);
+  CHECK_EQ(r.header("content-range"), "bytes " + std::to_string(content.size() - 1000) + "-" +
+                                          std::to_string(content.size() - 1) + "/" + size);
+  CHECK(r.body == content.substr(content.size() - 1000));
+
+  // an end past the file is cut to it
+  r = get(helper, "/log.txt", "Range: bytes=299990-400000\r\n");
+  CHECK_EQ(r.status, 206);
+  CHECK(r.body == content.substr(299990));
+
+  r = get(helper, "/log.txt", "Range: bytes=" + size + "-\r\n");
+  CHECK_EQ(r.status, 416);
+  CHECK_EQ(r.header("content-range"), "bytes */" + size);
+
+  // several ranges and malformed ones get the whole file
+  r = get(helper, "/log.txt", "Range: bytes=0-9,100-109\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK(r.body == content);
+  r = get(helper, "/log.txt", "Range: bytes=abc\r\n");
+  CHECK_EQ(r.status, 200);
+  r = get(helper, "/log.txt", "Range: lines=0-9\r\n");
+  CHECK_EQ(r.status, 200);
+}
+
+// a file named .gz is sent as it is, whole or in pieces; the variant
+// swapped in for another name is encoded in both
+static void testGz(Sandbox &box, ServerHelper &helper)
+{
+  std::string gz = pattern(20000, 23);
+  box.writeFile("/old.log.gz", gz);
+  Response whole = get(helper, "/old.log.gz", "Accept-Encoding: gzip\r\n");
+  CHECK_EQ(whole.status, 200);
+  CHECK_EQ(whole.header("content-encoding"), std::string());
+  Response rest = get(helper, "/old.log.gz", "Accept-Encoding: gzip\r\nRange: bytes=5000-\r\n");
+  CHECK_EQ(rest.status, 206);
+  CHECK_EQ(rest.header("content-encoding"), std::string());
+  CHECK(whole.body.substr(0, 5000) + rest.body == gz);
+
+  box.writeFile("/page.js", "plain");
+  box.writeFile("/page.js.gz", gz);
+  whole = get(helper, "/page.js", "Accept-Encoding: gzip\r\n");
+  CHECK_EQ(whole.header("content-encoding"), std::string("gzip"));
+  rest = get(helper, "/page.js", "Accept-Encoding: gzip\r\nRange: bytes=5000-\r\n");
+  CHECK_EQ(rest.status, 206);
+  CHECK_EQ(rest.header("content-encoding"), std::string("gzip"));
+  CHECK(whole.body.substr(0, 5000) + rest.body == gz);
+}
+
+int main()
+{
+  Sandbox box;
+  std::string content = pattern(300000, 17);
+  box.writeFile("/log.txt", content);
+  ServerHelper helper(NULL);
+  boot(helper);
+  testResume(helper, content);
+  testChanged(box, helper, content);
+  testOther(helper, content);
+  testGz(box, helper);
+  return report();
+}
@@ -0,0 +1,94 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// SettingsStore on the simulated flash: how the erases spread over the
+// ring and what a write cut short leaves behind.
+
+#define FIRST_SECTOR 1000
+#define SECTORS      4
+
+static void testWearLeveling()
+{
+  host::resetFlash();
+  SettingsStore store;
+  CHECK(store.begin(FIRST_SECTOR, SECTORS));
+
+  const int saves = 5000;
+  char value[40];
+  for (int i = 0; i < saves; ++i)
+  {
+    snprintf(value, sizeof(value), "value %d", i);
+    CHECK(store.putString(i % 2 ? "ssid" : "pass", value));
+  }
+  CHECK_EQ(store.getString("ssid"), String("value 4999"));
+  CHECK_EQ(store.getString("pass"), String("value 4998"));
+
+  uint32_t low = 0xFFFFFFFFUL, high = 0, total = 0;
+  for (int i = 0; i < SECTORS; ++i)
+  {
+    uint32_t erases = host::flashErases(FIRST_SECTOR + i);
+    printf("sector %d: %u erases\n", FIRST_SECTOR + i, (unsigned)erases);
+    low = min(low, erases);
+    high = max(high, erases);
+    total += erases;
+  }
+  printf("%d saves, %u erases\n", saves, (unsigned)total);
+  // every sector takes its turn, one erase per trip around the ring
+  CHECK(high - low <= 1);
+  CHECK(total < saves / 50);
+  CHECK_EQ(total, store.eraseCount());
+  CHECK_EQ(host::flashErases(FIRST_SECTOR - 1), 0u);
+  CHECK_EQ(host::flashErases(FIRST_SECTOR + SECTORS), 0u);
+}
+
+static void testTornWrite()
+{
+  host::resetFlash();
+  SettingsStore store;
+  CHECK(store.begin(FIRST_SECTOR, SECTORS));
+  CHECK(store.putString("name", "first"));
+
+  // the write stops half way, and so does the compaction it tries next
+  host::failFlashWritesAfter(0);
+  CHECK(!store.putString("name", "second"));
+  host::failFlashWritesAfter(-1);
+
+  // the torn bytes must not be written over
+  CHECK(store.putString("ssid", "home"));
+  CHECK_EQ(store.getString("name"), String("first"));
+  CHECK_EQ(store.getString("ssid"), String("home"));
+
+  SettingsStore reboot;
+  CHECK(reboot.begin(FIRST_SECTOR, SECTORS));
+  CHECK_EQ(reboot.getString("name"), String("first"));
+  CHECK_EQ(reboot.getString("ssid"), String("home"));
+}
+
+static void testTornAppendRecovers()
+{
+  host::resetFlash();
+  SettingsStore store;
+  CHECK(store.begin(FIRST_SECTOR, SECTORS));
+  CHECK(store.putString("name", "first"));
+  uint16_t active = store.activeSector();
+
+  // only the append is torn, the compaction behind it succeeds
+  host::failFlashWritesAfter(0, 1);
+  CHECK(store.putString("name", "second"));
+  host::failFlashWritesAfter(-1);
+  CHECK(store.activeSector() != active);
+
+  SettingsStore reboot;
+  CHECK(reboot.begin(FIRST_SECTOR, SECTORS));
+  CHECK_EQ(reboot.getString("name"), String("second"));
+}
+
+int main()
+{
+  Sandbox box;
+  testWearLeveling();
+  testTornWrite();
+  testTornAppendRecovers();
+  return report();
+}
@@ -0,0 +1,60 @@
+#include "HostTest.h"
+
+#include <unistd.h>
+
+using namespace hosttest;
+
+// Telnet sessions: option negotiation in the input and replies longer
+// than the output queue.
+
+static std::string readUntil(ServerHelper &helper, int fd, const char *marker)
+{
+  std::string data;
+  pump(helper, [&]() {
+    data += receive(fd, 0);
+    return data.find(marker) != std::string::npos;
+  }, 2000);
+  return data;
+}
+
+int main()
+{
+  Sandbox box;
+  ServerHelper helper(NULL);
+  boot(helper);
+  helper.Telnet.addCommand("echo", [](Print &out, const String &args) {
+    out.print('[');
+    out.print(args);
+    out.println(']');
+  }, "text");
+  helper.Telnet.addCommand("lines", [](Print &out, const String &args) {
+    (void)args;
+    for (int i = 0; i < 40; ++i)
+      out.printf("%-38s line %02d\r\n", "-", i);
+  }, "40 lines");
+
+  int fd = connectTo(host::boundPort(23));
+  CHECK(fd >= 0);
+  CHECK(readUntil(helper, fd, "help for commands").find("type help") != std::string::npos);
+
+  // IAC WILL ECHO, IAC SB TERMINAL-TYPE IS "xterm" IAC SE, IAC NOP
+  static const char negotiation[] = "\xff\xfb\x01\xff\xfa\x18\x00xterm\xff\xf0\xff\xf1";
+  sendAll(fd, std::string(negotiation, sizeof(negotiation) - 1));
+  // IAC IAC is a data byte, also inside a subnegotiation
+  sendAll(fd, "\xff\xfa\x18\xff\xff\xff\xf0" "echo a\xff\xff" "b\r\n");
+  std::string reply = readUntil(helper, fd, "]\r\n");
+  CHECK_EQ(reply, std::string("[a\xff" "b]\r\n"));
+
+  // replies larger than TELNET_QUEUE_SIZE
+  sendAll(fd, "lines\r\n");
+  reply = readUntil(helper, fd, "line 39\r\n");
+  CHECK_EQ(reply.size(), 40 * 48u);
+  sendAll(fd, "profile\r\n");
+  reply = readUntil(helper, fd, "threshold");
+  CHECK(reply.find("stage") == 0);
+  CHECK_EQ(helper.Telnet.dropped(), 0u);
+  CHECK_EQ(helper.Telnet.clients(), 1);
+
+  close(fd);
+  return report();
+}
@@ -0,0 +1,129 @@
+#include "HostTest.h"
+
+#include <future>
+#include <unistd.h>
+
+using namespace hosttest;
+
+// Background transfers: ranges, connections kept alive after a body and
+// eight clients downloading at once.
+
+static std::string pattern(size_t size)
+{
+  std::string s(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    s[i] = (char)(i * 13 + i / 97);
+  return s;
+}
+
+// both requests on one connection, the second once the first is in
+static std::vector<Response> twoOnOneConnection(ServerHelper &helper, const std::string &first, const std::string &second)
+{
+  uint16_t port = httpPort();
+  std::future<std::vector<Response>> client = std::async(std::launch::async, [=]() {
+    std::vector<Response> responses;
+    int fd = connectTo(port);
+    sendAll(fd, first);
+    responses.push_back(parse(readResponse(fd)));
+    sendAll(fd, second);
+    responses.push_back(parse(readResponse(fd)));
+    close(fd);
+    return responses;
+  });
+  pump(helper, [&]() { return client.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }, 15000);
+  return client.get();
+}
+
+static void testKeepAlive(ServerHelper &helper, const std::string &content)
+{
+  uint32_t reused = helper.transfers.reused();
+  std::vector<Response> r = twoOnOneConnection(helper, "GET /big.bin HTTP/1.1\r\nHost: device\r\n\r\n",
+                                               "GET /big.bin HTTP/1.1\r\nHost: device\r\nRange: bytes=5000-9999\r\n\r\n");
+  CHECK_EQ(r[0].status, 200);
+  CHECK_EQ(r[0].header("connection"), std::string("keep-alive"));
+  CHECK(r[0].header("etag").size() > 0);
+  CHECK(r[0].body == content);
+  CHECK_EQ(r[1].status, 206);
+  CHECK_EQ(r[1].header("content-range"), "bytes 5000-9999/" + std::to_string(content.size()));
+  CHECK(r[1].body == content.substr(5000, 5000));
+  CHECK_EQ(helper.transfers.reused(), reused + 1);
+}
+
+static void testClose(ServerHelper &helper, const std::string &content)
+{
+  Response r = get(helper, "/big.bin", "Connection: close\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.header("connection"), std::string("close"));
+  CHECK(r.body == content);
+
+  // HTTP/1.0 closes by default
+  r = request(helper, "GET /big.bin HTTP/1.0\r\n\r\n");
+  CHECK_EQ(r.status, 200);
+  CHECK_EQ(r.header("connection"), std::string("close"));
+}
+
+// offloading a response does not change its headers, for a .gz asked
+// for by name and for one swapped in
+static void testSameHeaders(ServerHelper &helper)
+{
+  const char *uris[] = {"/logs.gz", "/page.js"};
+  for (int i = 0; i < 2; ++i)
+  {
+    helper.transfers.begin(0);
+    Response inlined = get(helper, uris[i], "Accept-Encoding: gzip\r\nConnection: close\r\n");
+    helper.transfers.begin(4);
+    uint32_t completed = helper.transfers.completed();
+    Response pooled = get(helper, uris[i], "Accept-Encoding: gzip\r\nConnection: close\r\n");
+    CHECK_EQ(helper.transfers.completed(), completed + 1);
+
+    CHECK_EQ(inlined.status, 200);
+    CHECK(inlined.headers == pooled.headers);
+    CHECK(inlined.body == pooled.body);
+    CHECK_EQ(pooled.header("content-encoding"), std::string(i == 0 ? "" : "gzip"));
+  }
+}
+
+static void testSeekFails(ServerHelper &helper)
+{
+  Response r = get(helper, "/seekfail");
+  CHECK_EQ(r.status, 500);
+  CHECK(r.header("content-range").empty());
+}
+
+static void testLoad(ServerHelper &helper, const std::string &content)
+{
+  uint32_t completed = helper.transfers.completed();
+  LoadResult result = load(helper, 8, 6, "/big.bin", content.size());
+  CHECK_EQ(result.failed, 0);
+  CHECK_EQ(result.latencies.size(), (size_t)48);
+  // the slots took part, the rest was sent inline
+  CHECK(helper.transfers.completed() > completed);
+  CHECK_EQ(helper.transfers.aborted(), (uint32_t)0);
+  pump(helper, [&]() { return helper.transfers.active() == 0; }, 2000);
+  CHECK_EQ(helper.transfers.active(), (size_t)0);
+}
+
+int main()
+{
+  Sandbox box;
+  std::string content = pattern(40000);
+  box.writeFile("/big.bin", content);
+  box.writeFile("/logs.gz", content);
+  box.writeFile("/page.js", "plain");
+  box.writeFile("/page.js.gz", content);
+
+  ServerHelper helper(NULL);
+  helper.useBackgroundTransfers(4);
+  helper.on("/seekfail", HTTP_GET, [&]() {
+    File none;
+    helper.streamFileRange(none, "text/plain", 0, 9);
+  });
+  boot(helper);
+
+  testSameHeaders(helper);
+  testKeepAlive(helper, content);
+  testClose(helper, content);
+  testSeekFails(helper);
+  testLoad(helper, content);
+  return report();
+}
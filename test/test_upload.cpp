@@ -0,0 +1,123 @@
+#include "HostTest.h"
+
+using namespace hosttest;
+
+// POST /upload replacing files, failures on the way and a reset in the
+// middle of putting the upload in place.
+
+static std::string pattern(size_t size)
+{
+  std::string s(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    s[i] = (char)(i * 7 + i / 251);
+  return s;
+}
+
+static void testReplace(Sandbox &box, ServerHelper &helper)
+{
+  box.writeFile("/page.htm", "old");
+  std::string content = pattern(10000);
+  Response r = upload(helper, "page.htm", content);
+  CHECK_EQ(r.status, 200);
+  CHECK(box.readFile("/page.htm") == content);
+  CHECK(!SPIFFS.exists(UPLOAD_TEMP_PATH));
+  CHECK(!SPIFFS.exists(UPLOAD_BACKUP_PATH));
+  CHECK(!SPIFFS.exists(UPLOAD_TARGET_PATH));
+
+  r = get(helper, "/page.htm");
+  CHECK_EQ(r.status, 200);
+  CHECK(r.body == content);
+}
+
+static void testMd5Mismatch(Sandbox &box, ServerHelper &helper)
+{
+  box.writeFile("/keep.txt", "keep");
+  Response r = upload(helper, "keep.txt", "new", "X-Content-MD5: 00000000000000000000000000000000\r\n");
+  CHECK_EQ(r.status, 400);
+  CHECK_EQ(box.readFile("/keep.txt"), std::string("keep"));
+  CHECK(!SPIFFS.exists(UPLOAD_TEMP_PATH));
+}
+
+static void testRenameFails(Sandbox &box, ServerHelper &helper)
+{
+  box.writeFile("/keep.txt", "keep");
+  // moving the old file aside fails, it stays where it is
+  host::failRenames(1);
+  Response r = upload(helper, "keep.txt", "new");
+  CHECK_EQ(r.status, 500);
+  CHECK_EQ(box.readFile("/keep.txt"), std::string("keep"));
+
+  // the upload cannot take its name, the old file is moved back
+  host::failRenames(1, 1);
+  r = upload(helper, "keep.txt", "new");
+  CHECK_EQ(r.status, 500);
+  CHECK_EQ(box.readFile("/keep.txt"), std::string("keep"));
+  CHECK(!SPIFFS.exists(UPLOAD_BACKUP_PATH));
+  CHECK(!SPIFFS.exists(UPLOAD_TARGET_PATH));
+  host::failRenames(0);
+}
+
+static void testReservedPath(ServerHelper &helper)
+{
+  Response r = upload(helper, UPLOAD_TARGET_PATH, "/x");
+  CHECK_EQ(r.status, 403);
+  CHECK(!SPIFFS.exists(UPLOAD_TARGET_PATH));
+  CHECK_EQ(get(helper, UPLOAD_BACKUP_PATH).status, 404);
+}
+
+// the states a reset can leave between recording the target and removing
+// the backup; the next boot must end with the new file
+static void testRecovery(Sandbox &box)
+{
+  struct State
+  {
+      bool target;
+      bool temp;
+      bool file;
+      bool backup;
+      const char *expected;
+  };
+  static const State states[] = {
+    {true, true, true, false, "new"},   // nothing renamed yet
+    {true, true, false, true, "new"},   // old file moved aside
+    {true, false, true, true, "new"},   // upload in place, backup left
+    {true, false, true, false, "new"},  // only the record left
+    {false, true, true, false, "old"},  // upload not verified, discarded
+  };
+
+  for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); ++i)
+  {
+    const State &s = states[i];
+    SPIFFS.remove("/page.htm");
+    if (s.target)
+      box.writeFile(UPLOAD_TARGET_PATH, "/page.htm");
+    if (s.temp)
+      box.writeFile(UPLOAD_TEMP_PATH, "new");
+    if (s.file)
+      box.writeFile("/page.htm", s.temp || !s.target ? "old" : "new");
+    if (s.backup)
+      box.writeFile(UPLOAD_BACKUP_PATH, "old");
+
+    ServerHelper helper(NULL);
+    boot(helper);
+    CHECK_EQ(box.readFile("/page.htm"), std::string(s.expected));
+    CHECK(!SPIFFS.exists(UPLOAD_TEMP_PATH));
+    CHECK(!SPIFFS.exists(UPLOAD_BACKUP_PATH));
+    CHECK(!SPIFFS.exists(UPLOAD_TARGET_PATH));
+  }
+}
+
+int main()
+{
+  Sandbox box;
+  {
+    ServerHelper helper(NULL);
+    boot(helper);
+    testReplace(box, helper);
+    testMd5Mismatch(box, helper);
+    testRenameFails(box, helper);
+    testReservedPath(helper);
+  }
+  testRecovery(box);
+  return report();
+}
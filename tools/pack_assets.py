@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Packs a data directory into a C++ header for ServerHelper::setAssets().
+
+Every file is gzip compressed when that makes it smaller. Its MIME type
+and ETag are worked out here, and the entries are sorted by path for
+AssetBundle::find(). The header holds the data in PROGMEM, so the files
+are served from flash without SPIFFS.
+
+MIME types come from the table in src/ServerHelper.cpp, and from the
+MimeType tables of any --mime source, as setMimeTypes() adds them.
+--plain keeps the uncompressed bytes as well, for clients without gzip
+and ?download, at the cost of the flash they take.
+
+    tools/pack_assets.py examples/Basic/data examples/Basic/assets.h
+    tools/pack_assets.py --plain --mime MySketch.ino data assets.h
+"""
+
+import argparse
+import gzip
+import os
+import re
+import sys
+
+# the table getContentType() searches, read from the library so the two
+# cannot drift apart
+LIBRARY_SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "ServerHelper.cpp")
+
+# {"ext", "type"} rows of a MimeType array
+MIME_ROW = re.compile(r'\{\s*"([^"]*)"\s*,\s*"([^"]*)"\s*\}')
+MIME_TABLE = re.compile(r'MimeType\s+\w+\s*\[\s*\]\s*(?:PROGMEM\s*)?=\s*\{(.*?)\};', re.S)
+
+
+def read_mime_types(path):
+    with open(path) as f:
+        source = f.read()
+    types = {}
+    for table in MIME_TABLE.findall(source):
+        for ext, type in MIME_ROW.findall(table):
+            types[ext.lower()] = type
+    return types
+
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+
+def fnv1a(data):
+    h = FNV_OFFSET_BASIS
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def etag(data):
+    # the format of ServerHelper::formatETag()
+    return '"%x-%x"' % (len(data), fnv1a(data))
+
+
+def content_type(path, mime_types):
+    ext = path.rsplit(".", 1)[-1].lower() if "." in os.path.basename(path) else ""
+    return mime_types.get(ext, "text/plain")
+
+
+def collect(root, mime_types, plain):
+    entries = []
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = sorted(d for d in dirnames if not d.startswith("."))
+        for name in filenames:
+            if name.startswith("."):
+                continue
+            full = os.path.join(dirpath, name)
+            rel = os.path.relpath(full, root).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                data = f.read()
+            # mtime 0 keeps the output the same from build to build
+            packed = gzip.compress(data, 9, mtime=0)
+            gz = len(packed) < len(data) and not name.endswith(".gz")
+            entries.append({
+                "path": "/" + rel,
+                "type": content_type(rel[:-3] if name.endswith(".gz") else rel, mime_types),
+                "data": packed if gz else data,
+                "gzip": gz or name.endswith(".gz"),
+                # a .gz file in data/ has no plain bytes to keep
+                "plain": data if gz and plain else None,
+            })
+    # byte order, as strcmp_P compares
+    entries.sort(key=lambda e: e["path"].encode())
+    return entries
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def write_bytes(lines, name, data):
+    lines.append("static const uint8_t %s[] PROGMEM = {" % name)
+    for off in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[off:off + 16]) + ",")
+    lines.append("};")
+
+
+def write_header(entries, out, source, name):
+    guard = name.upper() + "_H"
+    lines = [
+        "// Generated by tools/pack_assets.py from %s, do not edit." % source,
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include <AssetBundle.h>",
+        "",
+    ]
+    for i, e in enumerate(entries):
+        prefix = "%s%d" % (name, i)
+        lines.append("// %s, %d bytes%s" % (e["path"], len(e["data"]), " gzip" if e["gzip"] else ""))
+        lines.append("static const char %sPath[] PROGMEM = %s;" % (prefix, c_string(e["path"])))
+        lines.append("static const char %sType[] PROGMEM = %s;" % (prefix, c_string(e["type"])))
+        lines.append("static const char %sETag[] PROGMEM = %s;" % (prefix, c_string(etag(e["data"]))))
+        write_bytes(lines, prefix + "Data", e["data"])
+        if e["plain"] is not None:
+            lines.append("static const char %sPlainETag[] PROGMEM = %s;" % (prefix, c_string(etag(e["plain"]))))
+            write_bytes(lines, prefix + "Plain", e["plain"])
+        lines.append("")
+
+    lines.append("static const AssetEntry %s[] PROGMEM = {" % name)
+    for i, e in enumerate(entries):
+        prefix = "%s%d" % (name, i)
+        row = "%sPath, %sType, %sETag, %sData, %d, %s" % (prefix, prefix, prefix, prefix, len(e["data"]),
+                                                         "ASSET_GZIP" if e["gzip"] else "0")
+        if e["plain"] is not None:
+            row += ", %sPlainETag, %sPlain, %d" % (prefix, prefix, len(e["plain"]))
+        lines.append("  {%s}," % row)
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif")
+    out.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("data", help="directory to pack")
+    parser.add_argument("output", help="header to write, - for stdout")
+    parser.add_argument("--name", default="assets", help="name of the AssetEntry table")
+    parser.add_argument("--mime", action="append", default=[], metavar="SOURCE",
+                        help="sketch with a MimeType table for setMimeTypes(), its types win")
+    parser.add_argument("--plain", action="store_true",
+                        help="keep the uncompressed bytes of compressed files too")
+    args = parser.parse_args()
+
+    mime_types = read_mime_types(LIBRARY_SOURCE)
+    if not mime_types:
+        sys.exit("no mimeTypes table in %s" % LIBRARY_SOURCE)
+    for source in args.mime:
+        mime_types.update(read_mime_types(source))
+
+    entries = collect(args.data, mime_types, args.plain)
+    if not entries:
+        sys.exit("no files in %s" % args.data)
+    source = os.path.basename(os.path.normpath(args.data))
+    if args.output == "-":
+        write_header(entries, sys.stdout, source, args.name)
+    else:
+        with open(args.output, "w") as out:
+            write_header(entries, out, source, args.name)
+    total = sum(len(e["data"]) + len(e["plain"] or b"") for e in entries)
+    print("%d files, %d bytes" % (len(entries), total), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()